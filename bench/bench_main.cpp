@@ -0,0 +1,1943 @@
+// SmartTremolo micro-benchmarks
+//
+// Usage: smart_tremolo_bench [--filter <substr>] [--seconds <audio seconds>]
+//                            [--reps <n>] [--json <path>]
+//                            [--golden <file> [--update-golden]] [--budget <file>]
+//
+// Each case converts/processes a synthetic buffer several times and reports
+// the best run as MB/s, ns/sample, cycles/sample (TSC cycles, x86 only) and
+// realtime factor (audio seconds per wall second), so numbers are comparable
+// before/after an optimization; --json writes the same results for tracking
+// regressions. Optimized kernels are also compared against their scalar
+// reference; the exit code is non-zero if any output drifts past its tolerance.
+//
+// As a regression suite: --golden bench/golden.txt renders reference signals
+// through every LFO shape and channel layout and compares them with the
+// stored outputs, and --budget bench/budgets.txt fails cases whose
+// cycles/sample exceed their budget (e.g. --filter golden for the audio
+// check alone, or a short --seconds run with both). ctest runs them as the
+// bench_golden and bench_budget (label "perf") tests.
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <functional>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <filesystem>
+#include <thread>
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define BENCH_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_TSC 1
+#endif
+
+#include "AllocCounter.h"
+#include "Automation.h"
+#include "Batch.h"
+#include "Pipeline.h"
+#include "ThreadPool.h"
+#include "WavIO.h"
+#include "PcmCodec.h"
+#include "Server.h"
+#include "TempoMap.h"
+#include "Tremolo.h"
+#include "TremoloBank.h"
+#include "FeatureExtractor.h"
+#include "Fft.h"
+#include "AsyncController.h"
+#include "SmartTremolo/Engine.h"
+#include "SmartTremolo/smart_tremolo.h"
+
+namespace {
+
+struct Options {
+    std::string filter;
+    double seconds = 60.0;  // length of the synthetic test signal
+    int sampleRate = 48000;
+    int channels = 2;
+    int reps = 5;
+    std::string json; // write results here as JSON
+    std::string golden; // compare golden.* renders with this file...
+    bool updateGolden = false; // ...or rewrite it
+    std::string budget; // cycles/sample budgets to check the results against
+};
+
+// Everything report() printed, for --json
+struct Result {
+    std::string name;
+    double seconds;
+    size_t samples, bytes;
+    int channels; // 0: not audio (no realtime factor)
+};
+std::vector<Result> gResults;
+double gTscHz = 0.0; // 0 if there is no cycle counter
+int gSampleRate = 48000;
+int gChannels = 2;
+
+uint64_t cycleCounter() {
+#if defined(BENCH_TSC)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// TSC ticks per second, measured against steady_clock
+double calibrateTsc() {
+#if defined(BENCH_TSC)
+    const auto t0 = std::chrono::steady_clock::now();
+    const uint64_t c0 = cycleCounter();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    const uint64_t c1 = cycleCounter();
+    const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return double(c1 - c0) / sec;
+#else
+    return 0.0;
+#endif
+}
+
+// Best-of-N wall time of fn(), in seconds
+double bestOf(int reps, const std::function<void()>& fn) {
+    double best = 1e30;
+    for (int r = 0; r < reps; ++r) {
+        auto t0 = std::chrono::steady_clock::now();
+        fn();
+        auto t1 = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(t1 - t0).count());
+    }
+    return best;
+}
+
+// `samples` counts interleaved samples of `channels`-channel audio at
+// gSampleRate (channels = 0 for non-audio work: no realtime factor,
+// -1 for the default gChannels)
+void report(const std::string& name, double sec, size_t samples, size_t bytes, int channels = -1) {
+    if (channels < 0) channels = gChannels;
+    gResults.push_back({name, sec, samples, bytes, channels});
+    const double ns = samples ? sec * 1e9 / double(samples) : 0.0;
+    std::cout << std::left << std::setw(34) << name << std::right
+              << std::fixed << std::setprecision(2)
+              << std::setw(10) << (sec > 0 ? double(bytes) / sec / 1e6 : 0.0) << " MB/s"
+              << std::setw(10) << ns << " ns/sample";
+    if (gTscHz > 0) std::cout << std::setw(8) << ns * gTscHz / 1e9 << " cyc/sample";
+    if (channels > 0 && sec > 0)
+        std::cout << std::setw(10) << std::setprecision(0)
+                  << double(samples) / double(channels) / double(gSampleRate) / sec << "x realtime"
+                  << std::setprecision(2);
+    std::cout << "\n";
+}
+
+bool writeJson(const Options& o, const std::string& path, bool ok) {
+    std::ofstream f(path);
+    if (!f) return false;
+    f << std::setprecision(9);
+    f << "{\n  \"simd\": {\"pcm\": \"" << PcmCodec::simdName() << "\", \"bank\": \"" << TremoloBank::simdName()
+      << "\", \"bankLanes\": " << TremoloBank::lanes() << "},\n";
+    f << "  \"tscHz\": " << gTscHz << ",\n";
+    f << "  \"options\": {\"seconds\": " << o.seconds << ", \"sampleRate\": " << o.sampleRate
+      << ", \"channels\": " << o.channels << ", \"reps\": " << o.reps << "},\n";
+    f << "  \"ok\": " << (ok ? "true" : "false") << ",\n  \"results\": [";
+    for (size_t i = 0; i < gResults.size(); ++i) {
+        const Result& r = gResults[i];
+        const double ns = r.samples ? r.seconds * 1e9 / double(r.samples) : 0.0;
+        f << (i ? ",\n" : "\n") << "    {\"name\": \"" << r.name << "\", \"seconds\": " << r.seconds
+          << ", \"samples\": " << r.samples << ", \"bytes\": " << r.bytes
+          << ", \"mbPerSec\": " << (r.seconds > 0 ? double(r.bytes) / r.seconds / 1e6 : 0.0)
+          << ", \"nsPerSample\": " << ns
+          << ", \"cyclesPerSample\": " << ns * gTscHz / 1e9
+          << ", \"realtime\": " << (r.channels > 0 && r.seconds > 0
+                ? double(r.samples) / double(r.channels) / double(gSampleRate) / r.seconds : 0.0)
+          << "}";
+    }
+    f << "\n  ]\n}\n";
+    return bool(f);
+}
+
+std::vector<float> makeSignal(const Options& o) {
+    const size_t n = size_t(o.seconds * o.sampleRate) * size_t(o.channels);
+    std::vector<float> x(n);
+    uint32_t seed = 12345u;
+    for (size_t i = 0; i < n; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        float noise = float(seed >> 8) / float(1u << 24) - 0.5f;
+        // slightly over full scale so the clamp paths are exercised
+        x[i] = 1.1f * std::sin(0.001f * float(i)) + 0.05f * noise;
+    }
+    return x;
+}
+
+bool wanted(const Options& o, const std::string& name) {
+    return o.filter.empty() || name.find(o.filter) != std::string::npos;
+}
+
+// Scratch file or directory in the temp directory, tagged with the process id
+// so bench runs in parallel (ctest -j) do not overwrite each other's files
+std::string tempPath(const std::string& name) {
+#if defined(_WIN32)
+    const long pid = long(_getpid());
+#else
+    const long pid = long(getpid());
+#endif
+    const std::string file = "smart_tremolo_bench_" + std::to_string(pid) + "_" + name;
+    return (std::filesystem::temp_directory_path() / file).string();
+}
+
+std::string tempWav(const std::string& name) { return tempPath(name + ".wav"); }
+
+std::vector<char> fileBytes(const std::string& path) {
+    std::ifstream f(path, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+}
+
+// One pass/fail line of a check
+bool checkLine(const std::string& name, const std::string& what, bool ok) {
+    std::cout << std::left << std::setw(34) << name << std::right << "  " << what
+              << (ok ? "  ok\n" : "  MISMATCH\n");
+    return ok;
+}
+
+// --------------------------------------------------------------------------
+// PCM16 conversion and file I/O
+// --------------------------------------------------------------------------
+void benchPcm(const Options& o) {
+    std::vector<float> x = makeSignal(o);
+    const size_t n = x.size();
+    std::vector<int16_t> pcm(n);
+    std::vector<float> back(n);
+    const size_t pcmBytes = n * sizeof(int16_t);
+
+    if (wanted(o, "pcm.encode16.scalar"))
+        report("pcm.encode16.scalar", bestOf(o.reps, [&]{ PcmCodec::encode16Scalar(x.data(), pcm.data(), n); }), n, pcmBytes);
+    if (wanted(o, "pcm.encode16.bulk"))
+        report(std::string("pcm.encode16.bulk (") + PcmCodec::simdName() + ")",
+               bestOf(o.reps, [&]{ PcmCodec::encode16(x.data(), pcm.data(), n); }), n, pcmBytes);
+    if (wanted(o, "pcm.decode16.scalar"))
+        report("pcm.decode16.scalar", bestOf(o.reps, [&]{ PcmCodec::decode16Scalar(pcm.data(), back.data(), n); }), n, pcmBytes);
+    if (wanted(o, "pcm.decode16.bulk"))
+        report(std::string("pcm.decode16.bulk (") + PcmCodec::simdName() + ")",
+               bestOf(o.reps, [&]{ PcmCodec::decode16(pcm.data(), back.data(), n); }), n, pcmBytes);
+
+    // wider formats: bulk codec, plus a full WAV read per format
+    std::vector<uint8_t> raw(n * 4);
+    for (SampleFormat f : {SampleFormat::Pcm24, SampleFormat::Pcm32, SampleFormat::Float32}) {
+        const std::string name = PcmCodec::formatName(f);
+        const size_t bytes = n * PcmCodec::bytesPerSample(f);
+        if (wanted(o, "pcm.encode." + name))
+            report("pcm.encode." + name, bestOf(o.reps, [&]{ PcmCodec::encode(f, x.data(), raw.data(), n); }), n, bytes);
+        if (wanted(o, "pcm.decode." + name))
+            report("pcm.decode." + name, bestOf(o.reps, [&]{ PcmCodec::decode(f, raw.data(), back.data(), n); }), n, bytes);
+    }
+
+    const std::string tmp = tempWav("pcm");
+    WavData w;
+    w.sampleRate = o.sampleRate;
+    w.channels = o.channels;
+    w.samples = x;
+
+    if (wanted(o, "wav.write16.per-sample")) {
+        // the pre-bulk write16 loop: one 2-byte stream write per sample
+        report("wav.write16.per-sample", bestOf(o.reps, [&]{
+            std::ofstream f(tmp, std::ios::binary);
+            for (float v : w.samples) {
+                float c = std::max(-1.0f, std::min(1.0f, v));
+                int16_t s = (int16_t)std::lround(c * 32767.0f);
+                f.write(reinterpret_cast<const char*>(&s), sizeof(int16_t));
+            }
+        }), n, pcmBytes);
+    }
+    if (wanted(o, "wav.write16"))
+        report("wav.write16", bestOf(o.reps, [&]{ WavIO::write16(tmp, w); }), n, pcmBytes);
+    if (wanted(o, "wav.read16")) {
+        WavIO::write16(tmp, w);
+        WavData r;
+        report("wav.read16", bestOf(o.reps, [&]{ WavIO::read16(tmp, r); }), n, pcmBytes);
+    }
+    for (SampleFormat f : {SampleFormat::Pcm24, SampleFormat::Pcm32, SampleFormat::Float32}) {
+        const std::string name = std::string("wav.write.") + PcmCodec::formatName(f);
+        if (!wanted(o, name)) continue;
+        w.format = f;
+        report(name, bestOf(o.reps, [&]{ WavIO::write(tmp, w); }), n, n * PcmCodec::bytesPerSample(f));
+    }
+    for (SampleFormat f : {SampleFormat::Pcm24, SampleFormat::Pcm32, SampleFormat::Float32}) {
+        const std::string name = std::string("wav.read.") + PcmCodec::formatName(f);
+        if (!wanted(o, name)) continue;
+        w.format = f;
+        WavIO::write(tmp, w);
+        WavData r;
+        report(name, bestOf(o.reps, [&]{ WavIO::read(tmp, r); }), n, n * PcmCodec::bytesPerSample(f));
+    }
+    std::remove(tmp.c_str());
+}
+
+// --------------------------------------------------------------------------
+// LFO evaluation cost per shape and accuracy mode vs the exact functions
+// --------------------------------------------------------------------------
+bool benchLfo(const Options& o) {
+    bool ok = true;
+    const size_t n = size_t(o.seconds * o.sampleRate);
+    std::vector<float> phase(n), exact(n), out(n);
+    float ph = 0.0f;
+    for (size_t i = 0; i < n; ++i) {
+        phase[i] = ph;
+        ph += 5.0f / float(o.sampleRate);
+        if (ph >= 1.0f) ph -= 1.0f;
+    }
+    for (LFOShape shape : {LFOShape::Sine, LFOShape::Triangle, LFOShape::Square, LFOShape::SquareSoft}) {
+        Lfo::eval(shape, LFOAccuracy::Exact, phase.data(), exact.data(), n);
+        for (LFOAccuracy acc : {LFOAccuracy::Exact, LFOAccuracy::Table, LFOAccuracy::Poly}) {
+            const std::string name = std::string("lfo.") + Tremolo::shapeName(shape) + "." + Lfo::accuracyName(acc);
+            if (!wanted(o, name)) continue;
+            double t = bestOf(o.reps, [&]{ Lfo::eval(shape, acc, phase.data(), out.data(), n); });
+            float maxErr = 0.0f;
+            size_t flips = 0; // square edges may land one sample apart
+            for (size_t i = 0; i < n; ++i) {
+                float e = std::fabs(out[i] - exact[i]);
+                if (shape == LFOShape::Square && e > 0.5f) { ++flips; continue; }
+                maxErr = std::max(maxErr, e);
+            }
+            report(name, t, n, n * sizeof(float), 1);
+            std::cout << "  max |err| = " << std::scientific << maxErr << std::fixed;
+            if (shape == LFOShape::Square) std::cout << ", edge flips = " << flips;
+            const bool pass = maxErr <= 5e-6f && flips <= n / 1000;
+            std::cout << (pass ? "  ok\n" : "  MISMATCH\n");
+            ok = ok && pass;
+        }
+    }
+    return ok;
+}
+
+// In-place radix-2 FFT (re/im, size a power of two), for the aliasing check
+void fft(std::vector<double>& re, std::vector<double>& im) {
+    const size_t n = re.size();
+    for (size_t i = 1, j = 0; i < n; ++i) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) { std::swap(re[i], re[j]); std::swap(im[i], im[j]); }
+    }
+    for (size_t len = 2; len <= n; len <<= 1) {
+        const double ang = -2.0 * 3.14159265358979323846 / double(len);
+        for (size_t i = 0; i < n; i += len) {
+            for (size_t k = 0; k < len / 2; ++k) {
+                const double wr = std::cos(ang * double(k)), wi = std::sin(ang * double(k));
+                const size_t a = i + k, b = a + len / 2;
+                const double xr = re[b] * wr - im[b] * wi, xi = re[b] * wi + im[b] * wr;
+                re[b] = re[a] - xr; im[b] = im[a] - xi;
+                re[a] += xr; im[a] += xi;
+            }
+        }
+    }
+}
+
+// Energy of `x` outside +-8 bins of the harmonics of f0 (aliases folded back
+// below Nyquist), relative to the total, in dB. Blackman-Harris window.
+double aliasDb(const std::vector<float>& x, double f0, double sr) {
+    const size_t n = x.size();
+    std::vector<double> re(n), im(n, 0.0);
+    double mean = 0.0;
+    for (float v : x) mean += v;
+    mean /= double(n);
+    for (size_t i = 0; i < n; ++i) {
+        const double w = 2.0 * 3.14159265358979323846 * double(i) / double(n);
+        const double win = 0.35875 - 0.48829 * std::cos(w) + 0.14128 * std::cos(2 * w) - 0.01168 * std::cos(3 * w);
+        re[i] = (double(x[i]) - mean) * win;
+    }
+    fft(re, im);
+    std::vector<bool> harmonic(n / 2 + 1, false);
+    for (double f = f0; f < sr / 2; f += f0) {
+        const long c = std::lround(f / sr * double(n));
+        for (long b = c - 8; b <= c + 8; ++b)
+            if (b >= 0 && b <= long(n / 2)) harmonic[size_t(b)] = true;
+    }
+    for (long b = 0; b <= 8; ++b) harmonic[size_t(b)] = true; // DC leakage
+    double total = 0.0, alias = 0.0;
+    for (size_t b = 0; b <= n / 2; ++b) {
+        const double pw = re[b] * re[b] + im[b] * im[b];
+        total += pw;
+        if (!harmonic[b]) alias += pw;
+    }
+    return 10.0 * std::log10(std::max(alias, 1e-30) / std::max(total, 1e-30));
+}
+
+// Band-limited square/triangle against the naive and tanh shapes: cost per
+// sample, and aliasing of the LFO itself at a high rate (1234.5 Hz), where
+// the hard edges fold back below Nyquist
+bool benchLfoAliasing(const Options& o) {
+    if (!wanted(o, "lfo.alias")) return true;
+    const size_t n = size_t(1) << 16;
+    const double f0 = 1234.5;
+    const float dtv = float(f0 / o.sampleRate);
+    std::vector<float> phase(n), dt(n, dtv), out(n);
+    for (size_t i = 0; i < n; ++i) {
+        const double c = double(i) * f0 / o.sampleRate;
+        phase[i] = float(c - std::floor(c));
+    }
+    double db[Lfo::ShapeCount] = {};
+    for (LFOShape shape : {LFOShape::Square, LFOShape::SquareSoft, LFOShape::SquareBL,
+                           LFOShape::Triangle, LFOShape::TriangleBL}) {
+        const std::string name = std::string("lfo.alias.") + Tremolo::shapeName(shape);
+        report(name, bestOf(o.reps, [&]{ Lfo::eval(shape, LFOAccuracy::Exact, phase.data(), out.data(), n, dt.data()); }),
+               n, n * sizeof(float), 1);
+        db[int(shape)] = aliasDb(out, f0, o.sampleRate);
+        std::cout << "  aliasing = " << std::setprecision(1) << db[int(shape)] << " dB" << std::setprecision(2) << "\n";
+    }
+    const bool ok = db[int(LFOShape::SquareBL)] < db[int(LFOShape::Square)] - 10.0 &&
+                    db[int(LFOShape::TriangleBL)] < db[int(LFOShape::Triangle)] - 10.0;
+    std::cout << "  band-limited shapes alias >= 10 dB less than naive:" << (ok ? "  ok\n" : "  FAIL\n");
+    return ok;
+}
+
+// --------------------------------------------------------------------------
+// Tremolo::process (block/SIMD) against Tremolo::processReference (scalar)
+// --------------------------------------------------------------------------
+Tremolo makeTremolo(const Options& o, LFOShape shape) {
+    Tremolo t;
+    t.setSampleRate(o.sampleRate);
+    t.setRateHz(5.0f);
+    t.setDepth(0.8f);
+    t.setWet(0.9f);
+    t.setStereoPhaseDeg(90.0f);
+    t.setShape(shape);
+    return t;
+}
+
+// Renders `src` in `block`-frame blocks like the pipeline does (512 default)
+template <class Fn>
+void renderBlocks(std::vector<float>& buf, int channels, Fn fn, size_t block = 512) {
+    const size_t frames = buf.size() / size_t(channels);
+    for (size_t f = 0; f < frames; f += block)
+        fn(buf.data() + f * size_t(channels), std::min(block, frames - f));
+}
+
+// Returns false if block and reference outputs differ by more than `tol`
+bool benchTremolo(const Options& o) {
+    const float tol = 1e-6f;
+    bool ok = true;
+    const std::vector<float> stereo = makeSignal(o);
+    for (int ch : {1, 2}) {
+        std::vector<float> src(stereo.begin(), stereo.begin() + stereo.size() / 2 * size_t(ch));
+        for (LFOShape shape : {LFOShape::Sine, LFOShape::Triangle, LFOShape::Square, LFOShape::SquareSoft,
+                                    LFOShape::SquareBL, LFOShape::TriangleBL}) {
+            const std::string base = std::string("tremolo.") + Tremolo::shapeName(shape) + "." + std::to_string(ch) + "ch";
+            if (!wanted(o, base)) continue;
+            const size_t n = src.size();
+            std::vector<float> a, b;
+
+            double tRef = bestOf(o.reps, [&]{
+                a = src; Tremolo t = makeTremolo(o, shape);
+                renderBlocks(a, ch, [&](float* p, size_t fr){ t.processReference(p, fr, ch); });
+            });
+            double tBlk = bestOf(o.reps, [&]{
+                b = src; Tremolo t = makeTremolo(o, shape);
+                renderBlocks(b, ch, [&](float* p, size_t fr){ t.process(p, fr, ch); });
+            });
+
+            float maxDiff = 0.0f;
+            for (size_t i = 0; i < n; ++i) maxDiff = std::max(maxDiff, std::fabs(a[i] - b[i]));
+            report(base + ".reference", tRef, n, n * sizeof(float), ch);
+            report(base + ".block", tBlk, n, n * sizeof(float), ch);
+            std::cout << "  max |block - reference| = " << std::scientific << maxDiff
+                      << std::fixed << (maxDiff <= tol ? "  ok\n" : "  MISMATCH\n");
+            ok = ok && maxDiff <= tol;
+        }
+    }
+    if (wanted(o, "tremolo.reference.6ch")) {
+        // more than two channels: the even/odd layout and a phase table
+        const int ch = 6;
+        const size_t frames = std::min(stereo.size() / 2, size_t(2 * o.sampleRate));
+        std::vector<float> src(frames * size_t(ch));
+        for (size_t i = 0; i < src.size(); ++i) src[i] = stereo[i % stereo.size()];
+        const float deg[6] = {0.0f, 0.0f, 120.0f, 0.0f, 90.0f, 270.0f};
+        for (bool table : {false, true}) {
+            std::vector<float> a = src, b = src;
+            Tremolo ta = makeTremolo(o, LFOShape::Sine), tb = makeTremolo(o, LFOShape::Sine);
+            if (table) { ta.setChannelPhaseDeg(deg, 6); tb.setChannelPhaseDeg(deg, 6); }
+            renderBlocks(a, ch, [&](float* p, size_t fr){ ta.processReference(p, fr, ch); });
+            renderBlocks(b, ch, [&](float* p, size_t fr){ tb.process(p, fr, ch); });
+            float maxDiff = 0.0f;
+            for (size_t i = 0; i < a.size(); ++i) maxDiff = std::max(maxDiff, std::fabs(a[i] - b[i]));
+            std::cout << "tremolo.reference.6ch." << (table ? "table" : "even-odd")
+                      << "  max |block - reference| = " << std::scientific << maxDiff
+                      << std::fixed << (maxDiff <= tol ? "  ok\n" : "  MISMATCH\n");
+            ok = ok && maxDiff <= tol;
+        }
+    }
+    return ok;
+}
+
+// Phase accumulators: block throughput per mode (fixed block == fixed
+// reference), then the phase error of each after an hour at 0.1 Hz, reached
+// with advance() (per-sample for float, O(1) for fixed)
+bool benchPhase(const Options& o) {
+    if (!wanted(o, "phase")) return true;
+    const std::vector<float> src = makeSignal(o);
+    const int ch = o.channels;
+    const size_t n = src.size();
+    bool ok = true;
+
+    std::vector<float> a, b;
+    for (PhaseMode m : {PhaseMode::Float, PhaseMode::Fixed}) {
+        const std::string name = std::string("phase.") + Tremolo::phaseModeName(m);
+        report(name + ".block", bestOf(o.reps, [&]{
+            a = src; Tremolo t = makeTremolo(o, LFOShape::Sine);
+            t.setPhaseMode(m);
+            renderBlocks(a, ch, [&](float* p, size_t fr){ t.process(p, fr, ch); });
+        }), n, n * sizeof(float), ch);
+    }
+    b = src;
+    Tremolo ref = makeTremolo(o, LFOShape::Sine);
+    ref.setPhaseMode(PhaseMode::Fixed);
+    renderBlocks(b, ch, [&](float* p, size_t fr){ ref.processReference(p, fr, ch); });
+    float maxDiff = 0.0f;
+    for (size_t i = 0; i < n; ++i) maxDiff = std::max(maxDiff, std::fabs(a[i] - b[i]));
+    std::cout << "  fixed: max |block - reference| = " << std::scientific << maxDiff
+              << std::fixed << (maxDiff <= 1e-6f ? "  ok\n" : "  MISMATCH\n");
+    ok = ok && maxDiff <= 1e-6f;
+
+    const float rate = 0.1f;
+    const uint64_t frames = uint64_t(3600.0 * o.sampleRate);
+    // exact phase of the float rate after `frames` samples
+    const long double cycles = (long double)frames * (long double)rate / (long double)o.sampleRate;
+    const double exact = double(cycles - std::floor(cycles));
+    for (PhaseMode m : {PhaseMode::Float, PhaseMode::Fixed}) {
+        Tremolo t;
+        t.setSampleRate(o.sampleRate);
+        t.setRateHz(rate);
+        t.setSampleRate(o.sampleRate); // settle the smoothers on 0.1 Hz
+        t.setPhaseMode(m);
+        const std::string name = std::string("phase.advance1h.") + Tremolo::phaseModeName(m);
+        report(name, bestOf(1, [&]{ t.advance(frames); }), size_t(frames), 0, 0);
+        double err = std::fabs(double(t.state().phase) - exact);
+        err = std::min(err, 1.0 - err);
+        std::cout << "  phase error after 1 h at 0.1 Hz: " << std::scientific << err << " cycles" << std::fixed;
+        if (m == PhaseMode::Fixed) {
+            std::cout << (err <= 1e-6 ? "  ok" : "  DRIFT");
+            ok = ok && err <= 1e-6;
+        }
+        std::cout << "\n";
+    }
+
+    // a rate still ramping when advance() starts: it steps only until the
+    // smoother settles, then jumps; same state as processing those frames
+    {
+        auto ramping = [&] {
+            Tremolo t = makeTremolo(o, LFOShape::Sine);
+            t.setPhaseMode(PhaseMode::Fixed);
+            t.setRateHz(7.0f);
+            return t;
+        };
+        Tremolo t = ramping();
+        report("phase.advance1h.fixed.ramping", bestOf(1, [&]{ t.advance(frames); }), size_t(frames), 0, 0);
+        Tremolo u = ramping(), v = ramping();
+        const size_t shortFrames = size_t(2 * o.sampleRate);
+        std::vector<float> silence(shortFrames * size_t(ch), 0.0f);
+        u.advance(shortFrames);
+        renderBlocks(silence, ch, [&](float* p, size_t fr){ v.process(p, fr, ch); });
+        const bool same = u.state().phaseFx == v.state().phaseFx && u.state().rate.z == v.state().rate.z;
+        std::cout << "  advance() through a rate ramp == process()" << (same ? "  ok\n" : "  MISMATCH\n");
+        ok = ok && same;
+    }
+    return ok;
+}
+
+// Tempo sync: a map with changes off the sample grid. Block == reference,
+// and the phase an hour in (advance()) must sit on the beat grid
+bool benchTempo(const Options& o) {
+    if (!wanted(o, "tempo")) return true;
+    const std::vector<float> src = makeSignal(o);
+    const int ch = o.channels;
+    const size_t n = src.size();
+    TempoMap map;
+    map.points = {{0.0, 120.0}, {1.00001, 93.5}, {2.5, 171.0}, {o.seconds * 0.75, 60.0}};
+    double bpc = 0.0;
+    TempoMap::parseDivision("1/8.", bpc);
+
+    std::vector<float> a, b;
+    report("tempo.block", bestOf(o.reps, [&]{
+        a = src; Tremolo t = makeTremolo(o, LFOShape::Sine);
+        t.setTempoSync(map, bpc);
+        renderBlocks(a, ch, [&](float* p, size_t fr){ t.process(p, fr, ch); });
+    }), n, n * sizeof(float), ch);
+    b = src;
+    Tremolo ref = makeTremolo(o, LFOShape::Sine);
+    ref.setTempoSync(map, bpc);
+    renderBlocks(b, ch, [&](float* p, size_t fr){ ref.processReference(p, fr, ch); });
+    float maxDiff = 0.0f;
+    for (size_t i = 0; i < n; ++i) maxDiff = std::max(maxDiff, std::fabs(a[i] - b[i]));
+    std::cout << "  max |block - reference| = " << std::scientific << maxDiff
+              << std::fixed << (maxDiff <= 1e-6f ? "  ok\n" : "  MISMATCH\n");
+
+    Tremolo t = makeTremolo(o, LFOShape::Sine);
+    t.setTempoSync(map, bpc);
+    const uint64_t frames = uint64_t(3600.0 * o.sampleRate) + 12345;
+    t.advance(frames);
+    const double cycles = map.beatsAt(double(frames) / o.sampleRate) / bpc;
+    double err = std::fabs(double(t.state().phase) - (cycles - std::floor(cycles)));
+    err = std::min(err, 1.0 - err);
+    std::cout << "  beat-grid phase error after 1 h = " << std::scientific << err << std::fixed
+              << (err <= 1e-6 ? "  ok\n" : "  DRIFT\n");
+    return maxDiff <= 1e-6f && err <= 1e-6;
+}
+
+// Automation lanes: constant lanes must match fixed parameters exactly;
+// moving rate/depth/stereo-phase/wet lanes show the per-sample ramp cost
+// and must match the scalar reference
+bool benchAutomation(const Options& o) {
+    if (!wanted(o, "automation")) return true;
+    const std::vector<float> src = makeSignal(o);
+    const int ch = o.channels;
+    const size_t n = src.size();
+    const double len = o.seconds;
+
+    Automation flat;
+    flat.parseLane("rate:0=5");
+    flat.parseLane("depth:0=0.8");
+    Automation moving;
+    moving.parseLane("rate:0=2," + std::to_string(len) + "=9");
+    moving.parseLane("depth:0=0.2," + std::to_string(len / 2) + "=1," + std::to_string(len / 2) + "=0.3");
+    moving.parseLane("stereophase:0=0," + std::to_string(len) + "=180");
+    moving.parseLane("wet:0=1," + std::to_string(len) + "=0.5");
+
+    std::vector<float> a, b, c;
+    auto run = [&](std::vector<float>& buf, const Automation* lanes) {
+        buf = src;
+        Tremolo t = makeTremolo(o, LFOShape::Sine);
+        if (lanes) t.setAutomation(*lanes);
+        renderBlocks(buf, ch, [&](float* p, size_t fr){ t.process(p, fr, ch); });
+    };
+    report("automation.none", bestOf(o.reps, [&]{ run(a, nullptr); }), n, n * sizeof(float), ch);
+    report("automation.flat", bestOf(o.reps, [&]{ run(b, &flat); }), n, n * sizeof(float), ch);
+    report("automation.moving", bestOf(o.reps, [&]{ run(c, &moving); }), n, n * sizeof(float), ch);
+    const bool same = a == b;
+    std::cout << "  constant lanes == fixed parameters:" << (same ? "  ok\n" : "  MISMATCH\n");
+
+    // moving lanes through the scalar reference
+    std::vector<float> r = src;
+    Tremolo ref = makeTremolo(o, LFOShape::Sine);
+    ref.setAutomation(moving);
+    renderBlocks(r, ch, [&](float* p, size_t fr){ ref.processReference(p, fr, ch); });
+    float maxDiff = 0.0f;
+    for (size_t i = 0; i < n; ++i) maxDiff = std::max(maxDiff, std::fabs(c[i] - r[i]));
+    std::cout << "  moving lanes: max |block - reference| = " << std::scientific << maxDiff
+              << std::fixed << (maxDiff <= 1e-6f ? "  ok\n" : "  MISMATCH\n");
+    return same && maxDiff <= 1e-6f;
+}
+
+// OnePoleSmoother: per-sample process() against processBlock() on a stepped
+// target (ramping) and a fixed one (settled). The block ramps must equal the
+// per-sample values whatever the block size.
+bool benchSmoother(const Options& o) {
+    if (!wanted(o, "smoother")) return true;
+    const size_t n = size_t(o.seconds * o.sampleRate);
+    const size_t step = size_t(o.sampleRate / 20); // new target every 50 ms
+    auto target = [&](size_t i) { return (i / step) % 2 ? 0.2f : 0.9f; };
+    auto make = [&] {
+        OnePoleSmoother sm;
+        sm.setSampleRate(o.sampleRate);
+        sm.setTimeConstant(0.01f);
+        sm.reset(0.9f);
+        return sm;
+    };
+    std::vector<float> ref(n), out(n);
+    volatile float sink = 0.0f;
+
+    report("smoother.process.ramp", bestOf(o.reps, [&]{
+        OnePoleSmoother sm = make();
+        for (size_t i = 0; i < n; ++i) ref[i] = sm.process(target(i));
+    }), n, n * sizeof(float), 1);
+    bool ok = true;
+    for (size_t block : {1, 37, 512}) {
+        const std::string name = "smoother.block.ramp.b" + std::to_string(block);
+        report(name, bestOf(o.reps, [&]{
+            OnePoleSmoother sm = make();
+            for (size_t i = 0; i < n; ) {
+                // split at target changes so each call has one target
+                const size_t fr = std::min({block, n - i, step - i % step});
+                if (sm.processBlock(target(i), out.data() + i, fr))
+                    std::fill(out.data() + i, out.data() + i + fr, sm.value());
+                i += fr;
+            }
+        }), n, n * sizeof(float), 1);
+        ok = ok && out == ref;
+    }
+    report("smoother.process.settled", bestOf(o.reps, [&]{
+        OnePoleSmoother sm = make();
+        float acc = 0.0f;
+        for (size_t i = 0; i < n; ++i) acc += sm.process(0.9f);
+        sink = acc;
+    }), n, n * sizeof(float), 1);
+    report("smoother.block.settled", bestOf(o.reps, [&]{
+        OnePoleSmoother sm = make();
+        size_t flat = 0;
+        for (size_t i = 0; i < n; i += 512)
+            flat += sm.processBlock(0.9f, out.data(), std::min<size_t>(512, n - i));
+        sink = float(flat);
+    }), n, n * sizeof(float), 1);
+    (void)sink;
+    std::cout << "  block ramps == per-sample:" << (ok ? "  ok\n" : "  MISMATCH\n");
+    return ok;
+}
+
+// Tremolo::process across shape x channel count x block size, to see where
+// per-block overhead stops mattering. Capped at 10 s of audio per case.
+void benchProcessMatrix(const Options& o) {
+    Options m = o;
+    m.seconds = std::min(o.seconds, 10.0);
+    m.channels = 6;
+    const std::vector<float> six = makeSignal(m);
+    for (int ch : {1, 2, 6}) {
+        std::vector<float> src(six.begin(), six.begin() + six.size() / 6 * size_t(ch));
+        std::vector<float> buf;
+        const size_t n = src.size();
+        for (LFOShape shape : {LFOShape::Sine, LFOShape::Triangle, LFOShape::Square, LFOShape::SquareSoft,
+                                    LFOShape::SquareBL, LFOShape::TriangleBL}) {
+            for (size_t block : {64, 256, 1024, 4096}) {
+                const std::string name = std::string("process.") + Tremolo::shapeName(shape) + "."
+                    + std::to_string(ch) + "ch.b" + std::to_string(block);
+                if (!wanted(o, name)) continue;
+                Tremolo t = makeTremolo(o, shape);
+                double sec = bestOf(o.reps, [&]{
+                    buf = src;
+                    renderBlocks(buf, ch, [&](float* p, size_t fr){ t.process(p, fr, ch); }, block);
+                });
+                report(name, sec, n, n * sizeof(float), ch);
+            }
+        }
+    }
+}
+
+// FeatureExtractor cost: per-sample pushes vs. pushBlock at two hops
+void benchFeatures(const Options& o) {
+    const std::vector<float> x = makeSignal(o);
+    const int ch = o.channels;
+    const size_t frames = x.size() / size_t(ch);
+    const size_t n = x.size();
+    volatile float sink = 0.0f;
+
+    if (wanted(o, "features.pushSample")) {
+        report("features.pushSample", bestOf(o.reps, [&]{
+            FeatureExtractor fx;
+            float acc = 0.0f;
+            for (size_t i = 0; i < frames; ++i) {
+                const float* p = x.data() + i * size_t(ch);
+                fx.pushSample(p[0], ch > 1 ? p[1] : p[0]);
+                if (fx.ready()) { acc += fx.rms() + fx.zcr(); fx.consume(); }
+            }
+            sink = acc;
+        }), n, n * sizeof(float), ch);
+    }
+    for (size_t hop : {1024, 256}) {
+        const std::string name = "features.pushBlock.hop" + std::to_string(hop);
+        if (!wanted(o, name)) continue;
+        report(name, bestOf(o.reps, [&]{
+            FeatureExtractor fx(FeatureExtractor::FrameSize, hop);
+            float acc = 0.0f;
+            for (size_t f = 0; f < frames; f += 512) {
+                const size_t fr = std::min<size_t>(512, frames - f);
+                fx.pushBlock(x.data() + f * size_t(ch), fr, ch, [&](size_t){ acc += fx.rms() + fx.zcr(); });
+            }
+            sink = acc;
+        }), n, n * sizeof(float), ch);
+    }
+    (void)sink;
+}
+
+// RealFft against the double-precision complex reference, the cost of the
+// opt-in features on top of RMS/ZCR, and their values on known signals
+bool benchSpectral(const Options& o) {
+    bool ok = true;
+    if (wanted(o, "fft.real")) {
+        const size_t n = 1024;
+        RealFft rfft(n);
+        std::vector<float> x(n), y(n);
+        uint32_t seed = 99u;
+        for (auto& v : x) { seed = seed * 1664525u + 1013904223u; v = float(seed >> 8) / float(1u << 24) - 0.5f; }
+        std::vector<double> re(x.begin(), x.end()), im(n, 0.0);
+        fft(re, im);
+        y = x;
+        rfft.forward(y.data());
+        double err = std::max(std::fabs(y[0] - re[0]), std::fabs(y[1] - re[n / 2])), peak = 0.0;
+        for (size_t k = 1; k < n / 2; ++k) {
+            err = std::max({err, std::fabs(y[2 * k] - re[k]), std::fabs(y[2 * k + 1] - im[k])});
+            peak = std::max(peak, std::hypot(re[k], im[k]));
+        }
+        const int reps = 20000;
+        report("fft.real.1024", bestOf(o.reps, [&]{
+            for (int r = 0; r < reps; ++r) { y = x; rfft.forward(y.data()); }
+        }), n * reps, n * reps * sizeof(float), 0);
+        const bool good = err <= 1e-5 * peak;
+        std::cout << "  max |real fft - reference| = " << std::scientific << std::setprecision(2) << err
+                  << " (peak bin " << peak << ")" << std::defaultfloat << (good ? "  ok\n" : "  MISMATCH\n");
+        ok = ok && good;
+    }
+
+    const std::vector<float> x = makeSignal(o);
+    const int ch = o.channels;
+    const size_t frames = x.size() / size_t(ch);
+    const size_t n = x.size();
+    volatile float sink = 0.0f;
+    const std::pair<const char*, unsigned> sets[] = {
+        {"none", 0u},
+        {"time", FeatureExtractor::Peak | FeatureExtractor::Crest | FeatureExtractor::Onset},
+        {"all", FeatureExtractor::AllFeatures},
+    };
+    for (const auto& set : sets) {
+        const std::string name = std::string("features.fused.hop256.") + set.first;
+        if (!wanted(o, name)) continue;
+        report(name, bestOf(o.reps, [&]{
+            FeatureExtractor fx(FeatureExtractor::FrameSize, 256);
+            fx.setFeatures(set.second);
+            float acc = 0.0f;
+            for (size_t f = 0; f < frames; f += 512) {
+                const size_t fr = std::min<size_t>(512, frames - f);
+                fx.pushBlock(x.data() + f * size_t(ch), fr, ch, [&](size_t){
+                    acc += fx.rms() + fx.zcr() + fx.peak() + fx.crest() + fx.onset() + fx.centroid();
+                });
+            }
+            sink = acc;
+        }), n, n * sizeof(float), ch);
+    }
+    (void)sink;
+
+    if (wanted(o, "features.values")) {
+        // 1 kHz sine at 0.1, then 0.5 from 0.5 s: peak, crest, centroid of the
+        // loud part; the onsets of the frames spanning the step add up to its
+        // 14 dB rise
+        const double sr = 48000.0;
+        std::vector<float> sine(size_t(sr) * 2);
+        for (size_t i = 0; i < sine.size(); ++i)
+            sine[i] = (i < size_t(sr) / 2 ? 0.1f : 0.5f) * float(std::sin(2.0 * 3.14159265358979323846 * 1000.0 * double(i) / sr));
+        FeatureExtractor fx(FeatureExtractor::FrameSize, 256);
+        fx.setFeatures(FeatureExtractor::AllFeatures);
+        float peak = 0.f, crest = 0.f, centroidHz = 0.f, onset = 0.f;
+        const size_t step = size_t(sr) / 2;
+        fx.pushBlock(sine.data(), sine.size(), 1, [&](size_t end) {
+            if (end > step && end <= step + FeatureExtractor::FrameSize) onset += fx.onset();
+            peak = fx.peak(); crest = fx.crest(); centroidHz = fx.centroid() * float(sr);
+        });
+        const bool good = std::fabs(peak - 0.5f) < 0.01f && std::fabs(crest - std::sqrt(2.0f)) < 0.02f &&
+                          std::fabs(centroidHz - 1000.f) < 50.f && std::fabs(onset - 14.f) < 1.f;
+        std::cout << std::defaultfloat << std::setprecision(4) << "  1 kHz sine: peak=" << peak << " crest=" << crest << " centroid=" << centroidHz
+                  << " Hz, 0.1 -> 0.5 step onsets=" << onset << " dB" << (good ? "  ok\n" : "  MISMATCH\n");
+        ok = ok && good;
+    }
+    return ok;
+}
+
+// Phase-table layout: {0, stereo} on stereo must equal the stereo path
+// exactly; 5.1 with a single LFO pass vs. one Tremolo per stereo pair.
+bool benchChannelTable(const Options& o) {
+    bool ok = true;
+    const std::vector<float> stereo = makeSignal(o);
+    if (wanted(o, "tremolo.table.2ch")) {
+        std::vector<float> a = stereo, b = stereo;
+        Tremolo ta = makeTremolo(o, LFOShape::Sine), tb = makeTremolo(o, LFOShape::Sine);
+        ta.setStereoPhaseDeg(90.0f);
+        const float deg[2] = {0.0f, 90.0f};
+        tb.setChannelPhaseDeg(deg, 2);
+        renderBlocks(a, 2, [&](float* p, size_t fr){ ta.process(p, fr, 2); });
+        renderBlocks(b, 2, [&](float* p, size_t fr){ tb.process(p, fr, 2); });
+        const bool same = a == b;
+        std::cout << "tremolo.table.2ch == stereo layout" << (same ? "  ok\n" : "  MISMATCH\n");
+        ok = ok && same;
+    }
+    if (wanted(o, "tremolo.table.6ch")) {
+        // 5.1: L R C LFE Ls Rs, surrounds 90 degrees behind the front
+        const int ch = 6;
+        // same frame count as the stereo signal
+        std::vector<float> src(stereo.size() / 2 * size_t(ch));
+        for (size_t i = 0; i < src.size(); ++i) src[i] = stereo[i % stereo.size()];
+        const size_t n = src.size();
+        const float deg[6] = {0.0f, 0.0f, 0.0f, 0.0f, 90.0f, 90.0f};
+        std::vector<float> buf;
+        double tTable = bestOf(o.reps, [&]{
+            buf = src; Tremolo t = makeTremolo(o, LFOShape::Sine);
+            t.setChannelPhaseDeg(deg, 6);
+            renderBlocks(buf, ch, [&](float* p, size_t fr){ t.process(p, fr, ch); });
+        });
+        // the old workaround: split into stereo pairs, one pass each
+        std::vector<float> pair;
+        double tPairs = bestOf(o.reps, [&]{
+            for (int k = 0; k < 3; ++k) {
+                pair.resize(n / 3);
+                for (size_t i = 0; i < n / size_t(ch); ++i) {
+                    pair[i * 2] = src[i * ch + size_t(2 * k)];
+                    pair[i * 2 + 1] = src[i * ch + size_t(2 * k + 1)];
+                }
+                Tremolo t = makeTremolo(o, LFOShape::Sine);
+                renderBlocks(pair, 2, [&](float* p, size_t fr){ t.process(p, fr, 2); });
+            }
+        });
+        report("tremolo.table.6ch.one-pass", tTable, n, n * sizeof(float), ch);
+        report("tremolo.table.6ch.stereo-pairs", tPairs, n, n * sizeof(float), ch);
+    }
+    return ok;
+}
+
+// `voices` independent stems: an array of Tremolo objects vs one TremoloBank.
+// Rates, depths, stereo phases and (in the mixed run) shapes differ per voice.
+bool benchBank(const Options& o) {
+    const float tol = 1e-6f;
+    bool ok = true;
+    const size_t voices = 128;
+    const size_t frames = size_t(std::min(o.seconds, 2.0) * o.sampleRate);
+    const std::vector<float> sig = makeSignal(o);
+    for (int ch : {1, 2}) {
+        for (bool mixed : {false, true}) {
+            const std::string base = "bank." + std::to_string(voices) + "v." + std::to_string(ch) + "ch" +
+                                     (mixed ? ".mixed" : ".sine");
+            if (!wanted(o, base)) continue;
+            auto shapeOf = [&](size_t v) { return mixed ? LFOShape(v % Lfo::ShapeCount) : LFOShape::Sine; };
+            std::vector<std::vector<float>> src(voices);
+            for (size_t v = 0; v < voices; ++v) {
+                // each voice a different slice that stays inside the signal
+                const size_t off = (v * 997) % (sig.size() - frames * size_t(ch) + 1);
+                src[v].assign(sig.begin() + off, sig.begin() + off + frames * size_t(ch));
+            }
+            std::vector<std::vector<float>> a, b;
+
+            double tArr = bestOf(o.reps, [&]{
+                a = src;
+                std::vector<Tremolo> t(voices);
+                for (size_t v = 0; v < voices; ++v) {
+                    t[v].setSampleRate(o.sampleRate);
+                    t[v].setRateHz(0.5f + 0.07f * float(v));
+                    t[v].setDepth(0.3f + 0.005f * float(v));
+                    t[v].setStereoPhaseDeg(float(v % 181));
+                    t[v].setShape(shapeOf(v));
+                }
+                for (size_t f = 0; f < frames; f += 512)
+                    for (size_t v = 0; v < voices; ++v)
+                        t[v].process(a[v].data() + f * size_t(ch), std::min<size_t>(512, frames - f), ch);
+            });
+            double tBank = bestOf(o.reps, [&]{
+                b = src;
+                TremoloBank bank(voices);
+                bank.setSampleRate(o.sampleRate);
+                for (size_t v = 0; v < voices; ++v) {
+                    bank.setRateHz(v, 0.5f + 0.07f * float(v));
+                    bank.setDepth(v, 0.3f + 0.005f * float(v));
+                    bank.setStereoPhaseDeg(v, float(v % 181));
+                    bank.setShape(v, shapeOf(v));
+                }
+                std::vector<float*> ptrs(voices);
+                for (size_t f = 0; f < frames; f += 512) {
+                    for (size_t v = 0; v < voices; ++v) ptrs[v] = b[v].data() + f * size_t(ch);
+                    bank.process(ptrs.data(), std::min<size_t>(512, frames - f), ch);
+                }
+            });
+
+            float maxDiff = 0.0f;
+            for (size_t v = 0; v < voices; ++v)
+                for (size_t i = 0; i < a[v].size(); ++i) maxDiff = std::max(maxDiff, std::fabs(a[v][i] - b[v][i]));
+            const size_t n = voices * frames * size_t(ch);
+            report(base + ".tremolo[]", tArr, n, n * sizeof(float), ch);
+            report(base + ".bank." + TremoloBank::simdName(), tBank, n, n * sizeof(float), ch);
+            std::cout << "  max |bank - tremolo| = " << std::scientific << maxDiff
+                      << std::fixed << (maxDiff <= tol ? "  ok\n" : "  MISMATCH\n");
+            ok = ok && maxDiff <= tol;
+        }
+    }
+    return ok;
+}
+
+// Stand-in for an expensive model: busy-waits `us` per update
+struct SpinController : ScalarController {
+    explicit SpinController(double costUs) : us(costUs) {}
+    void update(double, float rms, float, float& rateHz, float& depth) override {
+        const auto t0 = std::chrono::steady_clock::now();
+        while (std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() < us) {}
+        rateHz = 2.0f + 6.0f * std::min(1.0f, rms);
+        depth = 0.6f;
+    }
+    double us;
+};
+
+// Features -> controller -> Tremolo in 512-frame blocks, controller called
+// inline vs through AsyncController. Timing only: async output depends on
+// scheduling, so the two are not compared sample by sample.
+void benchController(const Options& o) {
+    if (!wanted(o, "controller.async")) return;
+    const int ch = o.channels;
+    const std::vector<float> src = makeSignal(o);
+    const size_t n = src.size();
+    const double costUs = 20.0; // per 1024-sample frame: ~5% of a 48 kHz budget
+    SpinController ctrl(costUs);
+    std::vector<float> buf;
+
+    double tSync = bestOf(o.reps, [&]{
+        buf = src; Tremolo t = makeTremolo(o, LFOShape::Sine);
+        FeatureExtractor feat;
+        renderBlocks(buf, ch, [&](float* p, size_t fr){
+            feat.pushBlock(p, fr, ch, [&](size_t){
+                float rate = 5.0f, depth = 0.6f;
+                ctrl.update(0.0, feat.rms(), feat.zcr(), rate, depth);
+                t.setRateHz(rate); t.setDepth(depth);
+            });
+            t.process(p, fr, ch);
+        });
+    });
+
+    AsyncController::Stats st;
+    double tAsync = bestOf(o.reps, [&]{
+        buf = src; Tremolo t = makeTremolo(o, LFOShape::Sine);
+        FeatureExtractor feat;
+        AsyncController async(ctrl);
+        uint64_t pos = 0;
+        renderBlocks(buf, ch, [&](float* p, size_t fr){
+            float rate = 5.0f, depth = 0.6f;
+            if (async.poll(pos, rate, depth)) { t.setRateHz(rate); t.setDepth(depth); }
+            feat.pushBlock(p, fr, ch, [&](size_t off){
+                async.push(pos + off - 1, 0.0, feat.rms(), feat.zcr(), 5.0f, 0.6f);
+            });
+            t.process(p, fr, ch);
+            pos += fr;
+        });
+        async.flush();
+        st = async.stats();
+    });
+
+    report("controller.async.inline." + std::to_string(int(costUs)) + "us", tSync, n, n * sizeof(float), ch);
+    report("controller.async.worker." + std::to_string(int(costUs)) + "us", tAsync, n, n * sizeof(float), ch);
+    std::cout << "  async: " << st.applied << "/" << st.posted << " applied, " << st.dropped
+              << " dropped, latency avg " << std::setprecision(1) << st.avgLatencyFrames
+              << " max " << st.maxLatencyFrames << " frames\n" << std::setprecision(2);
+}
+
+// flush() with far more finished results than poll() has picked up: the
+// worker must keep going (older results are superseded) rather than wait for
+// the audio thread, and the next poll() returns the last frame's result
+bool checkAsyncFlush(const Options& o) {
+    if (!wanted(o, "controller.async.flush")) return true;
+    struct FrameRate : ScalarController {
+        void update(double t, float, float, float& rateHz, float& depth) override {
+            rateHz = float(t);
+            depth = 0.5f;
+        }
+    };
+    FrameRate ctrl;
+    AsyncController async(ctrl);
+    const uint64_t frames = 200;
+    for (uint64_t i = 0; i < frames; ++i) {
+        while (!async.push(i, double(i), 0.0f, 0.0f, 5.0f, 0.6f)) std::this_thread::yield();
+        if (i % 40 == 39) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    async.flush();
+    float rate = 0.0f, depth = 0.0f;
+    const bool got = async.poll(frames, rate, depth);
+    const AsyncController::Stats st = async.stats();
+    const bool ok = got && rate == float(frames - 1) && st.applied == frames;
+    std::cout << std::left << std::setw(34) << "controller.async.flush" << std::right << "  " << frames
+              << " results pending, last rate " << rate << (ok ? "  ok\n" : "  MISMATCH\n");
+    return ok;
+}
+
+// Linear "model" rate = a*rms + b*zcr + c, written only as a batch kernel
+struct LinearController : Controller {
+    void updateBatch(const ControllerBatch& b) override {
+        for (size_t i = 0; i < b.count; ++i) {
+            b.rateHz[i] = 2.0f + 6.0f * b.rms[i] + 0.01f * b.zcr[i];
+            b.depth[i] = std::min(1.0f, 0.3f + b.rms[i]);
+        }
+    }
+};
+
+// Many streams' frames at once: one updateBatch() vs one update() per frame
+// (the scalar adapter). Outputs must match exactly.
+bool benchControllerBatch(const Options& o) {
+    if (!wanted(o, "controller.batch")) return true;
+    const size_t n = 1u << 20;
+    ControllerFrames in;
+    in.reserve(n);
+    uint32_t seed = 777u;
+    for (size_t i = 0; i < n; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        in.push(0.0, float(seed >> 8) / float(1u << 24), float(seed & 0xFFu), 5.0f, 0.6f);
+    }
+    LinearController lin;
+    Controller& ctrl = lin;
+    ControllerFrames a, b;
+    double tScalar = bestOf(o.reps, [&]{
+        a = in;
+        for (size_t i = 0; i < n; ++i)
+            ctrl.update(a.timeSeconds[i], a.rms[i], a.zcr[i], a.rateHz[i], a.depth[i]);
+    });
+    double tBatch = bestOf(o.reps, [&]{
+        b = in;
+        ctrl.updateBatch(b.view());
+    });
+    const bool same = a.rateHz == b.rateHz && a.depth == b.depth;
+    report("controller.batch.update", tScalar, n, n * 2 * sizeof(float), 0);
+    report("controller.batch.updateBatch", tBatch, n, n * 2 * sizeof(float), 0);
+    std::cout << (same ? "  batch == scalar  ok\n" : "  batch != scalar  MISMATCH\n");
+
+    // the opt-in features reach updateBatch() through AsyncController too
+    struct FeatureSum : Controller {
+        size_t frames = 0;
+        double peak = 0.0, centroid = 0.0;
+        void updateBatch(const ControllerBatch& b) override {
+            if (!b.peak || !b.centroid) return;
+            frames += b.count;
+            for (size_t i = 0; i < b.count; ++i) { peak += b.peak[i]; centroid += b.centroid[i]; }
+        }
+    };
+    const std::vector<float> sig = makeSignal(o);
+    const size_t sigFrames = std::min(sig.size() / size_t(o.channels), size_t(2 * o.sampleRate));
+    FeatureSum inl, off;
+    {
+        FeatureExtractor feat;
+        feat.setFeatures(FeatureExtractor::AllFeatures);
+        ControllerFrames one;
+        one.reserve(1, FeatureExtractor::AllFeatures);
+        AsyncController async(off);
+        feat.pushBlock(sig.data(), sigFrames, o.channels, [&](size_t i) {
+            one.clear();
+            one.push(0.0, feat.rms(), feat.zcr(), 5.0f, 0.6f);
+            one.pushFeatures(feat);
+            inl.updateBatch(one.view());
+            while (!async.push(i, 0.0, feat, 5.0f, 0.6f)) std::this_thread::yield();
+        });
+        async.flush();
+    }
+    const bool forwarded = off.frames > 0 && off.frames == inl.frames && off.peak == inl.peak &&
+                           off.centroid == inl.centroid;
+    std::cout << "  async controller sees the opt-in features (" << off.frames << "/" << inl.frames
+              << " frames)" << (forwarded ? "  ok\n" : "  MISMATCH\n");
+    return same && forwarded;
+}
+
+// Short clips rendered back to back, as Batch/Server do: fresh buffers per
+// job vs one reused RenderWorkspace. With SMART_TREMOLO_ALLOC_CHECK (Debug)
+// also counts heap allocations: none in Tremolo::process once prepared, and
+// fewer per job with the workspace.
+bool benchAlloc(const Options& o) {
+    if (!wanted(o, "alloc")) return true;
+    namespace fs = std::filesystem;
+    const std::string in = tempWav("clip");
+    const std::string out = tempWav("out");
+    Options clip = o;
+    clip.seconds = 0.5;
+    WavData w;
+    w.sampleRate = o.sampleRate;
+    w.channels = o.channels;
+    w.samples = makeSignal(clip);
+    if (!WavIO::write(in, w)) {
+        std::cerr << "  alloc: cannot write " << in << "\n";
+        return false;
+    }
+
+    RenderParams p;
+    p.channelPhaseDeg = {0.0f, 90.0f};
+    const int jobs = 50;
+    RenderWorkspace ws;
+    bool ok = true;
+    uint64_t allocFresh = 0, allocReused = 0;
+    const double tFresh = bestOf(o.reps, [&]{
+        const uint64_t a0 = AllocCounter::threadCount();
+        for (int j = 0; j < jobs; ++j) ok = Pipeline::renderFile(in, out, p).ok && ok;
+        allocFresh = (AllocCounter::threadCount() - a0) / jobs;
+    });
+    const double tReused = bestOf(o.reps, [&]{
+        const uint64_t a0 = AllocCounter::threadCount();
+        for (int j = 0; j < jobs; ++j) ok = Pipeline::renderFile(in, out, p, nullptr, &ws).ok && ok;
+        allocReused = (AllocCounter::threadCount() - a0) / jobs;
+    });
+    const size_t n = w.samples.size() * size_t(jobs);
+    report("alloc.render.fresh", tFresh, n, n * sizeof(float), o.channels);
+    report("alloc.render.workspace", tReused, n, n * sizeof(float), o.channels);
+
+    // steady state: the block loop on a prepared Tremolo
+    std::vector<float> buf = w.samples;
+    Tremolo t;
+    t.setSampleRate(o.sampleRate);
+    t.setChannelPhaseDeg(p.channelPhaseDeg.data(), p.channelPhaseDeg.size());
+    t.prepare(o.channels);
+    const uint64_t a0 = AllocCounter::threadCount();
+    renderBlocks(buf, o.channels, [&](float* x, size_t f) { t.process(x, f, o.channels); });
+    const uint64_t allocLoop = AllocCounter::threadCount() - a0;
+
+    // the library API: a 5.1 Engine given a phase table between calls
+    SmartTremolo::Config cfg;
+    cfg.sampleRate = o.sampleRate;
+    cfg.channels = 6;
+    SmartTremolo::Engine eng(cfg, SmartTremolo::Params());
+    const float deg[6] = {0.0f, 0.0f, 0.0f, 0.0f, 90.0f, 90.0f};
+    std::vector<float> block(512 * 6, 0.1f);
+    eng.process(block.data(), 512);
+    eng.setChannelPhaseDeg(deg, 6);
+    const uint64_t e0 = AllocCounter::threadCount();
+    for (int i = 0; i < 8; ++i) eng.process(block.data(), 512);
+    const uint64_t allocEngine = AllocCounter::threadCount() - e0;
+
+    fs::remove(in);
+    fs::remove(out);
+    if (!AllocCounter::enabled()) {
+        std::cout << "  allocation counts: build with CMAKE_BUILD_TYPE=Debug (SMART_TREMOLO_ALLOC_CHECK)\n";
+        return ok;
+    }
+    const bool fewer = allocReused < allocFresh && allocLoop == 0 && allocEngine == 0;
+    std::cout << "  heap allocations per job: " << allocFresh << " fresh, " << allocReused
+              << " with workspace; Tremolo::process loop: " << allocLoop
+              << "; 5.1 Engine::process: " << allocEngine
+              << (fewer ? "  ok\n" : "  REGRESSION\n");
+    return ok && fewer;
+}
+
+// --------------------------------------------------------------------------
+// Golden outputs (--golden <file>): reference signals (WavIO::makeTestPad
+// and an impulse train) through every LFO shape and channel layout, the
+// pipeline and the PCM codecs, compared with fingerprints stored in the file.
+// A fingerprint is the RMS of equal slices of each channel plus samples
+// spread over the render, so a gain, phase or channel-mapping change shows
+// while rounding differences between compilers/ISAs stay far below the
+// tolerance. --update-golden rewrites the file from this build.
+// --------------------------------------------------------------------------
+constexpr float kGoldenTol = 1e-4f; // absolute, on every fingerprint value
+constexpr size_t kGoldenSlices = 48;
+constexpr size_t kGoldenPicks = 16;
+
+struct Golden {
+    std::string name;
+    int channels = 0;
+    size_t frames = 0;
+    std::vector<float> values;
+};
+
+Golden fingerprint(const std::string& name, const std::vector<float>& x, int channels) {
+    Golden g;
+    g.name = name;
+    g.channels = channels;
+    g.frames = x.size() / size_t(channels);
+    for (int c = 0; c < channels; ++c)
+        for (size_t s = 0; s < kGoldenSlices; ++s) {
+            const size_t f0 = g.frames * s / kGoldenSlices, f1 = g.frames * (s + 1) / kGoldenSlices;
+            double e = 0.0;
+            for (size_t f = f0; f < f1; ++f) {
+                const double v = x[f * size_t(channels) + size_t(c)];
+                e += v * v;
+            }
+            g.values.push_back(f1 > f0 ? float(std::sqrt(e / double(f1 - f0))) : 0.0f);
+        }
+    for (size_t k = 0; k < kGoldenPicks && !x.empty(); ++k)
+        g.values.push_back(x[x.size() * (2 * k + 1) / (2 * kGoldenPicks)]);
+    return g;
+}
+
+// "<name> <channels> <frames> <count> <values...>" lines; '#' starts a comment
+bool readGolden(const std::string& path, std::vector<Golden>& out) {
+    std::ifstream f(path);
+    if (!f) return false;
+    std::string line;
+    while (std::getline(f, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream ss(line);
+        Golden g;
+        size_t count = 0;
+        if (!(ss >> g.name >> g.channels >> g.frames >> count)) return false;
+        g.values.resize(count);
+        for (float& v : g.values)
+            if (!(ss >> v)) return false;
+        out.push_back(std::move(g));
+    }
+    return true;
+}
+
+bool writeGolden(const std::string& path, const std::vector<Golden>& cases) {
+    std::ofstream f(path);
+    if (!f) return false;
+    f << "# SmartTremolo golden outputs: smart_tremolo_bench --golden <this file>\n"
+      << "# (regenerate with --update-golden after an intended change)\n"
+      << "# <case> <channels> <frames> <count> <slice RMS per channel..., picked samples...>\n";
+    f << std::setprecision(9);
+    for (const Golden& g : cases) {
+        f << g.name << ' ' << g.channels << ' ' << g.frames << ' ' << g.values.size();
+        for (float v : g.values) f << ' ' << v;
+        f << '\n';
+    }
+    return bool(f);
+}
+
+// The reference renders, named golden.<what>.<layout>.<signal>
+std::vector<Golden> goldenCases(const Options& o) {
+    const WavData pad = WavIO::makeTestPad(); // 2 s stereo at 44.1 kHz
+    const int sr = pad.sampleRate;
+    const size_t frames = pad.samples.size() / 2;
+
+    // the pad on 1, 2 and 6 channels (mono = left; 5.1 = L/R alternating,
+    // each channel a little quieter), and an impulse every 10 ms on each
+    // channel, channel c delayed by c frames
+    struct Layout { const char* name; int channels; std::vector<float> deg; };
+    const Layout layouts[] = {
+        {"mono", 1, {}},
+        {"stereo", 2, {}},
+        {"5.1", 6, {0.0f, 0.0f, 0.0f, 0.0f, 90.0f, 90.0f}},
+    };
+    auto padOn = [&](int ch) {
+        std::vector<float> x(frames * size_t(ch));
+        for (size_t f = 0; f < frames; ++f)
+            for (int c = 0; c < ch; ++c)
+                x[f * size_t(ch) + size_t(c)] = pad.samples[f * 2 + size_t(c % 2)] * (1.0f - 0.1f * float(c));
+        return x;
+    };
+    auto impulsesOn = [&](int ch) {
+        std::vector<float> x(frames * size_t(ch), 0.0f);
+        for (size_t f = 0; f + size_t(ch) < frames; f += size_t(sr) / 100)
+            for (int c = 0; c < ch; ++c) x[(f + size_t(c)) * size_t(ch) + size_t(c)] = 0.9f;
+        return x;
+    };
+
+    Options at = o;
+    at.sampleRate = sr;
+    std::vector<Golden> out;
+    for (const Layout& l : layouts) {
+        const std::vector<float> signals[2] = {padOn(l.channels), impulsesOn(l.channels)};
+        const char* signalNames[2] = {"pad", "impulses"};
+        for (LFOShape shape : {LFOShape::Sine, LFOShape::Triangle, LFOShape::Square, LFOShape::SquareSoft,
+                                    LFOShape::SquareBL, LFOShape::TriangleBL}) {
+            for (int s = 0; s < 2; ++s) {
+                const std::string name = std::string("golden.") + Tremolo::shapeName(shape) + "." + l.name + "." + signalNames[s];
+                if (!wanted(o, name)) continue;
+                std::vector<float> x = signals[s];
+                Tremolo t = makeTremolo(at, shape);
+                if (!l.deg.empty()) t.setChannelPhaseDeg(l.deg.data(), l.deg.size());
+                renderBlocks(x, l.channels, [&](float* p, size_t fr) { t.process(p, fr, l.channels); });
+                out.push_back(fingerprint(name, x, l.channels));
+            }
+        }
+
+        // the whole serial render (features -> controller -> Tremolo) with
+        // the CLI defaults
+        const std::string name = std::string("golden.pipeline.") + l.name + ".pad";
+        if (wanted(o, name)) {
+            std::vector<float> x = signals[0];
+            RenderParams p;
+            p.channelPhaseDeg = l.deg;
+            Pipeline::renderBuffer(x.data(), frames, l.channels, sr, p);
+            out.push_back(fingerprint(name, x, l.channels));
+        }
+    }
+
+    // PCM round trips of the stereo sine render
+    for (SampleFormat fmt : {SampleFormat::Pcm16, SampleFormat::Pcm24, SampleFormat::Pcm32}) {
+        const std::string name = std::string("golden.") + PcmCodec::formatName(fmt) + ".stereo.pad";
+        if (!wanted(o, name)) continue;
+        std::vector<float> x = padOn(2);
+        Tremolo t = makeTremolo(at, LFOShape::Sine);
+        renderBlocks(x, 2, [&](float* p, size_t fr) { t.process(p, fr, 2); });
+        std::vector<uint8_t> bytes(x.size() * PcmCodec::bytesPerSample(fmt));
+        PcmCodec::encode(fmt, x.data(), bytes.data(), x.size());
+        PcmCodec::decode(fmt, bytes.data(), x.data(), x.size());
+        out.push_back(fingerprint(name, x, 2));
+    }
+    return out;
+}
+
+// Batch::run with RenderParams::threads > 1: the batch pool is the only pool;
+// jobs must not each build a segment pool of their own
+bool checkBatchPools(const Options& o) {
+    if (!wanted(o, "batch.pools")) return true;
+    namespace fs = std::filesystem;
+    const fs::path dir = tempPath("batch");
+    fs::create_directories(dir / "out");
+    Options clip = o;
+    clip.seconds = 0.25;
+    WavData w;
+    w.sampleRate = o.sampleRate;
+    w.channels = o.channels;
+    w.samples = makeSignal(clip);
+    std::vector<std::string> inputs;
+    bool ok = true;
+    for (int i = 0; i < 4; ++i) {
+        inputs.push_back((dir / ("clip" + std::to_string(i) + ".wav")).string());
+        ok = WavIO::write(inputs.back(), w) && ok;
+    }
+    BatchOptions opt;
+    opt.outDir = (dir / "out").string();
+    opt.threads = 2;
+    opt.params.threads = 4;
+    std::ostringstream log;
+    const uint64_t before = ThreadPool::created();
+    const size_t failed = Batch::run(inputs, opt, log);
+    const uint64_t pools = ThreadPool::created() - before;
+    ok = ok && failed == 0 && pools == 1;
+    std::cout << std::left << std::setw(34) << "batch.pools" << std::right << "  4 files, threads 4: "
+              << pools << " pool(s), " << failed << " failed" << (ok ? "  ok\n" : "  MISMATCH\n");
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    return ok;
+}
+
+// A render that fails partway (here: the stream reader of a later segment
+// hits the end of a truncated data chunk) must leave nothing at its output
+bool checkFailedRender(const Options& o) {
+    if (!wanted(o, "render.failed")) return true;
+    namespace fs = std::filesystem;
+    const std::string in = tempWav("truncated");
+    const std::string out = tempWav("truncated_out");
+    Options sig = o;
+    sig.seconds = 3.0 * double(Pipeline::SegmentFrames) / double(o.sampleRate);
+    WavData w;
+    w.sampleRate = o.sampleRate;
+    w.channels = o.channels;
+    w.samples = makeSignal(sig);
+    bool ok = WavIO::write(in, w);
+    std::error_code ec;
+    if (ok) fs::resize_file(in, fs::file_size(in) / 2, ec);
+    RenderParams p;
+    p.io = WavReader::Mode::Stream;
+    p.threads = 4;
+    const RenderResult r = Pipeline::renderFile(in, out, p);
+    const bool left = fs::exists(out);
+    ok = ok && !ec && !r.ok && !left;
+    std::cout << std::left << std::setw(34) << "render.failed" << std::right << "  truncated input: "
+              << (r.ok ? "rendered" : "failed") << ", output " << (left ? "left behind" : "removed")
+              << (ok ? "  ok\n" : "  MISMATCH\n");
+    fs::remove(in, ec);
+    fs::remove(out, ec);
+    return ok;
+}
+
+// Segment-parallel renderFile (threads > 1) must write the same bytes as
+// the serial render: a float32 file a few SegmentFrames long, with an odd
+// block size so blocks straddle segment boundaries. Runs with or without
+// --golden; "golden.segments" keeps it in the --filter golden suite.
+bool checkSegments(const Options& o) {
+    namespace fs = std::filesystem;
+    const std::string in = tempWav("segments");
+    const std::string serial = tempWav("serial");
+    const std::string parallel = tempWav("parallel");
+
+    struct Case { const char* name; int channels; PhaseMode phase; const char* lanes[2]; };
+    const Case cases[] = {
+        {"golden.segments.stereo.b77", 2, PhaseMode::Float, {nullptr, nullptr}},
+        {"golden.segments.stereo.fixed.auto", 2, PhaseMode::Fixed,
+         {"depth:0=0.2,1.6=0.9,1.6=0.3,4=0.7", "rate:0=3,5=9"}},
+        {"golden.segments.5.1.fixed.auto", 6, PhaseMode::Fixed,
+         {"depth:0=0.8,3=0.1", "stereophase:0=0,6=180"}},
+    };
+    bool ok = true;
+    for (const Case& c : cases) {
+        if (!wanted(o, c.name)) continue;
+        Options sig = o;
+        sig.channels = c.channels;
+        sig.seconds = (4.5 * double(Pipeline::SegmentFrames) + 123.0) / double(o.sampleRate);
+        WavData w;
+        w.sampleRate = o.sampleRate;
+        w.channels = c.channels;
+        w.samples = makeSignal(sig);
+        w.format = SampleFormat::Float32;
+
+        RenderParams p;
+        p.blockFrames = 77;
+        p.phaseMode = c.phase;
+        if (c.channels == 6) p.channelPhaseDeg = {0.0f, 0.0f, 0.0f, 0.0f, 90.0f, 90.0f};
+        bool rendered = WavIO::write(in, w);
+        for (const char* lane : c.lanes)
+            if (lane) rendered = p.automation.parseLane(lane) && rendered;
+        p.threads = 1;
+        rendered = rendered && Pipeline::renderFile(in, serial, p).ok;
+        p.threads = 4;
+        rendered = rendered && Pipeline::renderFile(in, parallel, p).ok;
+        const std::vector<char> a = fileBytes(serial), b = fileBytes(parallel);
+        const bool same = rendered && !a.empty() && a == b;
+        std::cout << std::left << std::setw(34) << c.name << std::right << "  threads 4 vs 1: "
+                  << (!rendered ? "render failed" : same ? "identical bytes" : "bytes differ")
+                  << (same ? "  ok\n" : "  MISMATCH\n");
+        ok = same && ok;
+    }
+    fs::remove(in);
+    fs::remove(serial);
+    fs::remove(parallel);
+    return ok;
+}
+
+// WAV round trips through every sample format, stereo (classic header for
+// PCM16, extensible otherwise) and 5.1 (always extensible, default mask),
+// within two quantization steps
+bool checkFormats(const Options& o) {
+    bool ok = true;
+    const SampleFormat formats[] = {SampleFormat::Pcm16, SampleFormat::Pcm24, SampleFormat::Pcm32,
+                                    SampleFormat::Float32};
+    const std::string path = tempWav("format");
+    for (int ch : {2, 6}) {
+        for (SampleFormat f : formats) {
+            const std::string name = std::string("golden.io.") + PcmCodec::formatName(f) + (ch == 2 ? ".stereo" : ".5.1");
+            if (!wanted(o, name)) continue;
+            Options sig = o;
+            sig.channels = ch;
+            sig.seconds = 0.1;
+            WavData w, r;
+            w.sampleRate = o.sampleRate;
+            w.channels = ch;
+            w.format = f;
+            w.samples = makeSignal(sig);
+            for (float& x : w.samples) x *= 0.8f; // inside full scale: no clipping
+            bool good = WavIO::write(path, w) && WavIO::read(path, r);
+            const std::vector<char> bytes = fileBytes(path);
+            const unsigned tag = bytes.size() >= 22 ? unsigned(uint8_t(bytes[20])) | unsigned(uint8_t(bytes[21])) << 8 : 0u;
+            const bool extensible = f != SampleFormat::Pcm16 || ch > 2;
+            WavReader rd;
+            const uint32_t mask = rd.open(path) ? rd.channelMask() : ~0u;
+            rd.close();
+            const uint32_t wantMask = !extensible ? 0u : ch == 6 ? 0x3Fu : 0x3u;
+            good = good && r.format == f && r.channels == ch && r.sampleRate == o.sampleRate &&
+                   r.samples.size() == w.samples.size() && tag == (extensible ? 0xFFFEu : 1u) && mask == wantMask;
+            const float step = f == SampleFormat::Pcm16 ? 1.0f / 32768.0f
+                             : f == SampleFormat::Pcm24 ? 1.0f / 8388608.0f
+                             : f == SampleFormat::Pcm32 ? 1.0f / 16777216.0f : 0.0f;
+            double maxDiff = 0.0;
+            for (size_t i = 0; good && i < w.samples.size(); ++i)
+                maxDiff = std::max(maxDiff, double(std::fabs(w.samples[i] - r.samples[i])));
+            good = good && maxDiff <= 2.0f * step; // PCM16 encodes x 32767 but decodes / 32768
+            std::ostringstream what;
+            what << (extensible ? "extensible" : "classic") << " header, max diff " << std::scientific
+                 << std::setprecision(2) << maxDiff << std::defaultfloat;
+            ok = checkLine(name, what.str(), good) && ok;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+    return ok;
+}
+
+// The memory-mapped and the streamed reader must render the same bytes
+bool checkIoPaths(const Options& o) {
+    if (!wanted(o, "golden.io.mmap-vs-stream")) return true;
+    const std::string in = tempWav("io_in"), a = tempWav("io_stream"), b = tempWav("io_mapped");
+    Options sig = o;
+    sig.seconds = 1.0;
+    WavData w;
+    w.sampleRate = o.sampleRate;
+    w.channels = o.channels;
+    w.format = SampleFormat::Pcm24;
+    w.samples = makeSignal(sig);
+    RenderParams p;
+    p.blockFrames = 77;
+    p.io = WavReader::Mode::Stream;
+    bool ok = WavIO::write(in, w);
+    const RenderResult rs = Pipeline::renderFile(in, a, p);
+    p.io = WavReader::Mode::Mapped;
+    const RenderResult rm = Pipeline::renderFile(in, b, p);
+    const std::vector<char> sa = fileBytes(a);
+    ok = ok && rs.ok && rm.ok && !rs.mapped && rm.mapped && !sa.empty() && sa == fileBytes(b);
+    std::error_code ec;
+    for (const std::string& f : {in, a, b}) std::filesystem::remove(f, ec);
+    return checkLine("golden.io.mmap-vs-stream", "pcm24 input: identical bytes", ok);
+}
+
+// Skipped silent blocks advance the LFO exactly as processing them would:
+// with a stretch of zeros in the input, every sample after it matches the
+// unskipped render bit for bit (inside it, only the DSP's 1e-20 denormal
+// guard differs)
+bool checkSkipSilence(const Options& o) {
+    bool ok = true;
+    for (PhaseMode phase : {PhaseMode::Float, PhaseMode::Fixed}) {
+        const std::string name = phase == PhaseMode::Float ? "golden.skip-silence.float" : "golden.skip-silence.fixed.auto";
+        if (!wanted(o, name)) continue;
+        Options sig = o;
+        sig.seconds = 1.0;
+        std::vector<float> src = makeSignal(sig);
+        const size_t ch = size_t(o.channels), frames = src.size() / ch;
+        const size_t z0 = frames * 3 / 10 * ch, z1 = frames * 7 / 10 * ch;
+        std::fill(src.begin() + std::ptrdiff_t(z0), src.begin() + std::ptrdiff_t(z1), 0.0f);
+        RenderParams p;
+        p.phaseMode = phase;
+        if (phase == PhaseMode::Fixed) p.automation.parseLane("rate:0=2,1=9");
+        std::vector<float> full = src, skipped = src;
+        const RenderResult rf = Pipeline::renderBuffer(full.data(), frames, o.channels, o.sampleRate, p);
+        p.silencePeak = 1e-5f;
+        const RenderResult rs = Pipeline::renderBuffer(skipped.data(), frames, o.channels, o.sampleRate, p);
+        bool good = rf.ok && rs.ok && rs.skippedFrames > 0;
+        for (size_t i = 0; good && i < full.size(); ++i)
+            good = i >= z0 && i < z1 ? std::fabs(full[i] - skipped[i]) <= 1e-12f : full[i] == skipped[i];
+        ok = checkLine(name, std::to_string(rs.skippedFrames) + " frames skipped, LFO continuous", good) && ok;
+    }
+    return ok;
+}
+
+// Batch::run refuses a second input with the same output name and an output
+// that would overwrite its input; the other jobs still render
+bool checkBatchOutputs(const Options& o) {
+    if (!wanted(o, "golden.batch.outputs")) return true;
+    namespace fs = std::filesystem;
+    const fs::path dir = tempPath("batch_outputs");
+    for (const char* sub : {"a", "b", "c", "out"}) fs::create_directories(dir / sub);
+    Options clip = o;
+    clip.seconds = 0.1;
+    WavData w;
+    w.sampleRate = o.sampleRate;
+    w.channels = o.channels;
+    w.samples = makeSignal(clip);
+    const std::vector<std::string> inputs = {(dir / "a" / "clip.wav").string(), (dir / "b" / "clip.wav").string(),
+                                             (dir / "out" / "self.wav").string(), (dir / "c" / "solo.wav").string()};
+    bool ok = true;
+    for (const std::string& in : inputs) ok = WavIO::write(in, w) && ok;
+    const std::vector<char> self = fileBytes(inputs[2]);
+    BatchOptions opt;
+    opt.outDir = (dir / "out").string();
+    opt.threads = 2;
+    std::ostringstream log;
+    const size_t failed = Batch::run(inputs, opt, log);
+    const std::string text = log.str();
+    ok = ok && failed == 2 && text.find("already written by " + inputs[0]) != std::string::npos &&
+         text.find("output would overwrite the input") != std::string::npos &&
+         fileBytes(inputs[2]) == self && fs::exists(dir / "out" / "clip.wav") && fs::exists(dir / "out" / "solo.wav");
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    return checkLine("golden.batch.outputs", std::to_string(failed) + "/4 refused (clash, overwrite)", ok);
+}
+
+// The server protocol end to end: ping, a render job, a pcm job whose
+// samples come back (same as renderBuffer), a pcm job to a file, and a bad
+// request. Replies arrive in completion order, so they are matched by id.
+bool checkServer(const Options& o) {
+    if (!wanted(o, "golden.server")) return true;
+    const std::string in = tempWav("server_in"), out = tempWav("server_out"), ref = tempWav("server_ref"),
+                      pcmOut = tempWav("server_pcm");
+    Options sig = o;
+    sig.seconds = 0.5;
+    WavData w;
+    w.sampleRate = o.sampleRate;
+    w.channels = o.channels;
+    w.samples = makeSignal(sig);
+    bool ok = WavIO::write(in, w);
+
+    const size_t frames = 300;
+    const std::vector<float> pcm(w.samples.begin(), w.samples.begin() + std::ptrdiff_t(frames * size_t(o.channels)));
+    const std::string layout = "sr=" + std::to_string(o.sampleRate) + " channels=" + std::to_string(o.channels) +
+                               " frames=" + std::to_string(frames);
+    std::string req = "ping\n"
+                      "render in=\"" + in + "\" out=\"" + out + "\" id=r1 depth=0.8\n"
+                      "pcm " + layout + " format=float32 id=p1 depth=0.8\n";
+    req.append(reinterpret_cast<const char*>(pcm.data()), pcm.size() * sizeof(float));
+    req += "pcm " + layout + " format=float32 out=\"" + pcmOut + "\" id=p2\n";
+    req.append(reinterpret_cast<const char*>(pcm.data()), pcm.size() * sizeof(float));
+    req += "bogus\n";
+
+    ServerOptions opt;
+    opt.threads = 2;
+    std::istringstream reqs(req);
+    std::ostringstream replies, log;
+    Server::serveStream(opt, reqs, replies, log);
+
+    RenderParams p;
+    p.depth = 0.8f;
+    std::vector<float> want = pcm;
+    ok = Pipeline::renderBuffer(want.data(), frames, o.channels, o.sampleRate, p).ok && ok;
+    ok = Pipeline::renderFile(in, ref, p).ok && ok;
+
+    // parse "<line>\n[payload]" replies
+    const std::string all = replies.str();
+    bool ping = false, r1 = false, p1 = false, p2 = false, bad = false;
+    for (size_t pos = 0; pos < all.size();) {
+        const size_t nl = all.find('\n', pos);
+        if (nl == std::string::npos) { ok = false; break; }
+        const std::string line = all.substr(pos, nl - pos);
+        pos = nl + 1;
+        if (line == "ok ping") ping = true;
+        else if (line.rfind("ok r1 ", 0) == 0) r1 = line.find("frames=" + std::to_string(w.samples.size() / size_t(o.channels))) != std::string::npos;
+        else if (line.rfind("ok p2 ", 0) == 0) p2 = true;
+        else if (line.rfind("err 4 ", 0) == 0) bad = line.find("bogus") != std::string::npos;
+        else if (line.rfind("ok p1 ", 0) == 0) {
+            const size_t b = line.find("bytes=");
+            const size_t bytes = b == std::string::npos ? 0 : size_t(std::stoull(line.substr(b + 6)));
+            if (bytes != want.size() * sizeof(float) || pos + bytes > all.size()) { ok = false; break; }
+            std::vector<float> got(want.size());
+            std::memcpy(got.data(), all.data() + pos, bytes);
+            pos += bytes;
+            p1 = got == want;
+        } else {
+            ok = false;
+        }
+    }
+    WavData back;
+    p2 = p2 && WavIO::read(pcmOut, back) && back.samples.size() == pcm.size();
+    const std::vector<char> rendered = fileBytes(out);
+    r1 = r1 && !rendered.empty() && rendered == fileBytes(ref);
+    ok = ok && ping && r1 && p1 && p2 && bad;
+    std::error_code ec;
+    for (const std::string& f : {in, out, ref, pcmOut}) std::filesystem::remove(f, ec);
+    return checkLine("golden.server", std::string("ping, render, pcm -, pcm file, bad request: ") +
+                     (ping ? "P" : "-") + (r1 ? "R" : "-") + (p1 ? "S" : "-") + (p2 ? "F" : "-") + (bad ? "E" : "-"), ok);
+}
+
+// TempoMap::load: a text map (unsorted, commas, comments) and a two-track
+// Standard MIDI File with a running-status note track; a malformed line fails
+bool checkTempoLoad(const Options& o) {
+    if (!wanted(o, "golden.tempo.load")) return true;
+    const std::string text = tempPath("tempo.txt"), midi = tempPath("tempo.mid"), bad = tempPath("tempo_bad.txt");
+    std::ofstream(text) << "# tempo map\n0 120\n4 140 # faster\n\n2.5, 90\n";
+    std::ofstream(bad) << "0 120\n1 fast\n";
+    const unsigned char mid[] = {
+        'M','T','h','d', 0,0,0,6, 0,1, 0,2, 0x01,0xE0,                   // format 1, 2 tracks, 480 ticks/quarter
+        'M','T','r','k', 0,0,0,19,
+        0x00, 0xFF,0x51,0x03, 0x07,0xA1,0x20,                              // 0: 120 bpm
+        0x87,0x40, 0xFF,0x51,0x03, 0x06,0x1A,0x80,                         // 960: 150 bpm
+        0x00, 0xFF,0x2F,0x00,
+        'M','T','r','k', 0,0,0,19,
+        0x00, 0x90,0x3C,0x64,                                              // note on
+        0x60, 0x3C,0x00,                                                   // 96: running status
+        0x8E,0x20, 0xFF,0x51,0x03, 0x09,0x27,0xC0,                         // 1920: 100 bpm
+        0x00, 0xFF,0x2F,0x00,
+    };
+    std::ofstream(midi, std::ios::binary).write(reinterpret_cast<const char*>(mid), sizeof(mid));
+
+    auto same = [](const TempoMap& m, const std::vector<TempoPoint>& want) {
+        if (m.points.size() != want.size()) return false;
+        for (size_t i = 0; i < want.size(); ++i)
+            if (std::fabs(m.points[i].timeSeconds - want[i].timeSeconds) > 1e-9 ||
+                std::fabs(m.points[i].bpm - want[i].bpm) > 1e-9)
+                return false;
+        return true;
+    };
+    TempoMap t, m, b;
+    std::string err;
+    const bool ok = t.load(text) && same(t, {{0.0, 120.0}, {2.5, 90.0}, {4.0, 140.0}}) &&
+                    m.load(midi) && same(m, {{0.0, 120.0}, {1.0, 150.0}, {1.8, 100.0}}) &&
+                    !b.load(bad, &err) && err.find(":2:") != std::string::npos;
+    std::error_code ec;
+    for (const std::string& f : {text, midi, bad}) std::filesystem::remove(f, ec);
+    return checkLine("golden.tempo.load", "text and MIDI maps, bad line rejected", ok);
+}
+
+// Automation::load: sorts and clamps each lane, merges into lanes it does not
+// mention, and rejects an unknown parameter
+bool checkAutomationLoad(const Options& o) {
+    if (!wanted(o, "golden.automation.load")) return true;
+    const std::string path = tempPath("lanes.txt"), bad = tempPath("lanes_bad.txt");
+    std::ofstream(path) << "# lanes\ndepth 2 0.9\ndepth 0 0.2\nrate 1 3.5\n\ndepth 1 1.5  # clamped\nstereophase 0 270\n";
+    std::ofstream(bad) << "depth 0 0.5\nvolume 0 1\n";
+    auto same = [](const AutomationLane& l, const std::vector<Breakpoint>& want) {
+        if (l.points.size() != want.size()) return false;
+        for (size_t i = 0; i < want.size(); ++i)
+            if (l.points[i].timeSeconds != want[i].timeSeconds || l.points[i].value != want[i].value) return false;
+        return true;
+    };
+    Automation a, b;
+    std::string err;
+    bool ok = a.parseLane("wet:0=0.5") && a.load(path);
+    ok = ok && same(a.lane(AutoParam::Depth), {{0.0, 0.2f}, {1.0, 1.0f}, {2.0, 0.9f}}) &&
+         same(a.lane(AutoParam::Rate), {{1.0, 3.5f}}) && same(a.lane(AutoParam::StereoPhase), {{0.0, 180.0f}}) &&
+         same(a.lane(AutoParam::Wet), {{0.0, 0.5f}}) &&
+         !b.load(bad, &err) && err.find(":2:") != std::string::npos;
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+    std::filesystem::remove(bad, ec);
+    return checkLine("golden.automation.load", "sorted, clamped, merged; bad param rejected", ok);
+}
+
+bool benchGolden(const Options& o) {
+    if (o.golden.empty()) return true;
+    const std::vector<Golden> now = goldenCases(o);
+    if (o.updateGolden) {
+        const bool ok = writeGolden(o.golden, now);
+        std::cout << "golden: wrote " << now.size() << " cases to " << o.golden << (ok ? "\n" : "  FAILED\n");
+        return ok;
+    }
+    std::vector<Golden> stored;
+    if (!readGolden(o.golden, stored)) {
+        std::cout << "golden: cannot read " << o.golden << "  FAILED\n";
+        return false;
+    }
+    bool ok = true;
+    size_t passed = 0;
+    float largest = 0.0f;
+    for (const Golden& g : now) {
+        auto it = std::find_if(stored.begin(), stored.end(), [&](const Golden& s) { return s.name == g.name; });
+        std::string why;
+        float diff = 0.0f;
+        if (it == stored.end()) why = "not in the golden file (--update-golden)";
+        else if (it->channels != g.channels || it->frames != g.frames || it->values.size() != g.values.size())
+            why = "layout differs from the golden file";
+        else
+            for (size_t i = 0; i < g.values.size(); ++i) diff = std::max(diff, std::fabs(g.values[i] - it->values[i]));
+        if (why.empty() && diff > kGoldenTol) {
+            std::ostringstream ss;
+            ss << "max diff " << std::scientific << std::setprecision(2) << diff << " > " << std::defaultfloat << kGoldenTol;
+            why = ss.str();
+        }
+        if (why.empty()) { ++passed; largest = std::max(largest, diff); continue; }
+        std::cout << std::left << std::setw(34) << g.name << std::right << "  " << why << "  MISMATCH\n";
+        ok = false;
+    }
+    std::cout << "golden: " << passed << "/" << now.size() << " cases match " << o.golden
+              << " within " << std::defaultfloat << kGoldenTol << " (largest diff " << std::setprecision(2) << largest << ")"
+              << (ok ? "  ok\n" : "  MISMATCH\n");
+    return ok;
+}
+
+// --budget <file>: "<case> <max cycles/sample>" lines ('#' comments); a case
+// that ran and took more cycles per sample than its budget fails the run.
+// Case names are report()'s, without a " (simd)" suffix. Budgets are for
+// this kind of machine: set them with headroom over a few quiet runs.
+bool checkBudgets(const Options& o) {
+    if (o.budget.empty()) return true;
+    std::ifstream f(o.budget);
+    if (!f) {
+        std::cout << "budget: cannot read " << o.budget << "  FAILED\n";
+        return false;
+    }
+    if (gTscHz <= 0) {
+        std::cout << "budget: no cycle counter on this platform, budgets not checked\n";
+        return true;
+    }
+    bool ok = true;
+    size_t checked = 0;
+    std::string line;
+    while (std::getline(f, line)) {
+        std::istringstream ss(line);
+        std::string name;
+        double budget = 0.0;
+        if (!(ss >> name) || name[0] == '#') continue;
+        if (!(ss >> budget)) {
+            std::cout << "budget: bad line \"" << line << "\"  FAILED\n";
+            ok = false;
+            continue;
+        }
+        bool ran = false;
+        for (const Result& r : gResults) {
+            if (r.name != name && r.name.rfind(name + " (", 0) != 0) continue;
+            const double cyc = r.samples ? r.seconds * gTscHz / double(r.samples) : 0.0;
+            ran = true;
+            ++checked;
+            if (cyc <= budget) continue;
+            std::cout << std::left << std::setw(34) << r.name << std::right << std::fixed << std::setprecision(2)
+                      << std::setw(10) << cyc << " cyc/sample > budget " << budget << "  REGRESSION\n";
+            ok = false;
+        }
+        if (!ran && wanted(o, name)) std::cout << "budget: no case named " << name << " ran\n";
+    }
+    std::cout << "budget: " << checked << " cases checked against " << o.budget << (ok ? "  ok\n" : "  REGRESSION\n");
+    return ok;
+}
+
+} // namespace
+
+// --------------------------------------------------------------------------
+// Library API: Engine::process cost, and the output must not depend on how
+// the stream is cut into calls (nor on going through the C ABI)
+// --------------------------------------------------------------------------
+bool benchEngine(const Options& o) {
+    if (!wanted(o, "engine")) return true;
+    const std::vector<float> src = makeSignal(o);
+    const int ch = o.channels;
+    const size_t frames = src.size() / size_t(ch);
+    const size_t n = src.size();
+    SmartTremolo::Config cfg;
+    cfg.sampleRate = o.sampleRate;
+    cfg.channels = ch;
+    SmartTremolo::Params prm;
+    prm.stereoPhaseDeg = 90.0f;
+
+    auto run = [&](std::vector<float>& buf, size_t call) {
+        buf = src;
+        SmartTremolo::Engine e(cfg, prm);
+        for (size_t f = 0; f < frames; f += call)
+            e.process(buf.data() + f * size_t(ch), std::min(call, frames - f));
+    };
+    std::vector<float> a, b, c;
+    report("engine.process.b512", bestOf(o.reps, [&]{ run(a, 512); }), n, n * sizeof(float), ch);
+    report("engine.process.b1000", bestOf(o.reps, [&]{ run(b, 1000); }), n, n * sizeof(float), ch);
+
+    c = src;
+    st_engine* h = st_engine_create(o.sampleRate, ch, 0, 0);
+    st_engine_set_param(h, ST_PARAM_STEREO_PHASE_DEG, 90.0f);
+    // non-finite values and NaN enums are refused and change nothing
+    const float nan = std::numeric_limits<float>::quiet_NaN(), inf = std::numeric_limits<float>::infinity();
+    bool refused = true;
+    for (st_param q : {ST_PARAM_RATE_HZ, ST_PARAM_DEPTH, ST_PARAM_STEREO_PHASE_DEG, ST_PARAM_SHAPE,
+                          ST_PARAM_ACCURACY, ST_PARAM_PHASE_MODE})
+        refused = st_engine_set_param(h, q, nan) == ST_ERR_INVALID &&
+                  st_engine_set_param(h, q, inf) == ST_ERR_INVALID && refused;
+    for (size_t f = 0; f < frames; f += 333)
+        st_engine_process_f32(h, c.data() + f * size_t(ch), std::min<size_t>(333, frames - f));
+    st_engine_destroy(h);
+
+    const bool same = a == b && a == c;
+    std::cout << "  engine output independent of call size / C ABI:" << (same ? "  ok\n" : "  MISMATCH\n");
+    std::cout << "  C ABI refuses NaN/inf parameters:" << (refused ? "  ok\n" : "  MISMATCH\n");
+    return same && refused;
+}
+
+int main(int argc, char** argv) {
+    Options o;
+    for (int i = 1; i < argc; ++i) {
+        std::string k = argv[i];
+        auto need = [&](const char* name) -> std::string {
+            if (i + 1 >= argc) { std::cerr << "Missing value for " << name << "\n"; std::exit(1); }
+            return argv[++i];
+        };
+        if (k == "--filter") o.filter = need("--filter");
+        else if (k == "--seconds") o.seconds = std::max(0.1, std::stod(need("--seconds")));
+        else if (k == "--reps") o.reps = std::max(1, std::stoi(need("--reps")));
+        else if (k == "--json") o.json = need("--json");
+        else if (k == "--golden") o.golden = need("--golden");
+        else if (k == "--update-golden") o.updateGolden = true;
+        else if (k == "--budget") o.budget = need("--budget");
+        else if (k == "--help" || k == "-h") {
+            std::cout << "Usage: smart_tremolo_bench [--filter <substr>] [--seconds <s>] [--reps <n>] [--json <path>]\n"
+                         "                           [--golden <file> [--update-golden]] [--budget <file>]\n";
+            return 0;
+        }
+        else { std::cerr << "Unknown flag: " << k << "\n"; return 1; }
+    }
+    if (o.updateGolden && o.golden.empty()) { std::cerr << "--update-golden needs --golden <file>\n"; return 1; }
+
+    gSampleRate = o.sampleRate;
+    gChannels = o.channels;
+    gTscHz = calibrateTsc();
+    std::cout << "SmartTremolo bench: " << o.seconds << " s, " << o.sampleRate
+              << " Hz, " << o.channels << " ch, best of " << o.reps << "\n";
+    if (gTscHz > 0) std::cout << "TSC: " << std::fixed << std::setprecision(0) << gTscHz / 1e6 << " MHz\n";
+    benchPcm(o);
+    bool ok = benchLfo(o);
+    ok = benchLfoAliasing(o) && ok;
+    ok = benchTremolo(o) && ok;
+    ok = benchAutomation(o) && ok;
+    ok = benchSmoother(o) && ok;
+    ok = benchPhase(o) && ok;
+    ok = benchTempo(o) && ok;
+    benchProcessMatrix(o);
+    benchFeatures(o);
+    ok = benchSpectral(o) && ok;
+    ok = benchChannelTable(o) && ok;
+    ok = benchBank(o) && ok;
+    benchController(o);
+    ok = checkAsyncFlush(o) && ok;
+    ok = benchControllerBatch(o) && ok;
+    ok = benchEngine(o) && ok;
+    ok = benchAlloc(o) && ok;
+    ok = checkBatchPools(o) && ok;
+    ok = checkFailedRender(o) && ok;
+    ok = benchGolden(o) && ok;
+    ok = checkSegments(o) && ok;
+    ok = checkFormats(o) && ok;
+    ok = checkIoPaths(o) && ok;
+    ok = checkSkipSilence(o) && ok;
+    ok = checkBatchOutputs(o) && ok;
+    ok = checkServer(o) && ok;
+    ok = checkTempoLoad(o) && ok;
+    ok = checkAutomationLoad(o) && ok;
+    ok = checkBudgets(o) && ok;
+    if (!o.json.empty() && !writeJson(o, o.json, ok)) {
+        std::cerr << "Failed to write " << o.json << "\n";
+        return 1;
+    }
+    return ok ? 0 : 2;
+}
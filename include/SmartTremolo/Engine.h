@@ -0,0 +1,110 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+// Public C++ API of the smart_tremolo_engine library.
+// Only this header (and smart_tremolo.h for C) is stable; the headers under
+// src/ are internal and may change between versions. Engine keeps its state
+// behind a pointer so the class layout does not change either.
+namespace SmartTremolo {
+
+constexpr int VersionMajor = 1;
+constexpr int VersionMinor = 2;
+const char* versionString(); // "1.2"
+
+enum class Shape { Sine, Triangle, Square, SquareSoft, SquareBL, TriangleBL }; // *BL: band-limited edges
+enum class LfoAccuracy { Exact, Table, Poly };
+enum class PhaseMode { Float, Fixed }; // Fixed: drift-free 64-bit phase accumulator
+
+// Effect parameters; out-of-range values are clamped like the CLI's ranges
+struct Params {
+    float rateHz = 5.0f;         // > 0
+    float depth = 0.6f;          // [0..1]
+    float wet = 1.0f;            // [0..1]
+    float stereoPhaseDeg = 0.0f; // [0..180], odd channels
+    Shape shape = Shape::Sine;
+    LfoAccuracy accuracy = LfoAccuracy::Exact;
+    PhaseMode phase = PhaseMode::Float;
+};
+
+// Opt-in analysis features (Config::features bits); RMS and ZCR are always on
+enum FeatureFlags : uint32_t {
+    FeaturePeak = 1u << 0,
+    FeatureCrest = 1u << 1,
+    FeatureOnset = 1u << 2,
+    FeatureCentroid = 1u << 3, // spectral (one FFT per analysis frame)
+};
+
+// Fixed for the lifetime of an Engine
+struct Config {
+    int sampleRate = 48000;
+    int channels = 2;            // 1..64 interleaved
+    size_t blockFrames = 512;    // controller/parameter granularity (frames)
+    size_t hop = 1024;           // analysis hop (samples), 1..1024
+    uint32_t features = 0;       // FeatureFlags for Features' opt-in fields
+};
+
+// One analysis frame handed to the control callback
+struct Features {
+    double timeSeconds = 0.0; // stream time of the frame's last sample
+    float rms = 0.0f;
+    float zcr = 0.0f;
+    // opt-in (Config::features), 0 when off
+    float peak = 0.0f;
+    float crest = 0.0f;       // peak / rms
+    float onset = 0.0f;       // rise in energy since the last frame, dB
+    float centroidHz = 0.0f;  // spectral centroid
+};
+
+// Adjusts rateHz/depth (in/out) from the features of each analysis frame;
+// called on the processing thread, so keep it cheap.
+using ControlCallback = std::function<void(const Features&, float& rateHz, float& depth)>;
+
+// Streaming tremolo for in-memory buffers: features -> control callback ->
+// tremolo, in place, in spans that never cross a blockFrames boundary of the
+// stream. Without a callback the output does not depend on how the stream is
+// cut into process() calls and matches a smart_tremolo file render of the
+// same audio and parameters; with one, that holds while calls are whole
+// blocks (updates apply at span starts). Not thread-safe; one Engine per stream.
+class Engine {
+public:
+    explicit Engine(const Config& config = Config(), const Params& params = Params());
+    ~Engine();
+    Engine(Engine&&) noexcept;
+    Engine& operator=(Engine&&) noexcept;
+    Engine(const Engine&) = delete;
+    Engine& operator=(const Engine&) = delete;
+
+    const Config& config() const;
+    const Params& params() const;
+
+    // New targets; rate and depth are smoothed, the rest applies immediately
+    void setParams(const Params& p);
+    // Per-channel LFO offsets (deg) replacing the stereo layout; count == 0 clears
+    void setChannelPhaseDeg(const float* deg, size_t count);
+    void setControlCallback(ControlCallback cb);
+
+    // Back to the state of a freshly constructed Engine (params are kept)
+    void reset();
+
+    // In place: `frames` interleaved frames of config().channels channels
+    void process(float* interleaved, size_t frames);
+    void process(int16_t* interleaved, size_t frames); // PCM16, same scaling as WAV I/O
+
+    uint64_t framesProcessed() const;
+    Features lastFeatures() const; // most recent analysis frame
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+// File render with the default (no-op) controller, as the CLI does.
+// Returns false and sets `error` if the input can't be read or output written.
+bool renderFile(const std::string& in, const std::string& out, const Params& params,
+                std::string* error = nullptr);
+
+} // namespace SmartTremolo
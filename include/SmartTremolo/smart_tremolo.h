@@ -0,0 +1,59 @@
+#ifndef SMART_TREMOLO_H
+#define SMART_TREMOLO_H
+
+/* C ABI over SmartTremolo::Engine (built when SMART_TREMOLO_C_API is ON).
+ * Handles are opaque; functions return ST_OK or a negative st_status and
+ * never throw. Same semantics as the C++ API in Engine.h. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct st_engine st_engine;
+
+typedef enum st_status {
+    ST_OK = 0,
+    ST_ERR_INVALID = -1, /* null handle/buffer or unknown parameter */
+    ST_ERR_IO = -2,      /* file could not be read or written */
+    ST_ERR_INTERNAL = -3 /* allocation failure or unexpected exception */
+} st_status;
+
+typedef enum st_param {
+    ST_PARAM_RATE_HZ = 0,
+    ST_PARAM_DEPTH = 1,
+    ST_PARAM_WET = 2,
+    ST_PARAM_STEREO_PHASE_DEG = 3,
+    ST_PARAM_SHAPE = 4,   /* 0 sine, 1 triangle, 2 square, 3 square-soft,
+                             4 square-bl, 5 triangle-bl (band-limited) */
+    ST_PARAM_ACCURACY = 5, /* 0 exact, 1 table, 2 poly */
+    ST_PARAM_PHASE_MODE = 6 /* 0 float, 1 fixed-point */
+} st_param;
+
+const char* st_version(void);
+
+/* block_frames/hop of 0 use the defaults (512 / 1024). NULL on failure. */
+st_engine* st_engine_create(int sample_rate, int channels, size_t block_frames, size_t hop);
+void st_engine_destroy(st_engine* e);
+
+/* Enum parameters take the enumerator's value. Non-finite values and
+   out-of-range enums return ST_ERR_INVALID and change nothing. */
+int st_engine_set_param(st_engine* e, st_param param, float value);
+int st_engine_get_param(const st_engine* e, st_param param, float* value);
+int st_engine_set_channel_phases(st_engine* e, const float* deg, size_t count);
+int st_engine_reset(st_engine* e);
+
+/* In place on `frames` interleaved frames */
+int st_engine_process_f32(st_engine* e, float* interleaved, size_t frames);
+int st_engine_process_s16(st_engine* e, int16_t* interleaved, size_t frames);
+
+/* File render with the engine's current parameters */
+int st_render_file(const st_engine* e, const char* in_path, const char* out_path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SMART_TREMOLO_H */
@@ -0,0 +1,81 @@
+#include "AllocCounter.h"
+#include <cstdio>
+#include <cstdlib>
+
+#if defined(SMART_TREMOLO_ALLOC_CHECK)
+#include <new>
+
+namespace {
+
+thread_local uint64_t tAllocations = 0;
+
+void* allocate(std::size_t n) {
+    ++tAllocations;
+    return std::malloc(n ? n : 1);
+}
+
+void* allocateAligned(std::size_t n, std::align_val_t al) {
+    ++tAllocations;
+    const std::size_t a = static_cast<std::size_t>(al);
+    n = (n + a - 1) / a * a; // aligned_alloc wants a multiple of the alignment
+#if defined(_WIN32)
+    return _aligned_malloc(n ? n : a, a);
+#else
+    return std::aligned_alloc(a, n ? n : a);
+#endif
+}
+
+void releaseAligned(void* p) {
+#if defined(_WIN32)
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+void* orThrow(void* p) {
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+} // namespace
+
+void* operator new(std::size_t n) { return orThrow(allocate(n)); }
+void* operator new[](std::size_t n) { return orThrow(allocate(n)); }
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept { return allocate(n); }
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept { return allocate(n); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+void* operator new(std::size_t n, std::align_val_t al) { return orThrow(allocateAligned(n, al)); }
+void* operator new[](std::size_t n, std::align_val_t al) { return orThrow(allocateAligned(n, al)); }
+void* operator new(std::size_t n, std::align_val_t al, const std::nothrow_t&) noexcept { return allocateAligned(n, al); }
+void* operator new[](std::size_t n, std::align_val_t al, const std::nothrow_t&) noexcept { return allocateAligned(n, al); }
+void operator delete(void* p, std::align_val_t) noexcept { releaseAligned(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { releaseAligned(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { releaseAligned(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { releaseAligned(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { releaseAligned(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { releaseAligned(p); }
+
+bool AllocCounter::enabled() { return true; }
+uint64_t AllocCounter::threadCount() { return tAllocations; }
+
+#else
+
+bool AllocCounter::enabled() { return false; }
+uint64_t AllocCounter::threadCount() { return 0; }
+
+#endif
+
+AllocCounter::NoAllocScope::~NoAllocScope() {
+    const uint64_t n = threadCount() - start_;
+    if (n == 0 || !what_) return;
+    std::fprintf(stderr, "SMART_TREMOLO_ALLOC_CHECK: %llu heap allocation(s) in %s\n",
+                 static_cast<unsigned long long>(n), what_);
+    std::abort();
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+
+// Heap allocation counting (SMART_TREMOLO_ALLOC_CHECK, on in Debug builds)
+// - AllocCounter.cpp replaces the global operator new/delete and counts
+//   allocations per thread; without the define they are the standard ones
+// - SMART_TREMOLO_NO_ALLOC_SCOPE("what") marks code that must not allocate
+//   (the steady-state block loop, Tremolo::process, the live callback):
+//   an allocation on this thread inside the scope aborts with `what`;
+//   the _IF form only checks while `cond` holds
+namespace AllocCounter {
+    bool enabled();            // counting compiled in
+    uint64_t threadCount();    // allocations made by this thread so far (0 if disabled)
+
+    struct NoAllocScope {
+        explicit NoAllocScope(const char* what, bool armed = true)
+            : what_(armed ? what : nullptr), start_(threadCount()) {}
+        ~NoAllocScope();
+        NoAllocScope(const NoAllocScope&) = delete;
+        NoAllocScope& operator=(const NoAllocScope&) = delete;
+
+    private:
+        const char* what_;
+        uint64_t start_;
+    };
+}
+
+#if defined(SMART_TREMOLO_ALLOC_CHECK)
+#define SMART_TREMOLO_ALLOC_CAT2(a, b) a##b
+#define SMART_TREMOLO_ALLOC_CAT(a, b) SMART_TREMOLO_ALLOC_CAT2(a, b)
+#define SMART_TREMOLO_NO_ALLOC_SCOPE(what) \
+    AllocCounter::NoAllocScope SMART_TREMOLO_ALLOC_CAT(noAllocScope_, __LINE__)(what)
+#define SMART_TREMOLO_NO_ALLOC_SCOPE_IF(cond, what) \
+    AllocCounter::NoAllocScope SMART_TREMOLO_ALLOC_CAT(noAllocScope_, __LINE__)((what), (cond))
+#else
+#define SMART_TREMOLO_NO_ALLOC_SCOPE(what) ((void)0)
+#define SMART_TREMOLO_NO_ALLOC_SCOPE_IF(cond, what) ((void)0)
+#endif
@@ -0,0 +1,104 @@
+#include "AsyncController.h"
+#include <chrono>
+#include <vector>
+
+AsyncController::AsyncController(Controller& inner) : inner_(inner) {
+    thread_ = std::thread([this]{ worker(); });
+}
+
+AsyncController::~AsyncController() {
+    running_.store(false, std::memory_order_release);
+    cv_.notify_one();
+    if (thread_.joinable()) thread_.join();
+}
+
+bool AsyncController::push(uint64_t frame, double timeSeconds, float rms, float zcr, float rateHz, float depth) {
+    return post({frame, timeSeconds, rms, zcr, rateHz, depth, 0u, 0.f, 0.f, 0.f, 0.f});
+}
+
+bool AsyncController::push(uint64_t frame, double timeSeconds, const FeatureExtractor& f, float rateHz,
+                           float depth) {
+    return post({frame, timeSeconds, f.rms(), f.zcr(), rateHz, depth, f.features(),
+                 f.peak(), f.crest(), f.onset(), f.centroid()});
+}
+
+bool AsyncController::post(const Request& q) {
+    if (!requests_.push(q)) {
+        dropped_++;
+        return false;
+    }
+    posted_++;
+    // no notify: that can be a futex syscall on the audio thread; the worker
+    // polls the queue every millisecond instead
+    return true;
+}
+
+bool AsyncController::poll(uint64_t frame, float& rateHz, float& depth) {
+    if (!(middle_.load(std::memory_order_relaxed) & Fresh)) return false;
+    front_ = middle_.exchange(front_, std::memory_order_acq_rel) & ~Fresh;
+    const Result& r = slots_[front_];
+    const uint64_t late = frame > r.frame ? frame - r.frame : 0;
+    latencySum_ += late;
+    if (late > latencyMax_) latencyMax_ = late;
+    applied_ = r.handled;
+    pickups_++;
+    rateHz = r.rate;
+    depth = r.depth;
+    return true;
+}
+
+void AsyncController::wake() {
+    // notify without the mutex; the worker's timed wait covers a missed wakeup
+    cv_.notify_one();
+}
+
+void AsyncController::flush() {
+    while (handled_.load(std::memory_order_acquire) < posted_)
+        std::this_thread::yield();
+}
+
+AsyncController::Stats AsyncController::stats() const {
+    Stats s;
+    s.posted = posted_;
+    s.dropped = dropped_;
+    s.applied = applied_;
+    s.avgLatencyFrames = pickups_ ? double(latencySum_) / double(pickups_) : 0.0;
+    s.maxLatencyFrames = latencyMax_;
+    return s;
+}
+
+void AsyncController::worker() {
+    // drain everything pending into one batched update()
+    ControllerFrames batch;
+    std::vector<uint64_t> frames;
+    batch.reserve(64, FeatureExtractor::AllFeatures);
+    frames.reserve(64);
+    Request q;
+    uint64_t handled = 0;
+    while (running_.load(std::memory_order_acquire)) {
+        batch.clear();
+        frames.clear();
+        while (frames.size() < 64 && requests_.pop(q)) {
+            batch.push(q.time, q.rms, q.zcr, q.rate, q.depth);
+            if (q.features & FeatureExtractor::Peak) batch.peak.push_back(q.peak);
+            if (q.features & FeatureExtractor::Crest) batch.crest.push_back(q.crest);
+            if (q.features & FeatureExtractor::Onset) batch.onset.push_back(q.onset);
+            if (q.features & FeatureExtractor::Centroid) batch.centroid.push_back(q.centroid);
+            frames.push_back(q.frame);
+        }
+        if (frames.empty()) {
+            // woken early only by wake() and the destructor
+            std::unique_lock<std::mutex> lk(m_);
+            cv_.wait_for(lk, std::chrono::milliseconds(1));
+            continue;
+        }
+        inner_.updateBatch(batch.view());
+        // publish only the newest result; poll() applies no other, and one it
+        // has not picked up yet is simply replaced
+        const size_t last = frames.size() - 1;
+        handled += frames.size();
+        slots_[back_] = {frames[last], handled, batch.rateHz[last], batch.depth[last]};
+        back_ = middle_.exchange(back_ | Fresh, std::memory_order_acq_rel) & ~Fresh;
+        handled_.store(handled, std::memory_order_release);
+    }
+}
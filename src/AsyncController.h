@@ -0,0 +1,99 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include "Controller.h"
+#include "SpscQueue.h"
+
+// Runs a Controller on its own worker thread so a slow update() never stalls
+// the audio path. The audio thread push()es feature frames and poll()s for
+// results at block boundaries; both sides are lock-free and make no system
+// calls (the worker polls the request queue every millisecond rather than
+// being signalled). Results arrive some frames after the features they were
+// computed from (see Stats), which the Tremolo's smoothers hide. Only the
+// newest result is kept: one the audio thread has not picked up yet is
+// overwritten by the next, so the worker never waits on poll(). The wrapped
+// controller is only ever called from the worker, so it need not be
+// thread-safe.
+struct AsyncController {
+    struct Stats {
+        uint64_t posted = 0;  // feature frames handed to the worker
+        uint64_t dropped = 0; // feature frames lost because the worker fell behind
+        uint64_t applied = 0; // frames whose result poll() picked up, or a newer one that superseded it
+        double avgLatencyFrames = 0.0; // newest feature frame -> block that applies its result
+        uint64_t maxLatencyFrames = 0;
+    };
+
+    explicit AsyncController(Controller& inner);
+    ~AsyncController();
+
+    AsyncController(const AsyncController&) = delete;
+    AsyncController& operator=(const AsyncController&) = delete;
+
+    // Audio thread. `frame` is the index of the sample that completed the
+    // analysis frame; rate/depth are the current values passed to update().
+    // Returns false if the request queue is full (the frame is dropped).
+    bool push(uint64_t frame, double timeSeconds, float rms, float zcr, float rateHz, float depth);
+    // Same, with rms/zcr and the enabled opt-in features (peak, crest, onset,
+    // centroid) of the extractor's last frame, for the controller's updateBatch()
+    bool push(uint64_t frame, double timeSeconds, const FeatureExtractor& f, float rateHz, float depth);
+
+    // Audio thread, at a block boundary starting at `frame`. Takes the newest
+    // finished result, if any, and returns true with rate/depth updated.
+    bool poll(uint64_t frame, float& rateHz, float& depth);
+
+    // Wakes the worker now rather than at its next poll. This may make a
+    // system call, so only non-realtime callers (offline renders) use it.
+    void wake();
+
+    // Blocks until every pushed frame has been handled (offline renders / tests);
+    // the next poll() then returns the result of the last one
+    void flush();
+
+    Stats stats() const;
+
+private:
+    struct Request {
+        uint64_t frame;
+        double time;
+        float rms, zcr, rate, depth;
+        unsigned features; // FeatureExtractor mask of the opt-in values below
+        float peak, crest, onset, centroid;
+    };
+    struct Result {
+        uint64_t frame;
+        uint64_t handled; // frames handled up to and including this one
+        float rate, depth;
+    };
+
+    bool post(const Request& q);
+    void worker();
+
+    Controller& inner_;
+    SpscQueue<Request, 64> requests_;
+
+    // Newest-result mailbox (triple buffer): the worker fills slots_[back_]
+    // and swaps it into middle_; poll() swaps middle_ with slots_[front_]
+    // when the Fresh bit says it holds a result it has not seen
+    static constexpr unsigned Fresh = 4;
+    Result slots_[3] = {};
+    alignas(64) std::atomic<unsigned> middle_{1};
+    unsigned front_ = 0; // audio thread
+    unsigned back_ = 2;  // worker
+
+    std::thread thread_;
+    std::atomic<bool> running_{true};
+    std::atomic<uint64_t> handled_{0}; // written by the worker
+    std::mutex m_;                     // worker sleep / shutdown only; never taken by push()/poll()
+    std::condition_variable cv_;
+
+    // audio-thread statistics
+    uint64_t posted_ = 0;
+    uint64_t dropped_ = 0;
+    uint64_t applied_ = 0;
+    uint64_t pickups_ = 0;
+    uint64_t latencySum_ = 0;
+    uint64_t latencyMax_ = 0;
+};
@@ -0,0 +1,86 @@
+#include "AudioDevice.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#if defined(SMART_TREMOLO_HAVE_ALSA)
+std::unique_ptr<AudioDevice> makeAlsaAudioDevice(); // AudioDeviceAlsa.cpp
+#endif
+
+namespace {
+
+// Hardware-free device: a thread that calls the callback on the period clock
+// and discards the audio. Useful headless and for measuring callback cost.
+// A callback that finishes past its period deadline counts as an xrun.
+struct NullAudioDevice : AudioDevice {
+    ~NullAudioDevice() override { stop(); }
+
+    bool open(const AudioConfig& cfg, RenderCallback cb) override {
+        if (cfg.sampleRate <= 0 || cfg.channels < 1 || cfg.periodFrames == 0 || !cb) return false;
+        cfg_ = cfg;
+        cb_ = std::move(cb);
+        buf_.assign(cfg.periodFrames * size_t(cfg.channels), 0.0f);
+        return true;
+    }
+
+    bool start() override {
+        if (!cb_ || running_) return false;
+        running_ = true;
+        thread_ = std::thread([this]{ loop(); });
+        return true;
+    }
+
+    void stop() override {
+        running_ = false;
+        if (thread_.joinable()) thread_.join();
+    }
+
+    const char* name() const override { return "null"; }
+    uint64_t xruns() const override { return xruns_.load(std::memory_order_relaxed); }
+
+private:
+    void loop() {
+        using clock = std::chrono::steady_clock;
+        const auto period = std::chrono::duration_cast<clock::duration>(
+            std::chrono::duration<double>(double(cfg_.periodFrames) / double(cfg_.sampleRate)));
+        auto deadline = clock::now() + period;
+        while (running_) {
+            cb_(buf_.data(), cfg_.periodFrames, cfg_.channels);
+            if (clock::now() > deadline) {
+                xruns_.fetch_add(1, std::memory_order_relaxed);
+                deadline = clock::now(); // resync like a real device restart
+            } else {
+                std::this_thread::sleep_until(deadline);
+            }
+            deadline += period;
+        }
+    }
+
+    AudioConfig cfg_;
+    RenderCallback cb_;
+    std::vector<float> buf_;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> xruns_{0};
+};
+
+} // namespace
+
+std::unique_ptr<AudioDevice> AudioDevice::create(const std::string& backend) {
+    if (backend == "null") return std::make_unique<NullAudioDevice>();
+#if defined(SMART_TREMOLO_HAVE_ALSA)
+    if (backend == "alsa" || backend == "default") return makeAlsaAudioDevice();
+#else
+    if (backend == "default") return std::make_unique<NullAudioDevice>();
+#endif
+    return nullptr;
+}
+
+std::vector<std::string> AudioDevice::backends() {
+    std::vector<std::string> b;
+#if defined(SMART_TREMOLO_HAVE_ALSA)
+    b.push_back("alsa");
+#endif
+    b.push_back("null");
+    return b;
+}
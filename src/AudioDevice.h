@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct AudioConfig {
+    int sampleRate = 48000;
+    int channels = 2;
+    size_t periodFrames = 256; // frames per callback
+    std::string deviceName;    // backend-specific ("default" for ALSA)
+};
+
+// Output-only audio device. The backend owns the audio thread and calls the
+// render callback once per period with an interleaved float buffer to fill.
+// The callback must not block, lock or allocate.
+struct AudioDevice {
+    using RenderCallback = std::function<void(float* interleaved, size_t frames, int channels)>;
+
+    virtual ~AudioDevice() = default;
+
+    virtual bool open(const AudioConfig& cfg, RenderCallback cb) = 0;
+    virtual bool start() = 0;
+    virtual void stop() = 0;
+    virtual const char* name() const = 0;
+
+    // Buffer under/overruns reported by the backend so far
+    virtual uint64_t xruns() const = 0;
+
+    // "null" (timer-driven, no hardware) and, when compiled in, "alsa".
+    // Returns nullptr for unknown or unavailable backends.
+    static std::unique_ptr<AudioDevice> create(const std::string& backend);
+    static std::vector<std::string> backends();
+};
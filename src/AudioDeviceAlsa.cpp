@@ -0,0 +1,87 @@
+// ALSA playback backend (Linux). Compiled only when CMake finds ALSA.
+#if defined(SMART_TREMOLO_HAVE_ALSA)
+
+#include "AudioDevice.h"
+#include <alsa/asoundlib.h>
+#include <atomic>
+#include <cerrno>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct AlsaAudioDevice : AudioDevice {
+    ~AlsaAudioDevice() override {
+        stop();
+        if (pcm_) snd_pcm_close(pcm_);
+    }
+
+    bool open(const AudioConfig& cfg, RenderCallback cb) override {
+        if (!cb || cfg.channels < 1 || cfg.periodFrames == 0) return false;
+        const std::string dev = cfg.deviceName.empty() ? "default" : cfg.deviceName;
+        if (snd_pcm_open(&pcm_, dev.c_str(), SND_PCM_STREAM_PLAYBACK, 0) < 0) { pcm_ = nullptr; return false; }
+        // ~3 periods of latency
+        const unsigned latencyUs = unsigned(3.0 * 1e6 * double(cfg.periodFrames) / double(cfg.sampleRate));
+        if (snd_pcm_set_params(pcm_, SND_PCM_FORMAT_FLOAT_LE, SND_PCM_ACCESS_RW_INTERLEAVED,
+                               unsigned(cfg.channels), unsigned(cfg.sampleRate), 1, latencyUs) < 0) {
+            snd_pcm_close(pcm_);
+            pcm_ = nullptr;
+            return false;
+        }
+        cfg_ = cfg;
+        cb_ = std::move(cb);
+        buf_.assign(cfg.periodFrames * size_t(cfg.channels), 0.0f);
+        return true;
+    }
+
+    bool start() override {
+        if (!pcm_ || running_) return false;
+        running_ = true;
+        thread_ = std::thread([this]{ loop(); });
+        return true;
+    }
+
+    void stop() override {
+        running_ = false;
+        if (thread_.joinable()) thread_.join();
+        if (pcm_) snd_pcm_drop(pcm_);
+    }
+
+    const char* name() const override { return "alsa"; }
+    uint64_t xruns() const override { return xruns_.load(std::memory_order_relaxed); }
+
+private:
+    void loop() {
+        while (running_) {
+            cb_(buf_.data(), cfg_.periodFrames, cfg_.channels);
+            const float* p = buf_.data();
+            snd_pcm_uframes_t left = cfg_.periodFrames;
+            while (left > 0 && running_) {
+                snd_pcm_sframes_t n = snd_pcm_writei(pcm_, p, left);
+                if (n == -EPIPE) {
+                    xruns_.fetch_add(1, std::memory_order_relaxed);
+                    snd_pcm_prepare(pcm_);
+                } else if (n < 0) {
+                    if (snd_pcm_recover(pcm_, int(n), 1) < 0) { running_ = false; break; }
+                } else {
+                    left -= snd_pcm_uframes_t(n);
+                    p += size_t(n) * size_t(cfg_.channels);
+                }
+            }
+        }
+    }
+
+    snd_pcm_t* pcm_ = nullptr;
+    AudioConfig cfg_;
+    RenderCallback cb_;
+    std::vector<float> buf_;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> xruns_{0};
+};
+
+} // namespace
+
+std::unique_ptr<AudioDevice> makeAlsaAudioDevice() { return std::make_unique<AlsaAudioDevice>(); }
+
+#endif
@@ -0,0 +1,165 @@
+#include "Automation.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+float clampParam(AutoParam p, float v) {
+    switch (p) {
+        case AutoParam::Rate:        return std::max(0.0001f, v);
+        case AutoParam::StereoPhase: return std::max(0.0f, std::min(180.0f, v));
+        default:                     return std::max(0.0f, std::min(1.0f, v));
+    }
+}
+
+bool fail(std::string* error, const std::string& msg) {
+    if (error) *error = msg;
+    return false;
+}
+
+// Sorts by time keeping the given order of equal times (steps)
+void sortLane(AutomationLane& lane) {
+    std::stable_sort(lane.points.begin(), lane.points.end(),
+                     [](const Breakpoint& a, const Breakpoint& b) { return a.timeSeconds < b.timeSeconds; });
+}
+
+} // namespace
+
+float AutomationLane::valueAt(double t) const {
+    if (points.empty()) return 0.0f;
+    // last point with time <= t
+    auto it = std::upper_bound(points.begin(), points.end(), t,
+                               [](double v, const Breakpoint& b) { return v < b.timeSeconds; });
+    if (it == points.begin()) return points.front().value;
+    if (it == points.end()) return points.back().value;
+    const Breakpoint& p0 = *(it - 1);
+    const Breakpoint& p1 = *it;
+    const double slope = double(p1.value - p0.value) / (p1.timeSeconds - p0.timeSeconds);
+    return float(double(p0.value) + slope * (t - p0.timeSeconds));
+}
+
+void AutomationLane::render(uint64_t start, double sampleRate, float* out, size_t n, size_t& cursor) const {
+    if (points.empty() || n == 0) return;
+    const size_t last = points.size() - 1;
+    // Frame f is at or past breakpoint k iff f >= ceil(time_k * sampleRate)
+    auto firstFrame = [&](size_t k) { return uint64_t(std::max(0.0, std::ceil(points[k].timeSeconds * sampleRate))); };
+
+    if (cursor > last || (cursor > 0 && firstFrame(cursor) > start)) {
+        auto it = std::upper_bound(points.begin(), points.end(), start,
+                                   [&](uint64_t f, const Breakpoint& b) {
+                                       return f < uint64_t(std::max(0.0, std::ceil(b.timeSeconds * sampleRate)));
+                                   });
+        cursor = it == points.begin() ? 0 : size_t(it - points.begin()) - 1;
+    }
+
+    size_t i = 0;
+    while (i < n) {
+        const uint64_t f = start + i;
+        while (cursor < last && f >= firstFrame(cursor + 1)) ++cursor;
+        const Breakpoint& p0 = points[cursor];
+
+        if (cursor == last || f < firstFrame(cursor)) {
+            // hold: after the last point, or before the first one until it starts
+            const size_t run = cursor == last ? n - i
+                             : size_t(std::min<uint64_t>(n - i, firstFrame(cursor) - f));
+            std::fill(out + i, out + i + run, p0.value);
+            i += run;
+            continue;
+        }
+
+        const Breakpoint& p1 = points[cursor + 1];
+        const size_t run = size_t(std::min<uint64_t>(n - i, firstFrame(cursor + 1) - f));
+        const double slope = double(p1.value - p0.value) / (p1.timeSeconds - p0.timeSeconds);
+        const double invSr = 1.0 / sampleRate;
+        for (size_t j = 0; j < run; ++j)
+            out[i + j] = float(double(p0.value) + slope * (double(f + j) * invSr - p0.timeSeconds));
+        i += run;
+    }
+}
+
+bool Automation::empty() const {
+    for (const AutomationLane& l : lanes)
+        if (!l.empty()) return false;
+    return true;
+}
+
+bool Automation::parseParam(const std::string& s, AutoParam& out) {
+    auto lower = s; for (auto& c : lower) c = char(std::tolower(c));
+    if (lower == "rate") out = AutoParam::Rate;
+    else if (lower == "depth") out = AutoParam::Depth;
+    else if (lower == "wet") out = AutoParam::Wet;
+    else if (lower == "stereophase") out = AutoParam::StereoPhase;
+    else return false;
+    return true;
+}
+
+const char* Automation::paramName(AutoParam p) {
+    switch (p) {
+        case AutoParam::Rate:        return "rate";
+        case AutoParam::Depth:       return "depth";
+        case AutoParam::Wet:         return "wet";
+        case AutoParam::StereoPhase: return "stereophase";
+        default:                     return "?";
+    }
+}
+
+bool Automation::parseLane(const std::string& spec, std::string* error) {
+    const size_t colon = spec.find(':');
+    AutoParam param;
+    if (colon == std::string::npos || !parseParam(spec.substr(0, colon), param))
+        return fail(error, "automation lane must be <rate|depth|wet|stereophase>:t=v,...: " + spec);
+
+    AutomationLane out;
+    std::stringstream ss(spec.substr(colon + 1));
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        const size_t eq = item.find('=');
+        Breakpoint b;
+        try {
+            if (eq == std::string::npos) throw std::invalid_argument(item);
+            b.timeSeconds = std::stod(item.substr(0, eq));
+            b.value = std::stof(item.substr(eq + 1));
+        } catch (const std::exception&) {
+            return fail(error, "bad breakpoint '" + item + "' (expected <seconds>=<value>)");
+        }
+        if (!(b.timeSeconds >= 0.0)) return fail(error, "breakpoint times must be >= 0: " + item);
+        b.value = clampParam(param, b.value);
+        out.points.push_back(b);
+    }
+    if (out.points.empty()) return fail(error, "automation lane has no breakpoints: " + spec);
+    sortLane(out);
+    lane(param) = std::move(out);
+    return true;
+}
+
+bool Automation::load(const std::string& path, std::string* error) {
+    std::ifstream f(path);
+    if (!f) return fail(error, "cannot open automation file " + path);
+    Automation parsed;
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(f, line)) {
+        ++lineNo;
+        const size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+        std::istringstream ls(line);
+        std::string name;
+        if (!(ls >> name)) continue; // blank
+        AutoParam param;
+        Breakpoint b;
+        if (!parseParam(name, param) || !(ls >> b.timeSeconds >> b.value) || !(b.timeSeconds >= 0.0))
+            return fail(error, path + ":" + std::to_string(lineNo) + ": expected <param> <seconds> <value>");
+        b.value = clampParam(param, b.value);
+        parsed.lane(param).points.push_back(b);
+    }
+    for (size_t p = 0; p < parsed.lanes.size(); ++p) {
+        if (parsed.lanes[p].empty()) continue;
+        sortLane(parsed.lanes[p]);
+        lanes[p] = std::move(parsed.lanes[p]);
+    }
+    return true;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Automatable Tremolo parameters (units as the setters: Hz, 0..1, 0..1, deg)
+enum class AutoParam { Rate, Depth, Wet, StereoPhase, Count };
+
+struct Breakpoint {
+    double timeSeconds = 0.0;
+    float value = 0.0f;
+};
+
+// One parameter's breakpoints, sorted by time. Values are linear between
+// breakpoints and hold before the first / after the last one; two points at
+// the same time make a step.
+struct AutomationLane {
+    std::vector<Breakpoint> points;
+
+    bool empty() const { return points.empty(); }
+    float valueAt(double timeSeconds) const;
+
+    // out[i] = value at frame start + i (time = frame / sampleRate). `cursor`
+    // caches the current segment between calls; any value is valid, a
+    // forward-moving render just never searches.
+    void render(uint64_t start, double sampleRate, float* out, size_t n, size_t& cursor) const;
+};
+
+// Lanes for all parameters; a non-empty lane overrides the parameter's
+// setter (and any controller writing it) for the whole render
+struct Automation {
+    std::array<AutomationLane, size_t(AutoParam::Count)> lanes;
+
+    AutomationLane& lane(AutoParam p) { return lanes[size_t(p)]; }
+    const AutomationLane& lane(AutoParam p) const { return lanes[size_t(p)]; }
+    bool has(AutoParam p) const { return !lane(p).empty(); }
+    bool empty() const;
+
+    // Adds one lane from "depth:0=0.6,5=0.1,8=0.6" (param:time=value,...,
+    // times in seconds). Replaces that parameter's lane.
+    bool parseLane(const std::string& spec, std::string* error = nullptr);
+
+    // Merges a file of "<param> <time> <value>" lines (# comments, blank lines)
+    bool load(const std::string& path, std::string* error = nullptr);
+
+    static bool parseParam(const std::string& s, AutoParam& out); // rate|depth|wet|stereophase
+    static const char* paramName(AutoParam p);
+};
@@ -0,0 +1,120 @@
+#include "Batch.h"
+#include "BufferPool.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <ostream>
+
+namespace fs = std::filesystem;
+
+// '*' and '?' wildcards, no character classes
+static bool wildcardMatch(const char* p, const char* s) {
+    if (*p == '\0') return *s == '\0';
+    if (*p == '*') return wildcardMatch(p + 1, s) || (*s && wildcardMatch(p, s + 1));
+    if (*s && (*p == '?' || *p == *s)) return wildcardMatch(p + 1, s + 1);
+    return false;
+}
+
+std::vector<std::string> Batch::expandInputs(const std::string& spec) {
+    std::vector<std::string> out;
+    if (spec.find_first_of("*?") != std::string::npos) {
+        const fs::path pattern(spec);
+        fs::path dir = pattern.parent_path();
+        if (dir.empty()) dir = ".";
+        const std::string name = pattern.filename().string();
+        std::error_code ec;
+        for (const auto& e : fs::directory_iterator(dir, ec)) {
+            if (!e.is_regular_file()) continue;
+            if (wildcardMatch(name.c_str(), e.path().filename().string().c_str()))
+                out.push_back(e.path().string());
+        }
+        std::sort(out.begin(), out.end());
+        return out;
+    }
+
+    std::ifstream list(spec);
+    std::string line;
+    while (std::getline(list, line)) {
+        while (!line.empty() && (line.back() == '\r' || line.back() == ' ' || line.back() == '\t')) line.pop_back();
+        size_t b = line.find_first_not_of(" \t");
+        if (b == std::string::npos || line[b] == '#') continue;
+        out.push_back(line.substr(b));
+    }
+    return out;
+}
+
+size_t Batch::run(const std::vector<std::string>& inputs, const BatchOptions& opt, std::ostream& log) {
+    std::error_code ec;
+    if (!opt.outDir.empty()) fs::create_directories(opt.outDir, ec);
+
+    // outputs are flat in outDir, so inputs sharing a file name would race on
+    // one output; the first one wins and the others fail before rendering
+    const size_t npos = size_t(-1);
+    std::vector<fs::path> outputs(inputs.size());
+    std::vector<size_t> clashesWith(inputs.size(), npos);
+    std::map<std::string, size_t> claimed;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        outputs[i] = (fs::path(opt.outDir) / fs::path(inputs[i]).filename()).lexically_normal();
+        auto ins = claimed.emplace(outputs[i].string(), i);
+        if (!ins.second) clashesWith[i] = ins.first->second;
+    }
+
+    std::vector<RenderResult> results(inputs.size());
+    std::mutex logMutex;
+    const auto t0 = std::chrono::steady_clock::now();
+    {
+        // the batch pool is the parallelism: a segment pool per job would run
+        // N x N threads and spawn a fresh pool per file
+        RenderParams params = opt.params;
+        params.threads = 1;
+        const unsigned threads = opt.threads ? opt.threads : ThreadPool::defaultThreads();
+        BufferPool<RenderWorkspace> workspaces(threads); // one per busy worker; outlives the pool
+        ThreadPool pool(threads);
+        log << "[batch] " << inputs.size() << " files on " << pool.size() << " threads\n";
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            pool.submit([&, i] {
+                const fs::path in(inputs[i]);
+                const fs::path& out = outputs[i];
+                std::error_code eq;
+                if (clashesWith[i] != npos) {
+                    results[i].error = "output " + out.string() + " is already written by " + inputs[clashesWith[i]];
+                } else if (fs::equivalent(in, out, eq)) {
+                    results[i].error = "output would overwrite the input";
+                } else {
+                    BufferPool<RenderWorkspace>::Lease ws(workspaces);
+                    results[i] = Pipeline::renderFile(in.string(), out.string(), params, nullptr, &*ws);
+                }
+
+                const RenderResult& r = results[i];
+                std::lock_guard<std::mutex> lock(logMutex);
+                if (r.ok) {
+                    log << "[batch] " << in.string() << " -> " << out.string()
+                        << " (" << r.audioSeconds() << " s audio, "
+                        << (r.wallSeconds > 0 ? r.audioSeconds() / r.wallSeconds : 0.0) << "x realtime";
+                    if (opt.params.silencePeak > 0.0f && r.frames)
+                        log << ", " << 100.0 * double(r.skippedFrames) / double(r.frames) << "% silence skipped";
+                    log << ")\n";
+                } else {
+                    log << "[batch] FAILED " << in.string() << ": " << r.error << "\n";
+                }
+            });
+        }
+        pool.wait();
+    }
+    const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    double audio = 0.0;
+    size_t failed = 0;
+    for (const auto& r : results) {
+        if (r.ok) audio += r.audioSeconds();
+        else ++failed;
+    }
+    log << "[batch] done: " << (inputs.size() - failed) << " ok, " << failed << " failed, "
+        << audio << " s audio in " << wall << " s wall = "
+        << (wall > 0 ? audio / wall : 0.0) << "x realtime\n";
+    return failed;
+}
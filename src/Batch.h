@@ -0,0 +1,25 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <iosfwd>
+#include "Pipeline.h"
+
+struct BatchOptions {
+    std::string outDir;        // outputs keep the input file name; duplicates fail
+    unsigned threads = 0;      // 0 = one worker per hardware thread
+    RenderParams params;
+};
+
+// Many independent renderFile() jobs on a worker pool. Each job has its own
+// Tremolo/FeatureExtractor/Controller; with more jobs than cores, one job's
+// disk I/O overlaps another job's DSP.
+namespace Batch {
+    // `spec` is either a glob on the last path component ("stems/*.wav") or a
+    // list file with one input path per line (blank lines and # comments skipped)
+    std::vector<std::string> expandInputs(const std::string& spec);
+
+    // Renders all inputs, printing one line per job and a throughput summary
+    // (realtime factor = audio seconds / wall seconds). Returns the number of
+    // failed jobs.
+    size_t run(const std::vector<std::string>& inputs, const BatchOptions& opt, std::ostream& log);
+}
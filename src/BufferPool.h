@@ -0,0 +1,61 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Fixed set of reusable objects (render workspaces, job buffers) shared by
+// worker threads: acquire() blocks until one is free, release() hands it
+// back. Objects live as long as the pool, so their vectors keep their
+// capacity from one job to the next and a steady stream of same-sized jobs
+// stops allocating after the first few.
+template <class T>
+struct BufferPool {
+    explicit BufferPool(size_t n) {
+        items_.resize(n ? n : 1);
+        for (auto& t : items_) {
+            t.reset(new T);
+            free_.push_back(t.get());
+        }
+    }
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    T* acquire() {
+        std::unique_lock<std::mutex> lock(m_);
+        cv_.wait(lock, [this]{ return !free_.empty(); });
+        T* t = free_.back();
+        free_.pop_back();
+        return t;
+    }
+    void release(T* t) {
+        {
+            std::lock_guard<std::mutex> lock(m_);
+            free_.push_back(t);
+        }
+        cv_.notify_one();
+    }
+
+    size_t size() const { return items_.size(); }
+
+    // acquire() for the lifetime of a scope
+    struct Lease {
+        explicit Lease(BufferPool& p) : pool_(p), t_(p.acquire()) {}
+        ~Lease() { pool_.release(t_); }
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        T& operator*() const { return *t_; }
+        T* operator->() const { return t_; }
+
+    private:
+        BufferPool& pool_;
+        T* t_;
+    };
+
+private:
+    std::vector<std::unique_ptr<T>> items_;
+    std::vector<T*> free_; // LIFO: the most recently used (warm) object goes out first
+    std::mutex m_;
+    std::condition_variable cv_;
+};
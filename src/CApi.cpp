@@ -0,0 +1,118 @@
+#include "SmartTremolo/smart_tremolo.h"
+#include "SmartTremolo/Engine.h"
+#include <cmath>
+#include <new>
+
+using SmartTremolo::Engine;
+using SmartTremolo::Params;
+
+struct st_engine {
+    Engine engine;
+    explicit st_engine(const SmartTremolo::Config& c) : engine(c) {}
+};
+
+const char* st_version(void) { return SmartTremolo::versionString(); }
+
+st_engine* st_engine_create(int sample_rate, int channels, size_t block_frames, size_t hop) {
+    if (sample_rate <= 0 || channels < 1) return nullptr;
+    SmartTremolo::Config c;
+    c.sampleRate = sample_rate;
+    c.channels = channels;
+    if (block_frames) c.blockFrames = block_frames;
+    if (hop) c.hop = hop;
+    try {
+        return new st_engine(c);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void st_engine_destroy(st_engine* e) { delete e; }
+
+int st_engine_set_param(st_engine* e, st_param param, float value) {
+    if (!e || !std::isfinite(value)) return ST_ERR_INVALID;
+    Params p = e->engine.params();
+    switch (param) {
+        case ST_PARAM_RATE_HZ:          p.rateHz = value; break;
+        case ST_PARAM_DEPTH:            p.depth = value; break;
+        case ST_PARAM_WET:              p.wet = value; break;
+        case ST_PARAM_STEREO_PHASE_DEG: p.stereoPhaseDeg = value; break;
+        // written so that NaN fails the range check too
+        case ST_PARAM_SHAPE:
+            if (!(value >= 0.0f && value <= 5.0f)) return ST_ERR_INVALID;
+            p.shape = SmartTremolo::Shape(int(value));
+            break;
+        case ST_PARAM_ACCURACY:
+            if (!(value >= 0.0f && value <= 2.0f)) return ST_ERR_INVALID;
+            p.accuracy = SmartTremolo::LfoAccuracy(int(value));
+            break;
+        case ST_PARAM_PHASE_MODE:
+            if (!(value >= 0.0f && value <= 1.0f)) return ST_ERR_INVALID;
+            p.phase = SmartTremolo::PhaseMode(int(value));
+            break;
+        default: return ST_ERR_INVALID;
+    }
+    e->engine.setParams(p);
+    return ST_OK;
+}
+
+int st_engine_get_param(const st_engine* e, st_param param, float* value) {
+    if (!e || !value) return ST_ERR_INVALID;
+    const Params& p = e->engine.params();
+    switch (param) {
+        case ST_PARAM_RATE_HZ:          *value = p.rateHz; break;
+        case ST_PARAM_DEPTH:            *value = p.depth; break;
+        case ST_PARAM_WET:              *value = p.wet; break;
+        case ST_PARAM_STEREO_PHASE_DEG: *value = p.stereoPhaseDeg; break;
+        case ST_PARAM_SHAPE:            *value = float(int(p.shape)); break;
+        case ST_PARAM_ACCURACY:         *value = float(int(p.accuracy)); break;
+        case ST_PARAM_PHASE_MODE:       *value = float(int(p.phase)); break;
+        default: return ST_ERR_INVALID;
+    }
+    return ST_OK;
+}
+
+int st_engine_set_channel_phases(st_engine* e, const float* deg, size_t count) {
+    if (!e || (count && !deg)) return ST_ERR_INVALID;
+    try {
+        e->engine.setChannelPhaseDeg(deg, count);
+    } catch (...) {
+        return ST_ERR_INTERNAL;
+    }
+    return ST_OK;
+}
+
+int st_engine_reset(st_engine* e) {
+    if (!e) return ST_ERR_INVALID;
+    e->engine.reset();
+    return ST_OK;
+}
+
+int st_engine_process_f32(st_engine* e, float* interleaved, size_t frames) {
+    if (!e || (frames && !interleaved)) return ST_ERR_INVALID;
+    try {
+        e->engine.process(interleaved, frames);
+    } catch (...) {
+        return ST_ERR_INTERNAL;
+    }
+    return ST_OK;
+}
+
+int st_engine_process_s16(st_engine* e, int16_t* interleaved, size_t frames) {
+    if (!e || (frames && !interleaved)) return ST_ERR_INVALID;
+    try {
+        e->engine.process(interleaved, frames); // may grow the scratch buffer
+    } catch (...) {
+        return ST_ERR_INTERNAL;
+    }
+    return ST_OK;
+}
+
+int st_render_file(const st_engine* e, const char* in_path, const char* out_path) {
+    if (!e || !in_path || !out_path) return ST_ERR_INVALID;
+    try {
+        return SmartTremolo::renderFile(in_path, out_path, e->engine.params()) ? ST_OK : ST_ERR_IO;
+    } catch (...) {
+        return ST_ERR_INTERNAL;
+    }
+}
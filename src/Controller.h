@@ -1,40 +1,149 @@
-#pragma once
-
-// ------------------------------------------------------------
-// Controller Interface
-// ------------------------------------------------------------
-// This interface defines how an external controller (e.g. an AI agent)
-// can modify real-time tremolo parameters based on extracted audio features.
-//
-// The Tremolo effect calls Controller::update() periodically (once every
-// analysis frame, e.g. every 1024 samples). You can implement this interface
-// to make parameters like rateHz or depth adapt dynamically.
-//
-// Example use case:
-// - Make tremolo depth follow RMS loudness
-// - Make rate increase with Zero-Crossing Rate (ZCR)
-// - Connect a neural network or rule-based system later
-// ------------------------------------------------------------
-
-struct Controller {
-    virtual ~Controller() = default;
-
-    // Called periodically by main processing loop.
-    //
-    // Parameters:
-    //   timeSeconds : current time in seconds since processing start
-    //   rms         : root-mean-square loudness of last frame
-    //   zcr         : zero-crossing rate of last frame
-    //   rateHz      : (in/out) current LFO rate parameter; modify to change it
-    //   depth       : (in/out) current tremolo depth parameter; modify to change it
-    //
-    // Notes:
-    // - All parameters are per-channel global values (no per-channel control yet)
-    // - The function should be lightweight (no blocking or heavy allocations)
-    // - You can implement your own derived controller to add intelligence
-    virtual void update(double timeSeconds,
-                        float rms,
-                        float zcr,
-                        float& rateHz,
-                        float& depth) = 0;
-};
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "FeatureExtractor.h"
+
+// ------------------------------------------------------------
+// Controller Interface
+// ------------------------------------------------------------
+// This interface defines how an external controller (e.g. an AI agent)
+// can modify real-time tremolo parameters based on extracted audio features.
+//
+// The Tremolo effect calls Controller::update() periodically (once every
+// analysis frame, e.g. every 1024 samples). You can implement this interface
+// to make parameters like rateHz or depth adapt dynamically.
+//
+// Example use case:
+// - Make tremolo depth follow RMS loudness
+// - Make rate increase with Zero-Crossing Rate (ZCR)
+// - Connect a neural network or rule-based system later
+//
+// Controllers implement updateBatch() (many frames or streams at once, e.g.
+// one matrix evaluation of a model); update() forwards one frame to it.
+// Controllers written per frame derive from ScalarController and implement
+// update() instead.
+// ------------------------------------------------------------
+
+// Structure-of-arrays view over `count` analysis frames. Frames may come from
+// one stream (in time order) or from several streams; rateHz/depth hold the
+// current values on entry and the controller's targets on return.
+struct ControllerBatch {
+    size_t count = 0;
+    const double* timeSeconds = nullptr;
+    const float* rms = nullptr;
+    const float* zcr = nullptr;
+    float* rateHz = nullptr; // in/out
+    float* depth = nullptr;  // in/out
+    // Opt-in features (FeatureExtractor::setFeatures); null when not computed.
+    // Only updateBatch() sees them.
+    const float* peak = nullptr;
+    const float* crest = nullptr;
+    const float* onset = nullptr;
+    const float* centroid = nullptr; // cycles/sample
+};
+
+// Owning storage for a ControllerBatch; reuse one across blocks to avoid allocation
+struct ControllerFrames {
+    std::vector<double> timeSeconds;
+    std::vector<float> rms, zcr, rateHz, depth;
+    std::vector<float> peak, crest, onset, centroid; // opt-in: filled in step with push() or left empty
+
+    void reserve(size_t n) {
+        timeSeconds.reserve(n); rms.reserve(n); zcr.reserve(n); rateHz.reserve(n); depth.reserve(n);
+    }
+    // Also reserves the columns of the opt-in features in `mask`
+    void reserve(size_t n, unsigned mask) {
+        reserve(n);
+        if (mask & FeatureExtractor::Peak) peak.reserve(n);
+        if (mask & FeatureExtractor::Crest) crest.reserve(n);
+        if (mask & FeatureExtractor::Onset) onset.reserve(n);
+        if (mask & FeatureExtractor::Centroid) centroid.reserve(n);
+    }
+    void clear() {
+        timeSeconds.clear(); rms.clear(); zcr.clear(); rateHz.clear(); depth.clear();
+        peak.clear(); crest.clear(); onset.clear(); centroid.clear();
+    }
+    void push(double t, float r, float z, float rate, float d) {
+        timeSeconds.push_back(t); rms.push_back(r); zcr.push_back(z); rateHz.push_back(rate); depth.push_back(d);
+    }
+    // After push(): the extractor's enabled opt-in features of the same frame
+    void pushFeatures(const FeatureExtractor& f) {
+        const unsigned mask = f.features();
+        if (mask & FeatureExtractor::Peak) peak.push_back(f.peak());
+        if (mask & FeatureExtractor::Crest) crest.push_back(f.crest());
+        if (mask & FeatureExtractor::Onset) onset.push_back(f.onset());
+        if (mask & FeatureExtractor::Centroid) centroid.push_back(f.centroid());
+    }
+    size_t size() const { return rms.size(); }
+
+    ControllerBatch view() {
+        ControllerBatch b;
+        b.count = size();
+        b.timeSeconds = timeSeconds.data();
+        b.rms = rms.data();
+        b.zcr = zcr.data();
+        b.rateHz = rateHz.data();
+        b.depth = depth.data();
+        b.peak = peak.size() == b.count ? peak.data() : nullptr;
+        b.crest = crest.size() == b.count ? crest.data() : nullptr;
+        b.onset = onset.size() == b.count ? onset.data() : nullptr;
+        b.centroid = centroid.size() == b.count ? centroid.data() : nullptr;
+        return b;
+    }
+};
+
+struct Controller {
+    virtual ~Controller() = default;
+
+    // Called periodically by main processing loop.
+    //
+    // Parameters:
+    //   timeSeconds : current time in seconds since processing start
+    //   rms         : root-mean-square loudness of last frame
+    //   zcr         : zero-crossing rate of last frame
+    //   rateHz      : (in/out) current LFO rate parameter; modify to change it
+    //   depth       : (in/out) current tremolo depth parameter; modify to change it
+    //
+    // Notes:
+    // - All parameters are per-channel global values (no per-channel control yet)
+    // - The function should be lightweight (no blocking or heavy allocations);
+    //   wrap heavier controllers in AsyncController to run them off the audio path
+    // - You can implement your own derived controller to add intelligence
+    virtual void update(double timeSeconds,
+                        float rms,
+                        float zcr,
+                        float& rateHz,
+                        float& depth) {
+        ControllerBatch b;
+        b.count = 1;
+        b.timeSeconds = &timeSeconds;
+        b.rms = &rms;
+        b.zcr = &zcr;
+        b.rateHz = &rateHz;
+        b.depth = &depth;
+        updateBatch(b);
+    }
+
+    // Batched form: one virtual call for b.count frames
+    virtual void updateBatch(const ControllerBatch& b) = 0;
+};
+
+// Base for controllers that work one frame at a time: updateBatch() loops
+// over update()
+struct ScalarController : Controller {
+    void update(double timeSeconds, float rms, float zcr, float& rateHz, float& depth) override = 0;
+
+    void updateBatch(const ControllerBatch& b) override {
+        for (size_t i = 0; i < b.count; ++i)
+            update(b.timeSeconds[i], b.rms[i], b.zcr[i], b.rateHz[i], b.depth[i]);
+    }
+};
+
+// Default controller: leaves rate and depth unchanged
+struct NoOpController : Controller {
+    void update(double /*timeSeconds*/, float /*rms*/, float /*zcr*/,
+                float& /*rateHz*/, float& /*depth*/) override {
+        // no changes
+    }
+    void updateBatch(const ControllerBatch& /*b*/) override {}
+};
@@ -0,0 +1,202 @@
+#include "SmartTremolo/Engine.h"
+#include "AllocCounter.h"
+#include "Controller.h"
+#include "FeatureExtractor.h"
+#include "PcmCodec.h"
+#include "Pipeline.h"
+#include "Tremolo.h"
+#include <algorithm>
+#include <vector>
+
+namespace SmartTremolo {
+
+const char* versionString() { return "1.2"; }
+
+namespace {
+
+LFOShape toShape(Shape s) {
+    switch (s) {
+        case Shape::Triangle:   return LFOShape::Triangle;
+        case Shape::Square:     return LFOShape::Square;
+        case Shape::SquareSoft: return LFOShape::SquareSoft;
+        case Shape::SquareBL:   return LFOShape::SquareBL;
+        case Shape::TriangleBL: return LFOShape::TriangleBL;
+        default:                return LFOShape::Sine;
+    }
+}
+
+LFOAccuracy toAccuracy(LfoAccuracy a) {
+    switch (a) {
+        case LfoAccuracy::Table: return LFOAccuracy::Table;
+        case LfoAccuracy::Poly:  return LFOAccuracy::Poly;
+        default:                 return LFOAccuracy::Exact;
+    }
+}
+
+::PhaseMode toPhaseMode(PhaseMode m) {
+    return m == PhaseMode::Fixed ? ::PhaseMode::Fixed : ::PhaseMode::Float;
+}
+
+static_assert(FeaturePeak == FeatureExtractor::Peak && FeatureCrest == FeatureExtractor::Crest &&
+              FeatureOnset == FeatureExtractor::Onset && FeatureCentroid == FeatureExtractor::Centroid,
+              "FeatureFlags mirror the FeatureExtractor bits");
+
+Config sanitize(Config c) {
+    c.sampleRate = c.sampleRate > 0 ? c.sampleRate : 48000;
+    c.channels = std::max(1, std::min(c.channels, WavReader::MaxChannels));
+    c.blockFrames = std::max<size_t>(1, c.blockFrames);
+    c.hop = std::max<size_t>(1, std::min(c.hop, FeatureExtractor::FrameSize));
+    c.features &= FeatureExtractor::AllFeatures; // same bits as FeatureFlags
+    return c;
+}
+
+// Runs the ControlCallback over a batch, like a Controller subclass would
+struct CallbackController : Controller {
+    ControlCallback cb;
+    int sampleRate = 48000;
+
+    void updateBatch(const ControllerBatch& b) override {
+        for (size_t i = 0; i < b.count; ++i) {
+            Features f{b.timeSeconds[i], b.rms[i], b.zcr[i]};
+            if (b.peak) f.peak = b.peak[i];
+            if (b.crest) f.crest = b.crest[i];
+            if (b.onset) f.onset = b.onset[i];
+            if (b.centroid) f.centroidHz = b.centroid[i] * float(sampleRate);
+            cb(f, b.rateHz[i], b.depth[i]);
+        }
+    }
+};
+
+} // namespace
+
+struct Engine::Impl {
+    Config config;
+    Params params;
+    std::vector<float> channelPhaseDeg;
+    Tremolo trem;
+    FeatureExtractor feat;
+    CallbackController ctrl;
+    ControllerFrames frames;
+    std::vector<float> scratch; // PCM16 path
+    uint64_t framesDone = 0;
+    Features last;
+
+    Impl(const Config& c, const Params& p)
+        : config(sanitize(c)), params(p), feat(FeatureExtractor::FrameSize, config.hop) {
+        feat.setFeatures(config.features);
+        frames.reserve(config.blockFrames / config.hop + 2, config.features);
+        ctrl.sampleRate = config.sampleRate;
+        setup();
+    }
+
+    // Same order as the CLI's render setup, so both start from the same state
+    void setup() {
+        trem = Tremolo();
+        trem.setSampleRate(config.sampleRate);
+        apply();
+    }
+
+    void apply() {
+        trem.setDepth(params.depth);
+        trem.setRateHz(params.rateHz);
+        trem.setWet(params.wet);
+        trem.setStereoPhaseDeg(params.stereoPhaseDeg);
+        trem.setChannelPhaseDeg(channelPhaseDeg.data(), channelPhaseDeg.size());
+        trem.setShape(toShape(params.shape));
+        trem.setAccuracy(toAccuracy(params.accuracy));
+        trem.setPhaseMode(toPhaseMode(params.phase));
+        trem.prepare(config.channels);
+    }
+
+    void process(float* x, size_t n) {
+        SMART_TREMOLO_NO_ALLOC_SCOPE("Engine::process");
+        const int ch = config.channels;
+        const double dt = 1.0 / double(config.sampleRate);
+        while (n > 0) {
+            // spans end on the stream's block grid, as in a file render
+            const size_t todo = std::min(n, config.blockFrames - size_t(framesDone % config.blockFrames));
+            feat.pushBlock(x, todo, ch, [&](size_t offset) {
+                const uint64_t frame = framesDone + offset - 1;
+                last = Features{double(frame) * dt, feat.rms(), feat.zcr(), feat.peak(), feat.crest(),
+                                feat.onset(), feat.centroid() * float(config.sampleRate)};
+                if (ctrl.cb) {
+                    frames.push(last.timeSeconds, last.rms, last.zcr, params.rateHz, params.depth);
+                    frames.pushFeatures(feat);
+                }
+            });
+            if (frames.size() > 0) {
+                ctrl.updateBatch(frames.view());
+                trem.setRateHz(frames.rateHz.back());
+                trem.setDepth(frames.depth.back());
+                frames.clear();
+            }
+            trem.process(x, todo, ch);
+            framesDone += todo;
+            x += todo * size_t(ch);
+            n -= todo;
+        }
+    }
+};
+
+Engine::Engine(const Config& config, const Params& params) : impl_(new Impl(config, params)) {}
+Engine::~Engine() = default;
+Engine::Engine(Engine&&) noexcept = default;
+Engine& Engine::operator=(Engine&&) noexcept = default;
+
+const Config& Engine::config() const { return impl_->config; }
+const Params& Engine::params() const { return impl_->params; }
+
+void Engine::setParams(const Params& p) {
+    impl_->params = p;
+    impl_->apply();
+}
+
+void Engine::setChannelPhaseDeg(const float* deg, size_t count) {
+    count = std::min(count, size_t(WavReader::MaxChannels));
+    impl_->channelPhaseDeg.assign(deg, deg ? deg + count : deg);
+    impl_->trem.setChannelPhaseDeg(impl_->channelPhaseDeg.data(), impl_->channelPhaseDeg.size());
+    impl_->trem.prepare(impl_->config.channels); // size the tables here, not in process()
+}
+
+void Engine::setControlCallback(ControlCallback cb) { impl_->ctrl.cb = std::move(cb); }
+
+void Engine::reset() {
+    impl_->setup();
+    impl_->feat.reset();
+    impl_->frames.clear();
+    impl_->framesDone = 0;
+    impl_->last = Features();
+}
+
+void Engine::process(float* interleaved, size_t frames) {
+    if (!interleaved || frames == 0) return;
+    impl_->process(interleaved, frames);
+}
+
+void Engine::process(int16_t* interleaved, size_t frames) {
+    if (!interleaved || frames == 0) return;
+    const size_t n = frames * size_t(impl_->config.channels);
+    impl_->scratch.resize(n);
+    PcmCodec::decode16(interleaved, impl_->scratch.data(), n);
+    impl_->process(impl_->scratch.data(), frames);
+    PcmCodec::encode16(impl_->scratch.data(), interleaved, n);
+}
+
+uint64_t Engine::framesProcessed() const { return impl_->framesDone; }
+Features Engine::lastFeatures() const { return impl_->last; }
+
+bool renderFile(const std::string& in, const std::string& out, const Params& params, std::string* error) {
+    RenderParams p;
+    p.rate = params.rateHz;
+    p.depth = params.depth;
+    p.wet = params.wet;
+    p.stereophase = params.stereoPhaseDeg;
+    p.shape = toShape(params.shape);
+    p.accuracy = toAccuracy(params.accuracy);
+    p.phaseMode = toPhaseMode(params.phase);
+    const RenderResult res = Pipeline::renderFile(in, out, p);
+    if (!res.ok && error) *error = res.error;
+    return res.ok;
+}
+
+} // namespace SmartTremolo
@@ -1,45 +1,309 @@
-#pragma once
-#include <vector>
-#include <cmath>
-#include <cstdint>
-
-// Lightweight frame accumulator for RMS and Zero-Crossing Rate
-// - pushSample(L, R) appends one stereo sample
-// - when size==FrameSize (1024), ready() becomes true; read rms(), zcr() and call reset()
-// Implementation note: combines L/R to mid (average) for feature computation.
-struct FeatureExtractor {
-    static constexpr size_t FrameSize = 1024;
-
-    FeatureExtractor() { buf.reserve(FrameSize); }
-
-    void pushSample(float L, float R) {
-        float m = 0.5f * (L + R);
-        buf.push_back(m);
-        if (buf.size() > FrameSize) buf.erase(buf.begin()); // keep last N
-    }
-
-    bool ready() const { return buf.size() == FrameSize; }
-
-    void reset() { buf.clear(); }
-
-    float rms() const {
-        if (buf.empty()) return 0.f;
-        double acc = 0.0;
-        for (float x : buf) acc += double(x) * double(x);
-        return float(std::sqrt(acc / double(buf.size())));
-    }
-
-    // Zero-Crossing Rate: crossings per sample (0..1)
-    float zcr() const {
-        if (buf.size() < 2) return 0.f;
-        size_t crossings = 0;
-        for (size_t i = 1; i < buf.size(); ++i) {
-            float a = buf[i - 1], b = buf[i];
-            crossings += ((a >= 0.f && b < 0.f) || (a < 0.f && b >= 0.f)) ? 1 : 0;
-        }
-        return float(crossings) / float(buf.size() - 1);
-    }
-
-private:
-    std::vector<float> buf;
-};
+#pragma once
+#include <vector>
+#include <cctype>
+#include <cmath>
+#include <string>
+#include <cstdint>
+#include <algorithm>
+#include "Fft.h"
+
+// Lightweight frame accumulator for RMS and Zero-Crossing Rate
+// - pushSample(L, R) appends one stereo sample to a fixed ring of the last
+//   frameSize (default 1024) mid samples
+// - pushBlock(interleaved, frames, channels) does the same for a whole block
+//   in one pass and calls onFrame(offset) at every frame boundary inside it
+// - ready() becomes true once the window is full and `hop` samples arrived
+//   since the last consume(); read rms(), zcr() and call consume() to wait
+//   for the next hop (overlapping frames) or reset() to start over
+// - a running sum of squares and crossing count make pushes and queries O(1)
+// - peak, crest, onset and spectral centroid are opt-in (setFeatures): when
+//   a frame is ready, analyze() makes one pass over the window for all the
+//   enabled ones (plus a real FFT for the centroid); with none enabled it
+//   returns at once
+// Implementation note: combines L/R to mid (average) for feature computation.
+struct FeatureExtractor {
+    static constexpr size_t FrameSize = 1024;
+
+    // Opt-in features (bit mask); RMS and ZCR are always on
+    static constexpr unsigned Peak = 1u << 0;     // max |mid| over the window
+    static constexpr unsigned Crest = 1u << 1;    // peak / rms: 1 for a square wave, ~1.41 for a sine
+    static constexpr unsigned Onset = 1u << 2;    // rise of the mean square since the last frame, dB (>= 0)
+    static constexpr unsigned Centroid = 1u << 3; // spectral centroid, cycles/sample (x sample rate = Hz)
+    static constexpr unsigned AllFeatures = Peak | Crest | Onset | Centroid;
+
+    explicit FeatureExtractor(size_t frameSize = FrameSize, size_t hop = FrameSize)
+        : size(std::max<size_t>(frameSize, 2)),
+          hopSize(std::max<size_t>(1, std::min(hop, std::max<size_t>(frameSize, 2)))),
+          buf(size, 0.f), cross(size, 0) {}
+
+    void pushSample(float L, float R) {
+        float m = 0.5f * (L + R);
+        if (count == size) {
+            // evict oldest
+            sumSq -= double(buf[head]) * double(buf[head]);
+            flagSum -= cross[head];
+        }
+        const uint8_t c = (count > 0 && isCrossing(last, m)) ? 1 : 0;
+        if (count < size) ++count;
+        buf[head] = m;
+        cross[head] = c;
+        flagSum += c;
+        sumSq += double(m) * double(m);
+        last = m;
+        head = (head + 1 == size) ? 0 : head + 1;
+        ++sinceHop;
+    }
+
+    // Pushes `frames` interleaved frames (mid of channels 0 and 1; mono uses
+    // channel 0). Whenever a frame becomes ready, calls onFrame(offset) with
+    // offset = frames of this block consumed so far (rms()/zcr() describe the
+    // window ending at sample offset-1), then consume()s it.
+    template <class OnFrame>
+    void pushBlock(const float* interleaved, size_t frames, int channels, OnFrame&& onFrame) {
+        if (!interleaved || channels < 1) return;
+        const size_t stride = size_t(channels);
+        size_t i = 0;
+        while (i < frames) {
+            if (ready()) { analyze(); onFrame(i); consume(); }
+            // samples until the next boundary, split at the ring end
+            const size_t untilReady = std::max(size - count, hopSize > sinceHop ? hopSize - sinceHop : 0);
+            const size_t n = std::min({ untilReady, frames - i, size - head });
+            pushSpan(interleaved + i * stride, n, channels);
+            i += n;
+        }
+        if (ready()) { analyze(); onFrame(frames); consume(); }
+    }
+
+    // New window length and hop, then reset(); the ring reuses its storage
+    void configure(size_t frameSize, size_t hop) {
+        size = std::max<size_t>(frameSize, 2);
+        hopSize = std::max<size_t>(1, std::min(hop, size));
+        buf.resize(size);
+        cross.resize(size);
+        setFeatures(features_);
+        reset();
+    }
+
+    // Enables the opt-in features of `mask`. Sizes the spectrum buffers when
+    // Centroid is on (call it outside the audio loop); the FFT covers the
+    // newest power-of-two samples of the window.
+    void setFeatures(unsigned mask) {
+        features_ = mask & AllFeatures;
+        if (features_ & Centroid) {
+            size_t n = 4;
+            while (n * 2 <= size) n *= 2;
+            if (fft_.size() != n) {
+                fft_.resize(n);
+                hann_.resize(n);
+                for (size_t j = 0; j < n; ++j)
+                    hann_[j] = float(0.5 - 0.5 * std::cos(6.283185307179586 * double(j) / double(n)));
+                spectrum_.resize(n);
+                mag_.resize(n / 2 + 1);
+            }
+        }
+    }
+    unsigned features() const { return features_; }
+
+    // Computes the enabled opt-in features of the current window (pushBlock
+    // calls it before onFrame; pushSample users call it once ready())
+    void analyze() {
+        if (!features_) return;
+        if (features_ & Centroid) {
+            scanSpectrum();
+        } else if (features_ & (Peak | Crest)) {
+            peak_ = maxAbs(buf.data(), count); // order doesn't matter: slots [0, count) are the window
+        }
+        if (features_ & Crest) {
+            const float r = rms();
+            crest_ = r > 0.f ? peak_ / r : 0.f;
+        }
+        if (features_ & Onset) {
+            const double e = count ? std::max(0.0, sumSq) / double(count) : 0.0;
+            onset_ = hasPrev_ ? float(std::max(0.0, 10.0 * std::log10((e + 1e-10) / (prevEnergy_ + 1e-10)))) : 0.f;
+            prevEnergy_ = e;
+            hasPrev_ = true;
+        }
+    }
+
+    // Opt-in features of the last analyze()d frame (0 while off)
+    float peak() const { return peak_; }
+    float crest() const { return crest_; }
+    float onset() const { return onset_; }
+    float centroid() const { return centroid_; }
+
+    // "peak,crest,onset,centroid" (any subset, or "all"); false on an unknown name
+    static bool parseFeatures(const std::string& s, unsigned& mask) {
+        mask = 0;
+        size_t pos = 0;
+        while (pos <= s.size()) {
+            size_t comma = s.find(',', pos);
+            if (comma == std::string::npos) comma = s.size();
+            std::string name = s.substr(pos, comma - pos);
+            for (auto& c : name) c = char(std::tolower(static_cast<unsigned char>(c)));
+            if (name == "peak") mask |= Peak;
+            else if (name == "crest") mask |= Crest;
+            else if (name == "onset") mask |= Onset;
+            else if (name == "centroid") mask |= Centroid;
+            else if (name == "all") mask |= AllFeatures;
+            else return false;
+            pos = comma + 1;
+        }
+        return true;
+    }
+
+    bool ready() const { return count == size && sinceHop >= hopSize; }
+
+    // Marks the current frame as read; the window keeps sliding
+    void consume() { sinceHop = 0; }
+
+    void reset() {
+        std::fill(buf.begin(), buf.end(), 0.f);
+        std::fill(cross.begin(), cross.end(), uint8_t(0));
+        head = count = sinceHop = flagSum = 0;
+        sumSq = 0.0;
+        last = 0.f;
+        peak_ = crest_ = onset_ = centroid_ = 0.f;
+        prevEnergy_ = 0.0;
+        hasPrev_ = false;
+    }
+
+    size_t frameSize() const { return size; }
+    size_t hop() const { return hopSize; }
+
+    float rms() const {
+        if (count == 0) return 0.f;
+        // running sum can dip a hair below zero from cancellation
+        return float(std::sqrt(std::max(0.0, sumSq) / double(count)));
+    }
+
+    // Zero-Crossing Rate: crossings per sample (0..1)
+    float zcr() const {
+        if (count < 2) return 0.f;
+        // the oldest sample's flag refers to a pair that left the window
+        const size_t oldest = (count == size) ? head : 0;
+        return float(flagSum - cross[oldest]) / float(count - 1);
+    }
+
+private:
+    static bool isCrossing(float a, float b) {
+        return (a < 0.f) != (b < 0.f);
+    }
+
+    // 4 independent accumulators so the loop pipelines / vectorizes
+    static double sumSquares(const float* x, size_t n) {
+        double a0 = 0.0, a1 = 0.0, a2 = 0.0, a3 = 0.0;
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            a0 += double(x[i]) * double(x[i]);
+            a1 += double(x[i + 1]) * double(x[i + 1]);
+            a2 += double(x[i + 2]) * double(x[i + 2]);
+            a3 += double(x[i + 3]) * double(x[i + 3]);
+        }
+        for (; i < n; ++i) a0 += double(x[i]) * double(x[i]);
+        return (a0 + a1) + (a2 + a3);
+    }
+
+    static float maxAbs(const float* x, size_t n) {
+        float m0 = 0.f, m1 = 0.f, m2 = 0.f, m3 = 0.f;
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            m0 = std::max(m0, std::fabs(x[i]));
+            m1 = std::max(m1, std::fabs(x[i + 1]));
+            m2 = std::max(m2, std::fabs(x[i + 2]));
+            m3 = std::max(m3, std::fabs(x[i + 3]));
+        }
+        for (; i < n; ++i) m0 = std::max(m0, std::fabs(x[i]));
+        return std::max(std::max(m0, m1), std::max(m2, m3));
+    }
+
+    // One pass over the window, oldest sample first: the peak, and the newest
+    // fft_.size() samples Hann-windowed into spectrum_; then the centroid
+    void scanSpectrum() {
+        const size_t n = fft_.size();
+        const size_t first = count == size ? head : 0; // oldest slot
+        // sample t (oldest = 0) lands in spectrum_[t - skip + pad]
+        const size_t skip = count > n ? count - n : 0;
+        const size_t pad = count < n ? n - count : 0;
+        std::fill(spectrum_.begin(), spectrum_.begin() + pad, 0.f);
+        float pk = 0.f;
+        size_t t = 0;
+        for (size_t span = 0; span < 2; ++span) {
+            const size_t b = span == 0 ? first : 0;
+            const size_t e = span == 0 ? std::min(size, first + count) : first;
+            for (size_t j = b; j < e; ++j, ++t) {
+                const float v = buf[j];
+                pk = std::max(pk, std::fabs(v));
+                if (t >= skip) {
+                    const size_t k = t - skip + pad;
+                    spectrum_[k] = v * hann_[k];
+                }
+            }
+        }
+        peak_ = pk;
+
+        fft_.forward(spectrum_.data());
+        RealFft::magnitudes(spectrum_.data(), n, mag_.data());
+        double num = 0.0, den = 0.0;
+        for (size_t k = 1; k <= n / 2; ++k) {
+            num += double(k) * double(mag_[k]);
+            den += double(mag_[k]);
+        }
+        centroid_ = den > 1e-12 ? float(num / den / double(n)) : 0.f;
+    }
+
+    // n samples into the contiguous ring slots [head, head + n)
+    void pushSpan(const float* x, size_t n, int channels) {
+        if (n == 0) return;
+        float* dst = buf.data() + head;
+        uint8_t* flags = cross.data() + head;
+
+        if (count == size) {
+            // evict the slots about to be overwritten
+            sumSq -= sumSquares(dst, n);
+            size_t f = 0;
+            for (size_t j = 0; j < n; ++j) f += flags[j];
+            flagSum -= f;
+        }
+
+        // mid downmix straight into the ring
+        if (channels == 1) {
+            for (size_t j = 0; j < n; ++j) dst[j] = 0.5f * (x[j] + x[j]);
+        } else {
+            const size_t stride = size_t(channels);
+            for (size_t j = 0; j < n; ++j) dst[j] = 0.5f * (x[j * stride] + x[j * stride + 1]);
+        }
+
+        flags[0] = (count > 0 && isCrossing(last, dst[0])) ? 1 : 0;
+        size_t f = flags[0];
+        for (size_t j = 1; j < n; ++j) {
+            flags[j] = isCrossing(dst[j - 1], dst[j]) ? 1 : 0;
+            f += flags[j];
+        }
+        flagSum += f;
+        sumSq += sumSquares(dst, n);
+
+        last = dst[n - 1];
+        count = std::min(size, count + n);
+        head = (head + n == size) ? 0 : head + n;
+        sinceHop += n;
+    }
+
+    size_t size;
+    size_t hopSize;
+    std::vector<float> buf;     // ring of mid samples
+    std::vector<uint8_t> cross; // 1 if sample crossed zero vs its predecessor
+    size_t head = 0;            // next write slot (== oldest when full)
+    size_t count = 0;
+    size_t sinceHop = 0;
+    size_t flagSum = 0;         // sum of cross[] over the window
+    double sumSq = 0.0;
+    float last = 0.f;
+
+    // opt-in features
+    unsigned features_ = 0;
+    float peak_ = 0.f, crest_ = 0.f, onset_ = 0.f, centroid_ = 0.f;
+    double prevEnergy_ = 0.0; // mean square of the last analyzed frame (Onset)
+    bool hasPrev_ = false;
+    RealFft fft_;
+    std::vector<float> hann_, spectrum_, mag_;
+};
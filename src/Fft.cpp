@@ -0,0 +1,88 @@
+#include "Fft.h"
+#include <cmath>
+#include <utility>
+
+bool RealFft::resize(size_t n) {
+    if (n < 4 || (n & (n - 1))) return false;
+    n_ = n;
+    const size_t m = n / 2; // complex points
+
+    unsigned bits = 0;
+    while ((size_t(1) << bits) < m) ++bits;
+    rev_.resize(m);
+    for (size_t i = 0; i < m; ++i) {
+        uint32_t r = 0;
+        for (unsigned b = 0; b < bits; ++b) r |= uint32_t((i >> b) & 1u) << (bits - 1 - b);
+        rev_[i] = r;
+    }
+
+    const double pi = 3.14159265358979323846;
+    tw_.resize(m); // m/2 pairs
+    for (size_t j = 0; j < m / 2; ++j) {
+        tw_[2 * j] = float(std::cos(2.0 * pi * double(j) / double(m)));
+        tw_[2 * j + 1] = float(-std::sin(2.0 * pi * double(j) / double(m)));
+    }
+    split_.resize(2 * (n / 4 + 1));
+    for (size_t k = 0; k <= n / 4; ++k) {
+        split_[2 * k] = float(std::cos(2.0 * pi * double(k) / double(n)));
+        split_[2 * k + 1] = float(-std::sin(2.0 * pi * double(k) / double(n)));
+    }
+    return true;
+}
+
+void RealFft::forward(float* x) const {
+    const size_t m = n_ / 2;
+    if (m == 0) return;
+
+    // x as m complex values z[i] = x[2i] + i x[2i+1], bit-reversed
+    for (size_t i = 0; i < m; ++i) {
+        const size_t r = rev_[i];
+        if (r > i) {
+            std::swap(x[2 * i], x[2 * r]);
+            std::swap(x[2 * i + 1], x[2 * r + 1]);
+        }
+    }
+    // iterative radix-2 butterflies
+    for (size_t len = 2; len <= m; len <<= 1) {
+        const size_t half = len / 2, step = m / len;
+        for (size_t i = 0; i < m; i += len) {
+            for (size_t j = 0; j < half; ++j) {
+                const float wr = tw_[2 * j * step], wi = tw_[2 * j * step + 1];
+                float* u = x + 2 * (i + j);
+                float* v = x + 2 * (i + j + half);
+                const float vr = v[0] * wr - v[1] * wi;
+                const float vi = v[0] * wi + v[1] * wr;
+                v[0] = u[0] - vr;
+                v[1] = u[1] - vi;
+                u[0] += vr;
+                u[1] += vi;
+            }
+        }
+    }
+
+    // split: with E = (Z[k] + conj Z[m-k]) / 2, O = -i (Z[k] - conj Z[m-k]) / 2
+    // and W = e^(-2 pi i k / n), X[k] = E + W O and X[m-k] = conj(E - W O)
+    const float z0r = x[0], z0i = x[1];
+    x[0] = z0r + z0i;
+    x[1] = z0r - z0i;
+    for (size_t k = 1; k <= m / 2; ++k) {
+        float* a = x + 2 * k;
+        float* c = x + 2 * (m - k);
+        const float er = 0.5f * (a[0] + c[0]), ei = 0.5f * (a[1] - c[1]);
+        const float orr = 0.5f * (a[1] + c[1]), oi = -0.5f * (a[0] - c[0]);
+        const float wr = split_[2 * k], wi = split_[2 * k + 1];
+        const float tr = wr * orr - wi * oi, ti = wr * oi + wi * orr;
+        a[0] = er + tr;
+        a[1] = ei + ti;
+        c[0] = er - tr;
+        c[1] = ti - ei;
+    }
+}
+
+void RealFft::magnitudes(const float* packed, size_t n, float* out) {
+    if (n < 4) return;
+    out[0] = std::fabs(packed[0]);
+    out[n / 2] = std::fabs(packed[1]);
+    for (size_t k = 1; k < n / 2; ++k)
+        out[k] = std::sqrt(packed[2 * k] * packed[2 * k] + packed[2 * k + 1] * packed[2 * k + 1]);
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// In-place radix-2 FFT of n real samples (n a power of two, >= 4): the
+// samples are read as n/2 complex values, transformed with an iterative
+// n/2-point FFT and split into the n/2 + 1 bins of the real spectrum.
+// Bit-reversal and twiddles are precomputed by resize(), so forward()
+// neither allocates nor calls sin/cos.
+struct RealFft {
+    explicit RealFft(size_t n = 0) { resize(n); }
+
+    // Returns false (and keeps the old size) unless n is a power of two >= 4
+    bool resize(size_t n);
+    size_t size() const { return n_; }
+
+    // x[0..n) real samples in; the packed spectrum out, X[k] = sum x[t] e^(-2 pi i k t / n):
+    // x[0] = X[0], x[1] = X[n/2] (both real), x[2k] + i x[2k+1] = X[k] for 0 < k < n/2
+    void forward(float* x) const;
+
+    // |X[k]| for k = 0..n/2 (n/2 + 1 values) of a forward()ed buffer
+    static void magnitudes(const float* packed, size_t n, float* out);
+
+private:
+    size_t n_ = 0;
+    std::vector<uint32_t> rev_; // bit-reversed index, n/2 entries
+    std::vector<float> tw_;     // e^(-2 pi i j / (n/2)), j < n/4: (cos, sin) pairs
+    std::vector<float> split_;  // e^(-2 pi i k / n),     k <= n/4: (cos, sin) pairs
+};
@@ -0,0 +1,136 @@
+#include "GainApply.h"
+#include <algorithm>
+
+#if defined(__AVX__)
+#define GAIN_AVX 1
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GAIN_SSE 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define GAIN_NEON 1
+#include <arm_neon.h>
+#endif
+
+static inline float clamp11(float x){ return std::max(-1.f, std::min(1.f, x)); }
+
+// Vector paths keep the scalar operation order so results match the reference.
+void GainApply::mono(float* x, const float* g, size_t n, float wet) {
+    const float tiny = 1e-20f;
+    const float dry = 1.0f - wet;
+    size_t i = 0;
+#if defined(GAIN_AVX)
+    const __m256 vt = _mm256_set1_ps(tiny), vd = _mm256_set1_ps(dry), vw = _mm256_set1_ps(wet);
+    const __m256 lo = _mm256_set1_ps(-1.0f), hi = _mm256_set1_ps(1.0f);
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_add_ps(_mm256_loadu_ps(x + i), vt);
+        __m256 y = _mm256_add_ps(_mm256_mul_ps(vd, v), _mm256_mul_ps(vw, _mm256_mul_ps(v, _mm256_load_ps(g + i))));
+        _mm256_storeu_ps(x + i, _mm256_max_ps(lo, _mm256_min_ps(hi, y)));
+    }
+#elif defined(GAIN_SSE)
+    const __m128 vt = _mm_set1_ps(tiny), vd = _mm_set1_ps(dry), vw = _mm_set1_ps(wet);
+    const __m128 lo = _mm_set1_ps(-1.0f), hi = _mm_set1_ps(1.0f);
+    for (; i + 4 <= n; i += 4) {
+        __m128 v = _mm_add_ps(_mm_loadu_ps(x + i), vt);
+        __m128 y = _mm_add_ps(_mm_mul_ps(vd, v), _mm_mul_ps(vw, _mm_mul_ps(v, _mm_load_ps(g + i))));
+        _mm_storeu_ps(x + i, _mm_max_ps(lo, _mm_min_ps(hi, y)));
+    }
+#elif defined(GAIN_NEON)
+    const float32x4_t vt = vdupq_n_f32(tiny), vd = vdupq_n_f32(dry), vw = vdupq_n_f32(wet);
+    const float32x4_t lo = vdupq_n_f32(-1.0f), hi = vdupq_n_f32(1.0f);
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t v = vaddq_f32(vld1q_f32(x + i), vt);
+        float32x4_t y = vaddq_f32(vmulq_f32(vd, v), vmulq_f32(vw, vmulq_f32(v, vld1q_f32(g + i))));
+        vst1q_f32(x + i, vmaxq_f32(lo, vminq_f32(hi, y)));
+    }
+#endif
+    for (; i < n; ++i) {
+        float v = x[i] + tiny;
+        float wetSig = v * g[i];
+        x[i] = clamp11(dry * v + wet * wetSig);
+    }
+}
+
+void GainApply::stereo(float* x, const float* gL, const float* gR, size_t n, float wet) {
+    const float tiny = 1e-20f;
+    const float dry = 1.0f - wet;
+    size_t i = 0;
+#if defined(GAIN_AVX)
+    const __m256 vt = _mm256_set1_ps(tiny), vd = _mm256_set1_ps(dry), vw = _mm256_set1_ps(wet);
+    const __m256 lo = _mm256_set1_ps(-1.0f), hi = _mm256_set1_ps(1.0f);
+    for (; i + 8 <= n; i += 8) {
+        __m256 l = _mm256_load_ps(gL + i), r = _mm256_load_ps(gR + i);
+        // interleave L/R gains: {0..3} and {4..7} frames
+        __m256 ulo = _mm256_unpacklo_ps(l, r), uhi = _mm256_unpackhi_ps(l, r);
+        __m256 g0 = _mm256_permute2f128_ps(ulo, uhi, 0x20);
+        __m256 g1 = _mm256_permute2f128_ps(ulo, uhi, 0x31);
+        float* p = x + i * 2;
+        __m256 v0 = _mm256_add_ps(_mm256_loadu_ps(p), vt);
+        __m256 v1 = _mm256_add_ps(_mm256_loadu_ps(p + 8), vt);
+        __m256 y0 = _mm256_add_ps(_mm256_mul_ps(vd, v0), _mm256_mul_ps(vw, _mm256_mul_ps(v0, g0)));
+        __m256 y1 = _mm256_add_ps(_mm256_mul_ps(vd, v1), _mm256_mul_ps(vw, _mm256_mul_ps(v1, g1)));
+        _mm256_storeu_ps(p,     _mm256_max_ps(lo, _mm256_min_ps(hi, y0)));
+        _mm256_storeu_ps(p + 8, _mm256_max_ps(lo, _mm256_min_ps(hi, y1)));
+    }
+#elif defined(GAIN_SSE)
+    const __m128 vt = _mm_set1_ps(tiny), vd = _mm_set1_ps(dry), vw = _mm_set1_ps(wet);
+    const __m128 lo = _mm_set1_ps(-1.0f), hi = _mm_set1_ps(1.0f);
+    for (; i + 4 <= n; i += 4) {
+        __m128 l = _mm_load_ps(gL + i), r = _mm_load_ps(gR + i);
+        __m128 g0 = _mm_unpacklo_ps(l, r), g1 = _mm_unpackhi_ps(l, r);
+        float* p = x + i * 2;
+        __m128 v0 = _mm_add_ps(_mm_loadu_ps(p), vt);
+        __m128 v1 = _mm_add_ps(_mm_loadu_ps(p + 4), vt);
+        __m128 y0 = _mm_add_ps(_mm_mul_ps(vd, v0), _mm_mul_ps(vw, _mm_mul_ps(v0, g0)));
+        __m128 y1 = _mm_add_ps(_mm_mul_ps(vd, v1), _mm_mul_ps(vw, _mm_mul_ps(v1, g1)));
+        _mm_storeu_ps(p,     _mm_max_ps(lo, _mm_min_ps(hi, y0)));
+        _mm_storeu_ps(p + 4, _mm_max_ps(lo, _mm_min_ps(hi, y1)));
+    }
+#elif defined(GAIN_NEON)
+    const float32x4_t vt = vdupq_n_f32(tiny), vd = vdupq_n_f32(dry), vw = vdupq_n_f32(wet);
+    const float32x4_t lo = vdupq_n_f32(-1.0f), hi = vdupq_n_f32(1.0f);
+    for (; i + 4 <= n; i += 4) {
+        float32x4x2_t g = vzipq_f32(vld1q_f32(gL + i), vld1q_f32(gR + i));
+        float* p = x + i * 2;
+        float32x4_t v0 = vaddq_f32(vld1q_f32(p), vt);
+        float32x4_t v1 = vaddq_f32(vld1q_f32(p + 4), vt);
+        float32x4_t y0 = vaddq_f32(vmulq_f32(vd, v0), vmulq_f32(vw, vmulq_f32(v0, g.val[0])));
+        float32x4_t y1 = vaddq_f32(vmulq_f32(vd, v1), vmulq_f32(vw, vmulq_f32(v1, g.val[1])));
+        vst1q_f32(p,     vmaxq_f32(lo, vminq_f32(hi, y0)));
+        vst1q_f32(p + 4, vmaxq_f32(lo, vminq_f32(hi, y1)));
+    }
+#endif
+    for (; i < n; ++i) {
+        float* L = &x[i * 2 + 0];
+        float* R = &x[i * 2 + 1];
+        float xL = *L + tiny;
+        float xR = *R + tiny;
+        *L = clamp11(dry * xL + wet * (xL * gL[i]));
+        *R = clamp11(dry * xR + wet * (xR * gR[i]));
+    }
+}
+
+void GainApply::interleaved(float* x, const float* gL, const float* gR, size_t n, int channels, float wet) {
+    const float tiny = 1e-20f;
+    const float dry = 1.0f - wet;
+    for (size_t i = 0; i < n; ++i) {
+        float* f = x + i * size_t(channels);
+        for (int c = 0; c < channels; ++c) {
+            float v = f[c] + tiny;
+            float g = (c & 1) ? gR[i] : gL[i];
+            f[c] = clamp11(dry * v + wet * (v * g));
+        }
+    }
+}
+
+void GainApply::perChannel(float* x, const float* const* g, size_t n, int channels, float wet) {
+    const float tiny = 1e-20f;
+    const float dry = 1.0f - wet;
+    for (size_t i = 0; i < n; ++i) {
+        float* f = x + i * size_t(channels);
+        for (int c = 0; c < channels; ++c) {
+            float v = f[c] + tiny;
+            f[c] = clamp11(dry * v + wet * (v * g[c][i]));
+        }
+    }
+}
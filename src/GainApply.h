@@ -0,0 +1,17 @@
+#pragma once
+#include <cstddef>
+
+// Gain / dry-wet mix / clamp stage shared by Tremolo and TremoloBank:
+// y = clamp11((1 - wet) * x + wet * (x * g)), x = in + tiny
+// Gain arrays of mono/stereo must be 32-byte aligned; audio may be unaligned.
+namespace GainApply {
+    constexpr int MaxChannels = 64;
+
+    void mono(float* x, const float* g, size_t n, float wet);
+    // Interleaved stereo: L takes gL, R takes gR
+    void stereo(float* x, const float* gL, const float* gR, size_t n, float wet);
+    // N interleaved channels: even channels take gL, odd channels gR
+    void interleaved(float* x, const float* gL, const float* gR, size_t n, int channels, float wet);
+    // N interleaved channels, channel c taking g[c] (may repeat)
+    void perChannel(float* x, const float* const* g, size_t n, int channels, float wet);
+}
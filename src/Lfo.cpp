@@ -0,0 +1,173 @@
+#include "Lfo.h"
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+constexpr int TableBits = 11;
+constexpr int TableSize = 1 << TableBits;
+constexpr int TableMask = TableSize - 1;
+
+// One period of each waveform with a guard point for interpolation
+struct Tables {
+    float sine[TableSize + 1];
+    float squareSoft[TableSize + 1];
+
+    Tables() {
+        const double twoPi = 6.283185307179586476925;
+        for (int i = 0; i <= TableSize; ++i) {
+            double s = std::sin(twoPi * double(i) / double(TableSize));
+            sine[i] = float(0.5 * (1.0 + s));
+            squareSoft[i] = float(0.5 * (std::tanh(3.0 * s) + 1.0));
+        }
+    }
+};
+
+// Built during static initialization; only read once processing starts
+const Tables gTables;
+
+inline float lookup(const float* table, float ph) {
+    float x = ph * float(TableSize);
+    int i = int(x);
+    float frac = x - float(i);
+    i &= TableMask;
+    return table[i] + frac * (table[i + 1] - table[i]);
+}
+
+// sin(2*pi*ph): reduce to r in [0, 0.25] by symmetry, then odd Taylor series
+inline float sinCycle(float ph) {
+    float t = ph - float(int(ph));        // [0,1)
+    float x = t - 0.5f;                   // sin(2pi t) = -sin(2pi x)
+    float a = std::fabs(x);
+    float r = 0.25f - std::fabs(0.25f - a);
+    float r2 = r * r;
+    float p = r * (6.2831853f + r2 * (-41.341702f + r2 * (81.605249f
+                 + r2 * (-76.705860f + r2 * 42.058694f))));
+    return x < 0.0f ? p : -p;
+}
+
+// Lambert continued fraction, |err| < 1e-6 on [-3, 3]
+inline float tanhRational(float x) {
+    float x2 = x * x;
+    float num = x * (135135.0f + x2 * (17325.0f + x2 * (378.0f + x2)));
+    float den = 135135.0f + x2 * (62370.0f + x2 * (3150.0f + x2 * 28.0f));
+    return num / den;
+}
+
+// Residual of a unit step at t = 0 sampled at t (two-sample polyBLEP:
+// the step is spread over one increment either side)
+inline float blep(float t, float dt) {
+    if (t < dt) { float x = t / dt; return -0.5f * (1.0f - x) * (1.0f - x); }
+    if (t > 1.0f - dt) { float x = (1.0f - t) / dt; return 0.5f * (1.0f - x) * (1.0f - x); }
+    return 0.0f;
+}
+
+// Integrated blep, per unit slope change per sample: (1 - |tau|)^3 / 6
+inline float blamp(float t, float dt) {
+    float x;
+    if (t < dt) x = 1.0f - t / dt;
+    else if (t > 1.0f - dt) x = 1.0f - (1.0f - t) / dt;
+    else return 0.0f;
+    return x * x * x * (1.0f / 6.0f);
+}
+
+// Phase distance the corrections may span: below half a cycle, so the two
+// edges (corners) of a period never overlap
+inline float blDt(float dt) { return std::min(std::max(dt, 0.0f), 0.25f); }
+
+// One branch-free loop per waveform; picked once per call via Lfo::kernel()
+template <float (*F)(float)>
+void mapPhases(const float* phase, const float*, float* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = F(phase[i]);
+}
+
+template <float (*F)(float, float)>
+void mapBandLimited(const float* phase, const float* dt, float* out, size_t n) {
+    if (!dt) {
+        for (size_t i = 0; i < n; ++i) out[i] = F(phase[i], 0.0f);
+        return;
+    }
+    for (size_t i = 0; i < n; ++i) out[i] = F(phase[i], dt[i]);
+}
+
+} // namespace
+
+float Lfo::sineTable(float ph)       { return lookup(gTables.sine, ph); }
+float Lfo::squareSoftTable(float ph) { return lookup(gTables.squareSoft, ph); }
+float Lfo::sinePoly(float ph)        { return 0.5f * (1.0f + sinCycle(ph)); }
+float Lfo::squareSoftPoly(float ph)  { return 0.5f * (tanhRational(3.0f * sinCycle(ph)) + 1.0f); }
+float Lfo::squareFast(float ph)      { return (ph - float(int(ph))) < 0.5f ? 1.0f : 0.0f; }
+
+// Same as triangle() for ph >= 0, without the fmod call
+float Lfo::triangleFast(float ph) {
+    float t = ph - float(int(ph));
+    float tri = (t < 0.5f) ? (t * 4.0f - 1.0f) : (3.0f - t * 4.0f);
+    return 0.5f * (tri + 1.0f);
+}
+
+// Square high on [0, 0.5) as squareFast(); the rising edge at 0 and the
+// falling edge at 0.5 are polyBLEP-corrected (0.5 on the edge itself)
+float Lfo::squareBlep(float ph, float dt) {
+    const float t = ph - float(int(ph));
+    const float d = blDt(dt);
+    float y = t < 0.5f ? 1.0f : 0.0f;
+    if (d > 0.0f) {
+        float t2 = t + 0.5f;
+        if (t2 >= 1.0f) t2 -= 1.0f;
+        y += blep(t, d) - blep(t2, d);
+    }
+    return y;
+}
+
+// triangleFast() with polyBLAMP-rounded corners: the slope changes by +4 at
+// phase 0 and -4 at 0.5 (cycles), i.e. 4 * dt per sample
+float Lfo::triangleBlamp(float ph, float dt) {
+    const float t = ph - float(int(ph));
+    const float d = blDt(dt);
+    float y = 0.5f * (((t < 0.5f) ? (t * 4.0f - 1.0f) : (3.0f - t * 4.0f)) + 1.0f);
+    if (d > 0.0f) {
+        float t2 = t + 0.5f;
+        if (t2 >= 1.0f) t2 -= 1.0f;
+        y += 4.0f * d * (blamp(t, d) - blamp(t2, d));
+    }
+    return y;
+}
+
+Lfo::Kernel Lfo::kernel(LFOShape shape, LFOAccuracy acc) {
+    // indexed by LFOShape: Sine, Triangle, Square, SquareSoft, SquareBL, TriangleBL
+    static const Kernel exact[ShapeCount] = {
+        mapPhases<sine>, mapPhases<triangle>, mapPhases<square>, mapPhases<squareSoft>,
+        mapBandLimited<squareBlep>, mapBandLimited<triangleBlamp> };
+    static const Kernel table[ShapeCount] = {
+        mapPhases<sineTable>, mapPhases<triangleFast>, mapPhases<squareFast>, mapPhases<squareSoftTable>,
+        mapBandLimited<squareBlep>, mapBandLimited<triangleBlamp> };
+    static const Kernel poly[ShapeCount] = {
+        mapPhases<sinePoly>, mapPhases<triangleFast>, mapPhases<squareFast>, mapPhases<squareSoftPoly>,
+        mapBandLimited<squareBlep>, mapBandLimited<triangleBlamp> };
+    const int i = int(shape);
+    switch (acc) {
+        case LFOAccuracy::Table: return table[i];
+        case LFOAccuracy::Poly:  return poly[i];
+        default:                 return exact[i];
+    }
+}
+
+void Lfo::eval(LFOShape shape, LFOAccuracy acc, const float* phase, float* out, size_t n,
+               const float* dt) {
+    kernel(shape, acc)(phase, dt, out, n);
+}
+
+LFOAccuracy Lfo::parseAccuracy(const std::string& s) {
+    auto lower = s; for (auto& c : lower) c = char(std::tolower(c));
+    if (lower == "table") return LFOAccuracy::Table;
+    if (lower == "poly") return LFOAccuracy::Poly;
+    return LFOAccuracy::Exact;
+}
+
+const char* Lfo::accuracyName(LFOAccuracy a) {
+    switch (a) {
+        case LFOAccuracy::Table: return "table";
+        case LFOAccuracy::Poly:  return "poly";
+        default:                 return "exact";
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <string>
+
+// SquareBL / TriangleBL are band-limited: polyBLEP-corrected edges and
+// polyBLAMP-corrected corners over one phase increment either side, so
+// they need each sample's increment (dt) and suit high rates.
+enum class LFOShape { Sine, Triangle, Square, SquareSoft, SquareBL, TriangleBL };
+
+// How the LFO waveforms are evaluated:
+//   Exact : std::sin / std::tanh per sample (reference)
+//   Table : 2048-point wavetables with linear interpolation (|err| < 5e-6)
+//   Poly  : degree-9 odd polynomial sine, [7/6] rational tanh (|err| < 5e-6)
+// Triangle has no transcendental and gives identical values in every mode;
+// in Table/Poly mode Square is a plain phase comparison (no sin), high for
+// phase in [0, 0.5), so edges can land one sample away from Exact. The
+// band-limited shapes are polynomial and the same in every mode.
+enum class LFOAccuracy { Exact, Table, Poly };
+
+namespace Lfo {
+    constexpr float TwoPi = 2.0f * 3.14159265358979323846f;
+    constexpr int ShapeCount = 6;
+
+    // Exact waveforms; return lfo in [0..1]
+    inline float sine(float ph) {
+        return 0.5f * (1.0f + std::sin(TwoPi * ph));
+    }
+    inline float triangle(float ph) {
+        float t = std::fmod(ph, 1.0f);
+        float tri = (t < 0.5f) ? (t * 4.0f - 1.0f) : (3.0f - t * 4.0f); // -1..1
+        return 0.5f * (tri + 1.0f);
+    }
+    inline float square(float ph) {
+        float s = std::sin(TwoPi * ph);
+        return s >= 0.0f ? 1.0f : 0.0f;
+    }
+    inline float squareSoft(float ph) {
+        // "soft" square via tanh(k * sin), k=3 gives rounded corners
+        float s = std::sin(TwoPi * ph);
+        float y = std::tanh(3.0f * s); // -1..1
+        return 0.5f * (y + 1.0f);
+    }
+
+    // Approximations (phase >= 0, any number of cycles)
+    float sineTable(float ph);
+    float squareSoftTable(float ph);
+    float sinePoly(float ph);
+    float squareSoftPoly(float ph);
+    float squareFast(float ph);
+    float triangleFast(float ph);
+
+    // Band-limited; dt = phase increment per sample (cycles), 0 = naive
+    float squareBlep(float ph, float dt);
+    float triangleBlamp(float ph, float dt);
+
+    // Evaluates one waveform at n phases, element i advancing by dt[i] (read
+    // only by the band-limited shapes; null = 0); out may alias phase
+    using Kernel = void (*)(const float* phase, const float* dt, float* out, size_t n);
+    Kernel kernel(LFOShape shape, LFOAccuracy acc);
+    void eval(LFOShape shape, LFOAccuracy acc, const float* phase, float* out, size_t n,
+              const float* dt = nullptr);
+
+    LFOAccuracy parseAccuracy(const std::string& s);
+    const char* accuracyName(LFOAccuracy a);
+}
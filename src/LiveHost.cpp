@@ -0,0 +1,111 @@
+#include "LiveHost.h"
+#include "AllocCounter.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <sstream>
+
+bool LiveHost::start(AudioDevice& dev, const WavData& source, const RenderParams& p, size_t periodFrames) {
+    stop();
+    if (source.channels < 1 || source.samples.size() < size_t(source.channels)) return false;
+
+    trem_ = Tremolo();
+    trem_.setSampleRate(source.sampleRate);
+    trem_.setDepth(p.depth);
+    trem_.setRateHz(p.rate);
+    trem_.setWet(p.wet);
+    trem_.setStereoPhaseDeg(p.stereophase);
+    trem_.setChannelPhaseDeg(p.channelPhaseDeg.data(), p.channelPhaseDeg.size());
+    trem_.setShape(p.shape);
+    trem_.setAccuracy(p.accuracy);
+    trem_.setPhaseMode(p.phaseMode);
+    trem_.setTempoSync(p.tempo, p.beatsPerCycle);
+    trem_.prepare(source.channels);
+
+    source_ = &source;
+    readPos_ = 0;
+    budgetNs_ = 1e9 * double(periodFrames) / double(source.sampleRate);
+    callbacks_ = overBudget_ = totalNs_ = maxNs_ = 0;
+
+    AudioConfig cfg;
+    cfg.sampleRate = source.sampleRate;
+    cfg.channels = source.channels;
+    cfg.periodFrames = periodFrames;
+    if (!dev.open(cfg, [this](float* out, size_t frames, int channels){ render(out, frames, channels); }))
+        return false;
+    dev_ = &dev;
+    return dev.start();
+}
+
+void LiveHost::stop() {
+    if (dev_) dev_->stop();
+    dev_ = nullptr;
+}
+
+// Audio thread: no locks, no allocation, no I/O
+void LiveHost::render(float* out, size_t frames, int channels) {
+    const auto t0 = std::chrono::steady_clock::now();
+    SMART_TREMOLO_NO_ALLOC_SCOPE("the live callback");
+
+    ParamChange c;
+    while (queue_.pop(c)) {
+        switch (c.id) {
+            case ParamChange::Id::Rate:        trem_.setRateHz(c.value); break;
+            case ParamChange::Id::Depth:       trem_.setDepth(c.value); break;
+            case ParamChange::Id::Wet:         trem_.setWet(c.value); break;
+            case ParamChange::Id::StereoPhase: trem_.setStereoPhaseDeg(c.value); break;
+            case ParamChange::Id::Shape:       trem_.setShape(LFOShape(int(c.value))); break;
+        }
+    }
+
+    // looped source -> out
+    const size_t srcFrames = source_->samples.size() / size_t(channels);
+    for (size_t done = 0; done < frames; ) {
+        const size_t n = std::min(frames - done, srcFrames - readPos_);
+        std::memcpy(out + done * size_t(channels),
+                    source_->samples.data() + readPos_ * size_t(channels),
+                    n * size_t(channels) * sizeof(float));
+        done += n;
+        readPos_ = (readPos_ + n == srcFrames) ? 0 : readPos_ + n;
+    }
+    trem_.process(out, frames, channels);
+
+    const uint64_t ns = uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - t0).count());
+    callbacks_.store(callbacks_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    totalNs_.store(totalNs_.load(std::memory_order_relaxed) + ns, std::memory_order_relaxed);
+    if (ns > maxNs_.load(std::memory_order_relaxed)) maxNs_.store(ns, std::memory_order_relaxed);
+    if (double(ns) > budgetNs_)
+        overBudget_.store(overBudget_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+CallbackStats LiveHost::stats() const {
+    CallbackStats s;
+    s.callbacks = callbacks_.load(std::memory_order_relaxed);
+    s.overBudget = overBudget_.load(std::memory_order_relaxed);
+    s.xruns = dev_ ? dev_->xruns() : 0;
+    s.budgetUs = budgetNs_ / 1e3;
+    s.avgUs = s.callbacks ? double(totalNs_.load(std::memory_order_relaxed)) / double(s.callbacks) / 1e3 : 0.0;
+    s.maxUs = double(maxNs_.load(std::memory_order_relaxed)) / 1e3;
+    return s;
+}
+
+bool LiveHost::parseCommand(const std::string& line, ParamChange& out) {
+    std::istringstream is(line);
+    std::string key, val;
+    if (!(is >> key >> val)) return false;
+    if (key == "shape") {
+        out.id = ParamChange::Id::Shape;
+        out.value = float(int(Tremolo::parseShape(val)));
+        return true;
+    }
+    float v = 0.0f;
+    try { v = std::stof(val); } catch (...) { return false; }
+    if (key == "rate") out.id = ParamChange::Id::Rate;
+    else if (key == "depth") out.id = ParamChange::Id::Depth;
+    else if (key == "wet") out.id = ParamChange::Id::Wet;
+    else if (key == "stereophase") out.id = ParamChange::Id::StereoPhase;
+    else return false;
+    out.value = v;
+    return true;
+}
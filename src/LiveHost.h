@@ -0,0 +1,66 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "AudioDevice.h"
+#include "Pipeline.h"
+#include "SpscQueue.h"
+#include "Tremolo.h"
+#include "WavIO.h"
+
+// One parameter change sent from a control thread to the audio thread
+struct ParamChange {
+    enum class Id : uint8_t { Rate, Depth, Wet, StereoPhase, Shape };
+    Id id = Id::Rate;
+    float value = 0.0f; // Shape: float(int(LFOShape))
+};
+
+struct CallbackStats {
+    uint64_t callbacks = 0;
+    uint64_t overBudget = 0; // callbacks that took longer than one period
+    uint64_t xruns = 0;      // as reported by the device backend
+    double budgetUs = 0.0;   // period length
+    double avgUs = 0.0;
+    double maxUs = 0.0;
+};
+
+// Real-time host: loops a source buffer through a Tremolo inside the device
+// callback. Parameter setters may be called from any single control thread;
+// changes travel through a lock-free SPSC queue and are applied at the start
+// of the next callback, so the audio thread never takes a lock.
+struct LiveHost {
+    ~LiveHost() { stop(); }
+
+    bool start(AudioDevice& dev, const WavData& source, const RenderParams& p, size_t periodFrames);
+    void stop();
+
+    // Return false if the queue is full and the change was dropped
+    bool post(const ParamChange& c) { return queue_.push(c); }
+    bool setRateHz(float hz)          { return post({ParamChange::Id::Rate, hz}); }
+    bool setDepth(float d)            { return post({ParamChange::Id::Depth, d}); }
+    bool setWet(float w)              { return post({ParamChange::Id::Wet, w}); }
+    bool setStereoPhaseDeg(float deg) { return post({ParamChange::Id::StereoPhase, deg}); }
+    bool setShape(LFOShape s)         { return post({ParamChange::Id::Shape, float(int(s))}); }
+
+    CallbackStats stats() const;
+
+    // Parses "rate 3.5", "depth 0.4", "wet 1", "stereophase 90", "shape square"
+    static bool parseCommand(const std::string& line, ParamChange& out);
+
+private:
+    void render(float* out, size_t frames, int channels);
+
+    AudioDevice* dev_ = nullptr;
+    Tremolo trem_;
+    const WavData* source_ = nullptr;
+    size_t readPos_ = 0; // frame index into source_, wraps
+    double budgetNs_ = 0.0;
+    SpscQueue<ParamChange, 256> queue_;
+
+    // written by the audio thread only
+    std::atomic<uint64_t> callbacks_{0};
+    std::atomic<uint64_t> overBudget_{0};
+    std::atomic<uint64_t> totalNs_{0};
+    std::atomic<uint64_t> maxNs_{0};
+};
@@ -0,0 +1,34 @@
+#pragma once
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+// Read-only memory mapping of a whole file (mmap / MapViewOfFile).
+// open() returns false if the file can't be opened or mapped; callers
+// are expected to fall back to regular stream I/O in that case.
+struct MappedFile {
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return data_ != nullptr; }
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+
+    // Size of a file on disk, or -1 if it can't be stat'ed
+    static int64_t fileSize(const std::string& path);
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+#if defined(_WIN32)
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
@@ -1,35 +1,109 @@
-#pragma once
-#include <cmath>
-
-// Simple one-pole exponential smoother for parameter changes.
-// y[n] = (1 - a) * x + a * y[n-1], where a = exp(-1/(tau*fs))
-// Attack/Release both share the same tau here for simplicity.
-struct OnePoleSmoother {
-    void setSampleRate(double fs) {
-        sampleRate = fs > 0 ? fs : 48000.0;
-        updateCoeff();
-    }
-    // tauSeconds ~ 0.005..0.02 typical for click-free smoothing
-    void setTimeConstant(float tauSeconds) {
-        tau = (tauSeconds > 1e-6f) ? tauSeconds : 1e-6f;
-        updateCoeff();
-    }
-    void reset(float value) { z = value; }
-
-    float process(float target) {
-        // denormal-safe tiny offset (prevents subnormal slowdowns)
-        const float tiny = 1e-20f;
-        z = a * (z + tiny) + (1.0f - a) * target;
-        return z;
-    }
-
-private:
-    void updateCoeff() {
-        a = std::exp(float(-1.0 / (tau * float(sampleRate))));
-    }
-
-    double sampleRate = 48000.0;
-    float tau = 0.01f; // 10 ms default
-    float a = 0.0f;
-    float z = 0.0f;
-};
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+// Simple one-pole exponential smoother for parameter changes.
+// y[n] = x + a * (y[n-1] - x), where a = exp(-1/(tau*fs))
+// Attack/Release both share the same tau here for simplicity.
+//
+// Evaluated in closed form, y[k] = x + (y0 - x) * a^k with k counted from
+// the last target change, so a ramp is the same however it is cut into
+// blocks or single process() steps. Once within settleLimit() of the target
+// the value snaps to it and processBlock() returns true without writing:
+// static parameters cost nothing per sample. (A float recursion on y stalls
+// a few hundred ulps short of x; the snap also keeps y out of subnormals.)
+struct OnePoleSmoother {
+    static constexpr size_t PowTable = 256;    // a^0..a^255, higher powers per 256
+    static constexpr float SettleEps = 1e-6f;  // relative to max(|target|, SettleFloor)
+    static constexpr float SettleFloor = 1e-3f;
+
+    static float settleLimit(float target) { return SettleEps * std::max(std::fabs(target), SettleFloor); }
+
+    // Everything the smoother evolves: the ramp from `from` towards `target`,
+    // `k` samples in, currently at `z`. A smoother's own state lives in it;
+    // the State overloads let one coefficient set drive many (TremoloBank).
+    struct State {
+        float z = 0.0f;
+        float from = 0.0f;
+        float target = 0.0f;
+        uint64_t k = 0;
+
+        bool settled() const { return z == target; }
+        static State at(float v) { return State{v, v, v, 0}; }
+    };
+
+    void setSampleRate(double fs) {
+        sampleRate = fs > 0 ? fs : 48000.0;
+        updateCoeff();
+    }
+    // tauSeconds ~ 0.005..0.02 typical for click-free smoothing
+    void setTimeConstant(float tauSeconds) {
+        tau = (tauSeconds > 1e-6f) ? tauSeconds : 1e-6f;
+        updateCoeff();
+    }
+    void reset(float value) { s = State::at(value); }
+    float value() const { return s.z; }
+    bool settled() const { return s.settled(); }
+
+    const State& state() const { return s; }
+    void setState(const State& st) { s = st; }
+
+    float process(float target) { return process(s, target); }
+    float process(State& st, float target) const {
+        float y;
+        return processBlock(st, target, &y, 1) ? st.z : y;
+    }
+
+    // Smooths towards `target` for n samples. Returns true if every value
+    // equals value() (settled; `out` is not written), else writes the ramp
+    // to out[0], out[stride], ... out[(n - 1) * stride].
+    bool processBlock(float target, float* out, size_t n, size_t stride = 1) {
+        return processBlock(s, target, out, n, stride);
+    }
+    bool processBlock(State& st, float target, float* out, size_t n, size_t stride = 1) const {
+        if (target != st.target) { st.from = st.z; st.target = target; st.k = 0; }
+        if (st.settled()) return true;
+        if (n == 0) return false;
+
+        const double x = double(target);
+        const double d = double(st.from) - x;
+        const double lim = double(settleLimit(target));
+        size_t i = 0;
+        while (i < n) {
+            // a^k = a^(256 j) * a^(k mod 256): a function of k alone
+            const uint64_t k = st.k + 1;
+            const uint64_t j = k / PowTable;
+            const double hi = j ? std::pow(double(a), double(j * PowTable)) : 1.0;
+            const size_t lo0 = size_t(k % PowTable);
+            const size_t run = std::min(n - i, PowTable - lo0);
+            for (size_t m = 0; m < run; ++m) {
+                const double r = d * (hi * pw[lo0 + m]);
+                if (std::fabs(r) <= lim) {
+                    // settled: snap and hold the target for the rest
+                    st = State::at(target);
+                    for (size_t q = i + m; q < n; ++q) out[q * stride] = target;
+                    return false;
+                }
+                out[(i + m) * stride] = float(x + r);
+            }
+            i += run;
+            st.k += run;
+        }
+        st.z = out[(n - 1) * stride];
+        return false;
+    }
+
+private:
+    void updateCoeff() {
+        a = std::exp(float(-1.0 / (tau * float(sampleRate))));
+        for (size_t i = 0; i < PowTable; ++i) pw[i] = std::pow(double(a), double(i));
+    }
+
+    double sampleRate = 48000.0;
+    float tau = 0.01f; // 10 ms default
+    float a = 0.0f;
+    double pw[PowTable] = {};
+    State s;
+};
@@ -0,0 +1,278 @@
+#include "PcmCodec.h"
+#include <algorithm>
+#include <cmath>
+#include <cctype>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PCM_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define PCM_NEON 1
+#include <arm_neon.h>
+#endif
+
+static const float kDecodeScale = 1.0f / 32768.0f;
+static const float kDecodeMax = 0.9999695f;
+
+void PcmCodec::decode16Scalar(const int16_t* src, float* dst, size_t n) {
+    for (size_t i=0;i<n;++i) {
+        dst[i] = std::max(-1.0f, std::min(kDecodeMax, src[i] * kDecodeScale));
+    }
+}
+
+void PcmCodec::encode16Scalar(const float* src, int16_t* dst, size_t n) {
+    for (size_t i=0;i<n;++i) {
+        float c = std::max(-1.0f, std::min(1.0f, src[i]));
+        dst[i] = (int16_t)std::lround(c * 32767.0f);
+    }
+}
+
+#if defined(PCM_SSE2)
+
+void PcmCodec::decode16(const int16_t* src, float* dst, size_t n) {
+    const __m128 scale = _mm_set1_ps(kDecodeScale);
+    const __m128 lo = _mm_set1_ps(-1.0f);
+    const __m128 hi = _mm_set1_ps(kDecodeMax);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        // sign-extend int16 -> int32
+        __m128i a = _mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16);
+        __m128i b = _mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16);
+        __m128 fa = _mm_mul_ps(_mm_cvtepi32_ps(a), scale);
+        __m128 fb = _mm_mul_ps(_mm_cvtepi32_ps(b), scale);
+        _mm_storeu_ps(dst + i,     _mm_max_ps(lo, _mm_min_ps(hi, fa)));
+        _mm_storeu_ps(dst + i + 4, _mm_max_ps(lo, _mm_min_ps(hi, fb)));
+    }
+    decode16Scalar(src + i, dst + i, n - i);
+}
+
+// lround() semantics: truncate, then step away from zero when |frac| >= 0.5
+static inline __m128i roundHalfAway(__m128 x) {
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 nhalf = _mm_set1_ps(-0.5f);
+    __m128i t = _mm_cvttps_epi32(x);
+    __m128 frac = _mm_sub_ps(x, _mm_cvtepi32_ps(t)); // exact for |x| < 2^23
+    __m128i up = _mm_castps_si128(_mm_cmpge_ps(frac, half));   // -1 where rounding up
+    __m128i dn = _mm_castps_si128(_mm_cmple_ps(frac, nhalf));  // -1 where rounding down
+    return _mm_add_epi32(_mm_sub_epi32(t, up), dn);
+}
+
+void PcmCodec::encode16(const float* src, int16_t* dst, size_t n) {
+    const __m128 lo = _mm_set1_ps(-1.0f);
+    const __m128 hi = _mm_set1_ps(1.0f);
+    const __m128 k = _mm_set1_ps(32767.0f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128 a = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(src + i), hi), lo);
+        __m128 b = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(src + i + 4), hi), lo);
+        __m128i ia = roundHalfAway(_mm_mul_ps(a, k));
+        __m128i ib = roundHalfAway(_mm_mul_ps(b, k));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(ia, ib));
+    }
+    encode16Scalar(src + i, dst + i, n - i);
+}
+
+const char* PcmCodec::simdName() { return "sse2"; }
+
+#elif defined(PCM_NEON)
+
+void PcmCodec::decode16(const int16_t* src, float* dst, size_t n) {
+    const float32x4_t scale = vdupq_n_f32(kDecodeScale);
+    const float32x4_t lo = vdupq_n_f32(-1.0f);
+    const float32x4_t hi = vdupq_n_f32(kDecodeMax);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        int16x8_t s = vld1q_s16(src + i);
+        float32x4_t fa = vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(s))), scale);
+        float32x4_t fb = vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(s))), scale);
+        vst1q_f32(dst + i,     vmaxq_f32(lo, vminq_f32(hi, fa)));
+        vst1q_f32(dst + i + 4, vmaxq_f32(lo, vminq_f32(hi, fb)));
+    }
+    decode16Scalar(src + i, dst + i, n - i);
+}
+
+// lround() semantics: truncate, then step away from zero when |frac| >= 0.5
+static inline int32x4_t roundHalfAway(float32x4_t x) {
+    int32x4_t t = vcvtq_s32_f32(x);
+    float32x4_t frac = vsubq_f32(x, vcvtq_f32_s32(t));
+    int32x4_t up = vreinterpretq_s32_u32(vcgeq_f32(frac, vdupq_n_f32(0.5f)));
+    int32x4_t dn = vreinterpretq_s32_u32(vcleq_f32(frac, vdupq_n_f32(-0.5f)));
+    return vaddq_s32(vsubq_s32(t, up), dn);
+}
+
+void PcmCodec::encode16(const float* src, int16_t* dst, size_t n) {
+    const float32x4_t lo = vdupq_n_f32(-1.0f);
+    const float32x4_t hi = vdupq_n_f32(1.0f);
+    const float32x4_t k = vdupq_n_f32(32767.0f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        float32x4_t a = vmaxq_f32(vminq_f32(vld1q_f32(src + i), hi), lo);
+        float32x4_t b = vmaxq_f32(vminq_f32(vld1q_f32(src + i + 4), hi), lo);
+        int16x4_t pa = vqmovn_s32(roundHalfAway(vmulq_f32(a, k)));
+        int16x4_t pb = vqmovn_s32(roundHalfAway(vmulq_f32(b, k)));
+        vst1q_s16(dst + i, vcombine_s16(pa, pb));
+    }
+    encode16Scalar(src + i, dst + i, n - i);
+}
+
+const char* PcmCodec::simdName() { return "neon"; }
+
+#else
+
+void PcmCodec::decode16(const int16_t* src, float* dst, size_t n) { decode16Scalar(src, dst, n); }
+void PcmCodec::encode16(const float* src, int16_t* dst, size_t n) { encode16Scalar(src, dst, n); }
+const char* PcmCodec::simdName() { return "scalar"; }
+
+#endif
+
+// 24/32-bit: assembled from bytes so unaligned data is fine; the loops are
+// simple enough for the compiler to vectorize the float side
+static const float kDecode24 = 1.0f / 8388608.0f;
+static const float kDecode32 = 1.0f / 2147483648.0f;
+
+void PcmCodec::decode24(const uint8_t* src, float* dst, size_t n) {
+    for (size_t i = 0; i < n; ++i, src += 3) {
+        // sign-extend via the top byte of an int32
+        const int32_t s = int32_t(uint32_t(src[0]) << 8 | uint32_t(src[1]) << 16 | uint32_t(src[2]) << 24) >> 8;
+        dst[i] = float(s) * kDecode24;
+    }
+}
+
+void PcmCodec::encode24(const float* src, uint8_t* dst, size_t n) {
+    size_t i = 0;
+#if defined(PCM_SSE2)
+    // |x * (2^23 - 1)| < 2^23, so the float rounding trick stays exact
+    const __m128 lo = _mm_set1_ps(-1.0f), hi = _mm_set1_ps(1.0f), k = _mm_set1_ps(8388607.0f);
+    alignas(16) int32_t t[4];
+    for (; i + 4 <= n; i += 4, dst += 12) {
+        __m128 c = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(src + i), hi), lo);
+        _mm_store_si128(reinterpret_cast<__m128i*>(t), roundHalfAway(_mm_mul_ps(c, k)));
+        for (int j = 0; j < 4; ++j) {
+            dst[j * 3 + 0] = uint8_t(t[j]);
+            dst[j * 3 + 1] = uint8_t(t[j] >> 8);
+            dst[j * 3 + 2] = uint8_t(t[j] >> 16);
+        }
+    }
+#endif
+    for (; i < n; ++i, dst += 3) {
+        const float c = std::max(-1.0f, std::min(1.0f, src[i]));
+        const int32_t s = int32_t(std::lround(c * 8388607.0f));
+        dst[0] = uint8_t(s);
+        dst[1] = uint8_t(s >> 8);
+        dst[2] = uint8_t(s >> 16);
+    }
+}
+
+void PcmCodec::decode32(const uint8_t* src, float* dst, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        int32_t s;
+        std::memcpy(&s, src + i * 4, 4);
+        dst[i] = float(s) * kDecode32;
+    }
+}
+
+void PcmCodec::encode32(const float* src, uint8_t* dst, size_t n) {
+    size_t i = 0;
+#if defined(PCM_SSE2)
+    // lround() in double, two lanes at a time
+    const __m128d lo = _mm_set1_pd(-1.0), hi = _mm_set1_pd(1.0), k = _mm_set1_pd(2147483647.0);
+    const __m128d half = _mm_set1_pd(0.5), nhalf = _mm_set1_pd(-0.5), one = _mm_set1_pd(1.0);
+    for (; i + 4 <= n; i += 4) {
+        const __m128 f = _mm_loadu_ps(src + i);
+        __m128i r[2];
+        for (int j = 0; j < 2; ++j) {
+            __m128d x = _mm_cvtps_pd(j ? _mm_movehl_ps(f, f) : f);
+            x = _mm_mul_pd(_mm_max_pd(_mm_min_pd(x, hi), lo), k);
+            __m128d t = _mm_cvtepi32_pd(_mm_cvttpd_epi32(x));
+            __m128d frac = _mm_sub_pd(x, t);
+            t = _mm_add_pd(t, _mm_and_pd(_mm_cmpge_pd(frac, half), one));
+            t = _mm_sub_pd(t, _mm_and_pd(_mm_cmple_pd(frac, nhalf), one));
+            r[j] = _mm_cvttpd_epi32(t);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_unpacklo_epi64(r[0], r[1]));
+    }
+#endif
+    for (; i < n; ++i) {
+        // double: 2^31 - 1 is not representable in float
+        const double c = std::max(-1.0, std::min(1.0, double(src[i])));
+        const int32_t s = int32_t(std::lround(c * 2147483647.0));
+        std::memcpy(dst + i * 4, &s, 4);
+    }
+}
+
+void PcmCodec::decode(SampleFormat f, const uint8_t* src, float* dst, size_t n) {
+    switch (f) {
+        case SampleFormat::Pcm24:   decode24(src, dst, n); break;
+        case SampleFormat::Pcm32:   decode32(src, dst, n); break;
+        case SampleFormat::Float32: std::memcpy(dst, src, n * sizeof(float)); break;
+        default:
+            if ((reinterpret_cast<uintptr_t>(src) & 1u) == 0) {
+                decode16(reinterpret_cast<const int16_t*>(src), dst, n);
+            } else {
+                // odd data offset (malformed padding): realign in chunks
+                int16_t tmp[1024];
+                for (size_t off = 0; off < n; off += 1024) {
+                    const size_t m = std::min<size_t>(1024, n - off);
+                    std::memcpy(tmp, src + off * 2, m * 2);
+                    decode16(tmp, dst + off, m);
+                }
+            }
+            break;
+    }
+}
+
+void PcmCodec::encode(SampleFormat f, const float* src, uint8_t* dst, size_t n) {
+    switch (f) {
+        case SampleFormat::Pcm24:   encode24(src, dst, n); break;
+        case SampleFormat::Pcm32:   encode32(src, dst, n); break;
+        case SampleFormat::Float32: std::memcpy(dst, src, n * sizeof(float)); break;
+        default:
+            if ((reinterpret_cast<uintptr_t>(dst) & 1u) == 0) {
+                encode16(src, reinterpret_cast<int16_t*>(dst), n);
+            } else {
+                int16_t tmp[1024];
+                for (size_t off = 0; off < n; off += 1024) {
+                    const size_t m = std::min<size_t>(1024, n - off);
+                    encode16(src + off, tmp, m);
+                    std::memcpy(dst + off * 2, tmp, m * 2);
+                }
+            }
+            break;
+    }
+}
+
+size_t PcmCodec::bytesPerSample(SampleFormat f) {
+    switch (f) {
+        case SampleFormat::Pcm24: return 3;
+        case SampleFormat::Pcm32:
+        case SampleFormat::Float32: return 4;
+        default: return 2;
+    }
+}
+
+bool PcmCodec::parseFormat(const std::string& s, SampleFormat& f) {
+    auto lower = s; for (auto& c : lower) c = char(std::tolower(c));
+    if (lower == "pcm16" || lower == "16") f = SampleFormat::Pcm16;
+    else if (lower == "pcm24" || lower == "24") f = SampleFormat::Pcm24;
+    else if (lower == "pcm32" || lower == "32") f = SampleFormat::Pcm32;
+    else if (lower == "float32" || lower == "float") f = SampleFormat::Float32;
+    else return false;
+    return true;
+}
+
+SampleFormat PcmCodec::parseFormat(const std::string& s) {
+    SampleFormat f = SampleFormat::Pcm16;
+    parseFormat(s, f);
+    return f;
+}
+
+const char* PcmCodec::formatName(SampleFormat f) {
+    switch (f) {
+        case SampleFormat::Pcm24:   return "pcm24";
+        case SampleFormat::Pcm32:   return "pcm32";
+        case SampleFormat::Float32: return "float32";
+        default:                    return "pcm16";
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Sample encodings WavReader/WavWriter handle (little-endian on disk)
+enum class SampleFormat { Pcm16, Pcm24, Pcm32, Float32 };
+
+// Bulk PCM <-> float conversion used by WavReader/WavWriter.
+// The SIMD paths (SSE2 / NEON) are bit-identical to the scalar ones:
+//   decode: x = clamp(s / 32768, -1, 0.9999695)
+//   encode: s = lround(clamp(x, -1, 1) * 32767)
+namespace PcmCodec {
+    void decode16(const int16_t* src, float* dst, size_t n);
+    void encode16(const float* src, int16_t* dst, size_t n);
+
+    // Reference per-sample versions (also used for SIMD tails)
+    void decode16Scalar(const int16_t* src, float* dst, size_t n);
+    void encode16Scalar(const float* src, int16_t* dst, size_t n);
+
+    // 24/32-bit PCM: x = s / 2^23 (2^31); s = lround(clamp(x, -1, 1) * (2^23 - 1))
+    void decode24(const uint8_t* src, float* dst, size_t n);
+    void encode24(const float* src, uint8_t* dst, size_t n);
+    void decode32(const uint8_t* src, float* dst, size_t n);
+    void encode32(const float* src, uint8_t* dst, size_t n);
+
+    // Any format from/to raw bytes (no alignment needed). Float32 is a plain
+    // copy: values outside [-1, 1] pass through unclamped.
+    void decode(SampleFormat f, const uint8_t* src, float* dst, size_t n);
+    void encode(SampleFormat f, const float* src, uint8_t* dst, size_t n);
+
+    size_t bytesPerSample(SampleFormat f);
+    SampleFormat parseFormat(const std::string& s); // pcm16|pcm24|pcm32|float32 (else pcm16)
+    bool parseFormat(const std::string& s, SampleFormat& f); // false on an unknown name
+    const char* formatName(SampleFormat f);
+
+    // Name of the compiled-in vector path ("sse2", "neon" or "scalar")
+    const char* simdName();
+}
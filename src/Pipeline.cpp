@@ -0,0 +1,481 @@
+#include "Pipeline.h"
+#include "AllocCounter.h"
+#include "Controller.h"
+#include "ThreadPool.h"
+#include "Profiler.h"
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+// p.automation plus the --demo lane: depth holds until 5 s, steps to 20% and
+// ramps back to the base depth at 8 s
+static Automation renderAutomation(const RenderParams& p) {
+    Automation a = p.automation;
+    if (p.demo && !a.has(AutoParam::Depth)) {
+        const float base = p.depth;
+        a.lane(AutoParam::Depth).points = {{5.0, base}, {5.0, 0.2f * base}, {8.0, base}};
+    }
+    return a;
+}
+
+static void setupTremolo(Tremolo& trem, const RenderParams& p, int sampleRate, int channels) {
+    trem.setSampleRate(sampleRate);
+    trem.setDepth(p.depth);
+    trem.setRateHz(p.rate);
+    trem.setWet(p.wet);
+    trem.setStereoPhaseDeg(p.stereophase);
+    trem.setChannelPhaseDeg(p.channelPhaseDeg.data(), p.channelPhaseDeg.size());
+    trem.setShape(p.shape);
+    trem.setAccuracy(p.accuracy);
+    trem.setPhaseMode(p.phaseMode);
+    trem.setAutomation(renderAutomation(p));
+    trem.setTempoSync(p.tempo, p.beatsPerCycle);
+    trem.prepare(channels);
+}
+
+// Largest |sample| of n interleaved samples
+static float blockPeak(const float* x, size_t n) {
+    float peak = 0.0f;
+    for (size_t i = 0; i < n; ++i) peak = std::max(peak, std::fabs(x[i]));
+    return peak;
+}
+
+// Tremolo::process on one DSP block, unless it is silent (p.silencePeak): then
+// advance() moves phase and smoothers exactly as process() would and the
+// block is passed through or zeroed. Returns the frames skipped.
+static size_t processBlock(Tremolo& trem, float* x, size_t frames, int channels, const RenderParams& p) {
+    const size_t n = frames * size_t(channels);
+    if (p.silencePeak > 0.0f && blockPeak(x, n) <= p.silencePeak) {
+        trem.advance(frames);
+        if (p.silenceZero) std::fill(x, x + n, 0.0f);
+        return frames;
+    }
+    trem.process(x, frames, channels);
+    return 0;
+}
+
+// Names of the opt-in features in `mask`, space-separated
+static std::string featureNames(unsigned mask) {
+    std::string s;
+    if (mask & FeatureExtractor::Peak) s += " peak";
+    if (mask & FeatureExtractor::Crest) s += " crest";
+    if (mask & FeatureExtractor::Onset) s += " onset";
+    if (mask & FeatureExtractor::Centroid) s += " centroid";
+    return s.empty() ? s : s.substr(1);
+}
+
+// Per-second means of the opt-in features for --analyze
+struct FeatureMeans {
+    double peak = 0.0, crest = 0.0, onset = 0.0, centroid = 0.0;
+
+    void add(const FeatureExtractor& f) {
+        peak += f.peak(); crest += f.crest(); onset += f.onset(); centroid += f.centroid();
+    }
+    void print(std::ostream& log, unsigned mask, size_t frames, int sampleRate) const {
+        const double k = 1.0 / double(frames);
+        if (mask & FeatureExtractor::Peak) log << ", peak=" << peak * k;
+        if (mask & FeatureExtractor::Crest) log << ", crest=" << crest * k;
+        if (mask & FeatureExtractor::Onset) log << ", onset=" << onset * k << " dB";
+        if (mask & FeatureExtractor::Centroid) log << ", centroid=" << centroid * k * sampleRate << " Hz";
+    }
+};
+
+static void printSkipped(std::ostream& log, const RenderResult& res) {
+    const double pct = res.frames ? 100.0 * double(res.skippedFrames) / double(res.frames) : 0.0;
+    log << "  Silence        : skipped " << double(res.skippedFrames) / double(res.sampleRate)
+        << " s of " << res.audioSeconds() << " s (" << pct << "%)\n";
+}
+
+static std::string writeError(const WavWriter& w) {
+    return w.tooLarge() ? "Output WAV would pass 4 GiB, the limit of its 32-bit RIFF sizes."
+                        : "Failed to write output WAV.";
+}
+
+static SampleFormat outputFormat(const WavReader& reader, const RenderParams& p) {
+    return p.outFormatFromInput ? reader.format() : p.outFormat;
+}
+
+static void printHeader(std::ostream& log, const std::string& in, const std::string& out,
+                        const WavReader& reader, const RenderParams& p) {
+    const double durationSec = double(reader.frames()) / double(reader.sampleRate());
+    log << "SmartTremolo\n";
+    log << "  Input          : " << in << "\n";
+    log << "  Output         : " << out << "\n";
+    log << "  SampleRate     : " << reader.sampleRate() << "\n";
+    log << "  Channels       : " << reader.channels() << "\n";
+    log << "  Duration       : " << durationSec << " s\n";
+    log << "  Input I/O      : " << (reader.isMapped() ? "mmap" : "stream") << "\n";
+    log << "  Format         : " << PcmCodec::formatName(reader.format())
+        << " -> " << PcmCodec::formatName(outputFormat(reader, p)) << "\n";
+    log << "  Params         : rate=" << p.rate
+        << " depth=" << p.depth
+        << " shape=" << Tremolo::shapeName(p.shape)
+        << " stereophase=" << p.stereophase
+        << " wet=" << p.wet
+        << " lfo=" << Lfo::accuracyName(p.accuracy)
+        << " phase=" << Tremolo::phaseModeName(p.phaseMode) << "\n";
+    if (p.features) log << "  Features       : rms zcr " << featureNames(p.features) << "\n";
+    if (!p.channelPhaseDeg.empty()) {
+        log << "  Channel phases :";
+        for (float d : p.channelPhaseDeg) log << " " << d;
+        log << " deg\n";
+    }
+    const Automation a = renderAutomation(p);
+    for (size_t k = 0; k < a.lanes.size(); ++k) {
+        const AutomationLane& lane = a.lanes[k];
+        if (lane.empty()) continue;
+        log << "  Automation     : " << Automation::paramName(AutoParam(k)) << ", "
+            << lane.points.size() << " points, " << lane.points.front().timeSeconds
+            << " s .. " << lane.points.back().timeSeconds << " s\n";
+    }
+    if (p.beatsPerCycle > 0.0 && !p.tempo.empty()) {
+        log << "  Tempo sync     : " << p.beatsPerCycle << " beats/cycle, " << p.tempo.points.size()
+            << " tempo point(s), " << p.tempo.points.front().bpm << " bpm at 0 s\n";
+    }
+    if (p.threads > 1)
+        log << "  Threads        : " << p.threads
+            << (Pipeline::canSegment(p) ? " (segment-parallel)" : " (serial: adaptive params)") << "\n";
+}
+
+bool Pipeline::canSegment(const RenderParams& p) {
+    // Segments are seeded by fast-forwarding the Tremolo state, which is only
+    // exact while nothing outside it changes parameters mid-file. The NoOp
+    // controller never does, advance() follows the automation lanes (and the
+    // demo ramp, which is one), and --analyze and --async-controller need the
+    // feature pass (the latter also reports the controller's stats).
+    return !p.analyze && !p.asyncController;
+}
+
+namespace {
+
+// One in-flight segment of the output
+struct Segment {
+    std::vector<float> buf;
+    size_t frames = 0;
+    size_t skipped = 0;
+    bool ok = false;
+    bool done = false;
+    std::mutex m;
+    std::condition_variable cv;
+};
+
+} // namespace
+
+// Splits the file into SegmentFrames-long segments rendered on a pool. The
+// main thread walks a state-only Tremolo (advance()) to seed each segment with
+// the serial phase and smoother values, then writes finished segments in order.
+static RenderResult renderSegmented(const std::string& in, RenderWorkspace& ws,
+                                    const Tremolo& base, const RenderParams& p, RenderResult res,
+                                    std::chrono::steady_clock::time_point t0, std::ostream* log) {
+    WavReader& reader = ws.reader;
+    WavWriter& writer = ws.writer;
+    const uint64_t total = reader.frames();
+    const int channels = reader.channels();
+    const size_t block = std::max<size_t>(1, p.blockFrames);
+    const size_t segFrames = (Pipeline::SegmentFrames + block - 1) / block * block;
+    const uint64_t nSeg = (total + segFrames - 1) / segFrames;
+    reader.close(); // workers open their own readers
+
+    ThreadPool pool(p.threads);
+    std::vector<Segment> slots(2 * pool.size());
+    // segment buffers are borrowed from the workspace and handed back below
+    if (ws.segments.size() < slots.size()) ws.segments.resize(slots.size());
+    for (size_t i = 0; i < slots.size(); ++i) slots[i].buf.swap(ws.segments[i]);
+    Tremolo scout = base;
+
+    uint64_t next = 0, written = 0;
+    bool ok = true;
+    while (written < nSeg && ok) {
+        // keep every slot busy
+        while (next < nSeg && next - written < slots.size()) {
+            Segment& seg = slots[next % slots.size()];
+            const uint64_t start = next * segFrames;
+            seg.frames = size_t(std::min<uint64_t>(segFrames, total - start));
+            seg.buf.resize(seg.frames * size_t(channels));
+            seg.done = false;
+
+            Tremolo trem = base;
+            trem.setState(scout.state());
+            scout.advance(seg.frames);
+
+            pool.submit([&seg, trem, start, in, channels, block, &p, prof = p.profiler]() mutable {
+                (void)prof;
+                bool good = false;
+                try {
+                    SMART_TREMOLO_PROFILE_SCOPE(prof, Profiler::Stage::Decode);
+                    WavReader r;
+                    good = r.open(in, p.io) && r.seek(start) &&
+                           r.read(seg.buf.data(), seg.frames) == seg.frames;
+                } catch (const std::exception&) {
+                    good = false;
+                }
+                seg.skipped = 0;
+                if (good && p.silencePeak > 0.0f) {
+                    SMART_TREMOLO_PROFILE_SCOPE(prof, Profiler::Stage::Dsp);
+                    SMART_TREMOLO_NO_ALLOC_SCOPE_IF(!prof, "the segment block loop");
+                    for (size_t off = 0; off < seg.frames; off += block)
+                        seg.skipped += processBlock(trem, seg.buf.data() + off * size_t(channels),
+                                                    std::min(block, seg.frames - off), channels, p);
+                } else if (good) {
+                    SMART_TREMOLO_PROFILE_SCOPE(prof, Profiler::Stage::Dsp);
+                    trem.process(seg.buf.data(), seg.frames, channels);
+                }
+                std::lock_guard<std::mutex> lock(seg.m);
+                seg.ok = good;
+                seg.done = true;
+                seg.cv.notify_one();
+            });
+            ++next;
+        }
+
+        Segment& seg = slots[written % slots.size()];
+        {
+            std::unique_lock<std::mutex> lock(seg.m);
+            seg.cv.wait(lock, [&]{ return seg.done; });
+        }
+        {
+            SMART_TREMOLO_PROFILE_SCOPE(p.profiler, Profiler::Stage::Encode);
+            ok = seg.ok && writer.write(seg.buf.data(), seg.frames);
+        }
+        res.skippedFrames += seg.skipped;
+        ++written;
+    }
+    pool.wait();
+    for (size_t i = 0; i < slots.size(); ++i) slots[i].buf.swap(ws.segments[i]);
+
+    bool finalized = false;
+    {
+        SMART_TREMOLO_PROFILE_SCOPE(p.profiler, Profiler::Stage::Encode);
+        finalized = ok && writer.finalize();
+    }
+    if (!finalized) {
+        res.error = writer.tooLarge() || ok ? writeError(writer) : "Failed to read or write a segment.";
+        return res;
+    }
+    res.ok = true;
+    res.frames = total;
+    res.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    if (log && p.silencePeak > 0.0f) printSkipped(*log, res);
+    return res;
+}
+
+static RenderResult render(const std::string& in, const std::string& out, const RenderParams& p,
+                           std::ostream* log, RenderWorkspace& ws) {
+    RenderResult res;
+    const auto t0 = std::chrono::steady_clock::now();
+    auto fail = [&](const std::string& msg) {
+        res.ok = false;
+        res.error = msg;
+        return res;
+    };
+
+    // Open WAV for streaming (header only; audio is decoded block by block)
+    WavReader& reader = ws.reader;
+    try {
+        if (!reader.open(in, p.io)) return fail("Failed to read input WAV.");
+    } catch (const std::exception& e) {
+        return fail(std::string("WAV error: ") + e.what());
+    }
+    const int sampleRate = reader.sampleRate();
+    const int channels = reader.channels();
+    res.sampleRate = sampleRate;
+    res.channels = channels;
+    res.mapped = reader.isMapped();
+
+    WavWriter& writer = ws.writer;
+    if (!writer.open(out, sampleRate, channels, outputFormat(reader, p), reader.channelMask()))
+        return fail("Failed to write output WAV.");
+
+    Tremolo trem;
+    setupTremolo(trem, p, sampleRate, channels);
+    if (log) printHeader(*log, in, out, reader, p);
+
+    if (p.threads > 1 && Pipeline::canSegment(p))
+        return renderSegmented(in, ws, trem, p, res, t0, log);
+
+    // Feature extractor & controller
+    FeatureExtractor& feat = ws.features;
+    feat.configure(FeatureExtractor::FrameSize, p.hop);
+    feat.setFeatures(p.features);
+    NoOpController ctrl;
+    std::unique_ptr<AsyncController> async;
+    if (p.asyncController) async.reset(new AsyncController(ctrl));
+    double timeSec = 0.0;
+    const double dt = 1.0 / double(sampleRate);
+
+    // Stream in chunks: decode a chunk, run features -> Tremolo::process in
+    // place on block-sized spans of it, encode the chunk. The chunk is a
+    // whole number of blocks, so block boundaries don't depend on it.
+    const size_t block = std::max<size_t>(1, p.blockFrames);
+    const size_t chunkFrames = std::max<size_t>(1, Pipeline::ChunkFrames / block) * block;
+    ControllerFrames& frames = ws.frames;
+    frames.clear();
+    frames.reserve(block / std::max<size_t>(1, p.hop) + 2, p.features);
+    std::vector<float>& chunk = ws.chunk;
+    chunk.resize(chunkFrames * size_t(channels));
+
+    size_t framesDone = 0;
+    size_t lastSecMark = 0;
+    double rmsAcc = 0.0;
+    size_t rmsCount = 0;
+    FeatureMeans extra;
+
+    Profiler* const prof = p.profiler;
+    (void)prof;
+
+    for (;;) {
+        size_t got = 0;
+        {
+            SMART_TREMOLO_PROFILE_SCOPE(prof, Profiler::Stage::Decode);
+            got = reader.read(chunk.data(), chunkFrames);
+        }
+        if (got == 0) break;
+
+        for (size_t off = 0; off < got; off += block) {
+            const size_t todo = std::min(block, got - off);
+            float* x = chunk.data() + off * size_t(channels);
+            // (the --profile trace log grows as it records)
+            SMART_TREMOLO_NO_ALLOC_SCOPE_IF(!prof, "the render block loop");
+
+            // async: apply whatever the worker has finished; the smoothers hide the step
+            if (async) {
+                SMART_TREMOLO_PROFILE_SCOPE(prof, Profiler::Stage::Controller);
+                float rate = p.rate;
+                float depth = p.depth;
+                if (async->poll(framesDone, rate, depth)) {
+                    trem.setRateHz(rate);
+                    trem.setDepth(depth);
+                }
+            }
+
+            // features + controller: one pass over the block, controller at frame boundaries
+            {
+                SMART_TREMOLO_PROFILE_SCOPE(prof, Profiler::Stage::Features);
+                feat.pushBlock(x, todo, channels, [&](size_t offset) {
+                    float rms = feat.rms();
+                    float zcr = feat.zcr();
+                    const float rate = p.rate;
+                    const float depth = p.depth;
+                    // time of the sample that completed the frame
+                    const uint64_t frame = framesDone + offset - 1;
+                    if (async) {
+                        // not a realtime thread: wake the worker right away
+                        if (async->push(frame, double(frame) * dt, feat, rate, depth)) async->wake();
+                    } else {
+                        frames.push(double(frame) * dt, rms, zcr, rate, depth);
+                        frames.pushFeatures(feat);
+                    }
+                    if (p.analyze) {
+                        rmsAcc += rms;
+                        rmsCount++;
+                        extra.add(feat);
+                    }
+                });
+            }
+
+            // one batched controller call per block; process() reads rate/depth
+            // once per block, so the last frame's targets are the ones that count
+            if (frames.size() > 0) {
+                SMART_TREMOLO_PROFILE_SCOPE(prof, Profiler::Stage::Controller);
+                ctrl.updateBatch(frames.view());
+                trem.setRateHz(frames.rateHz.back());
+                trem.setDepth(frames.depth.back());
+                frames.clear();
+            }
+
+            framesDone += todo;
+            timeSec = double(framesDone) * dt;
+
+            // Process tremolo in-place on this span of the decode buffer
+            {
+                SMART_TREMOLO_PROFILE_SCOPE(prof, Profiler::Stage::Dsp);
+                res.skippedFrames += processBlock(trem, x, todo, channels, p);
+            }
+
+            // per-second analysis print
+            size_t curSec = size_t(std::floor(timeSec));
+            if (p.analyze && log && curSec != lastSecMark) {
+                if (rmsCount > 0) {
+                    double meanRMS = rmsAcc / double(rmsCount);
+                    *log << "[analyze] t=" << lastSecMark
+                         << "s.."<< curSec << "s, avg RMS=" << meanRMS;
+                    extra.print(*log, p.features, rmsCount, sampleRate);
+                    *log << " (ZCR shown when frames align)\n";
+                }
+                rmsAcc = 0.0; rmsCount = 0;
+                extra = FeatureMeans();
+                lastSecMark = curSec;
+            }
+        }
+
+        // encode the whole chunk at once
+        SMART_TREMOLO_PROFILE_SCOPE(prof, Profiler::Stage::Encode);
+        if (!writer.write(chunk.data(), got)) return fail(writeError(writer));
+    }
+
+    // Patch header sizes
+    {
+        SMART_TREMOLO_PROFILE_SCOPE(prof, Profiler::Stage::Encode);
+        if (!writer.finalize()) return fail(writeError(writer));
+    }
+
+    if (async) {
+        res.controller = async->stats();
+        if (log)
+            *log << "  Controller     : async, " << res.controller.applied << "/" << res.controller.posted
+                 << " updates applied, latency avg " << res.controller.avgLatencyFrames
+                 << " max " << res.controller.maxLatencyFrames << " frames ("
+                 << 1000.0 * double(res.controller.maxLatencyFrames) / double(sampleRate) << " ms), "
+                 << res.controller.dropped << " dropped\n";
+    }
+
+    res.ok = true;
+    res.frames = framesDone;
+    res.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    if (log && p.silencePeak > 0.0f) printSkipped(*log, res);
+    return res;
+}
+
+RenderResult Pipeline::renderFile(const std::string& in, const std::string& out,
+                                  const RenderParams& p, std::ostream* log, RenderWorkspace* ws) {
+    RenderWorkspace local;
+    RenderWorkspace& w = ws ? *ws : local;
+    RenderResult res = render(in, out, p, log, w);
+    // a failed job leaves no truncated WAV at `out` (a good one is already
+    // finalized); a reused workspace must not hold the files open either way
+    w.writer.discard();
+    w.reader.close();
+    return res;
+}
+
+RenderResult Pipeline::renderBuffer(float* x, size_t frames, int channels, int sampleRate,
+                                    const RenderParams& p) {
+    RenderResult res;
+    const auto t0 = std::chrono::steady_clock::now();
+    if (channels < 1 || channels > WavReader::MaxChannels || sampleRate <= 0) {
+        res.error = "bad buffer layout";
+        return res;
+    }
+    res.sampleRate = sampleRate;
+    res.channels = channels;
+
+    // the serial path's NoOp controller hands back p.rate/p.depth, so the
+    // Tremolo alone renders the same samples
+    Tremolo trem;
+    setupTremolo(trem, p, sampleRate, channels);
+    const size_t block = std::max<size_t>(1, p.blockFrames);
+    for (size_t off = 0; off < frames; off += block)
+        res.skippedFrames += processBlock(trem, x + off * size_t(channels),
+                                          std::min(block, frames - off), channels, p);
+
+    res.ok = true;
+    res.frames = frames;
+    res.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return res;
+}
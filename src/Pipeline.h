@@ -0,0 +1,100 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <iosfwd>
+#include <cstdint>
+#include "Tremolo.h"
+#include "WavIO.h"
+#include "FeatureExtractor.h"
+#include "AsyncController.h"
+
+struct Profiler;
+
+// Parameters of one offline render (validated by the caller)
+struct RenderParams {
+    float rate = 5.0f;
+    float depth = 0.6f;
+    float wet = 1.0f;
+    float stereophase = 0.0f;
+    std::vector<float> channelPhaseDeg; // per-channel LFO offsets; empty = stereo layout
+    LFOShape shape = LFOShape::Sine;
+    LFOAccuracy accuracy = LFOAccuracy::Exact;
+    PhaseMode phaseMode = PhaseMode::Float;
+    WavReader::Mode io = WavReader::Mode::Auto;
+    bool outFormatFromInput = true;            // write the input's sample format...
+    SampleFormat outFormat = SampleFormat::Pcm16; // ...or this one
+    size_t hop = FeatureExtractor::FrameSize; // controller hop (samples)
+    size_t blockFrames = 512; // DSP span: features, controller and process() granularity
+    Automation automation; // breakpoint lanes rendered sample-accurately by Tremolo
+    TempoMap tempo;            // tempo sync (--rate-sync / --tempo-map)...
+    double beatsPerCycle = 0.0; // ...on when > 0 (quarter notes per LFO cycle)
+    bool demo = false;    // scripted depth ramp between 5s..8s (a depth lane)
+    bool analyze = false; // per-second RMS lines on the log stream
+    unsigned features = 0; // opt-in FeatureExtractor features for the controller and --analyze
+    float silencePeak = 0.0f; // > 0: DSP blocks whose peak is <= this skip Tremolo::process...
+    bool silenceZero = false; // ...and are zero-filled instead of passed through
+    unsigned threads = 1; // >1: render segments of one file in parallel
+    bool asyncController = false; // run the controller on a worker thread
+    Profiler* profiler = nullptr; // per-stage timers (--profile); not owned
+};
+
+struct RenderResult {
+    bool ok = false;
+    std::string error;
+    int sampleRate = 0;
+    int channels = 0;
+    uint64_t frames = 0;
+    bool mapped = false;
+    double wallSeconds = 0.0;
+    uint64_t skippedFrames = 0; // silent blocks that bypassed the DSP (p.silencePeak)
+    AsyncController::Stats controller; // filled when p.asyncController
+
+    double audioSeconds() const { return sampleRate > 0 ? double(frames) / double(sampleRate) : 0.0; }
+};
+
+// Every buffer a render allocates: reader/writer staging, the decode chunk,
+// the feature ring, the controller batch and the segment buffers. Callers
+// that run many jobs (Batch, Server) keep workspaces in a BufferPool so each
+// file reuses the last one's allocations instead of remaking them.
+struct RenderWorkspace {
+    WavReader reader;
+    WavWriter writer;
+    std::vector<float> chunk;
+    FeatureExtractor features;
+    ControllerFrames frames;
+    std::vector<std::vector<float>> segments;
+};
+
+namespace Pipeline {
+    // Frames decoded/encoded per WavReader/WavWriter call in the serial path
+    constexpr size_t ChunkFrames = size_t(1) << 14;
+
+    // Frames per segment in the segment-parallel path (rounded up to whole
+    // DSP blocks, so silence skipping sees the serial block grid)
+    constexpr size_t SegmentFrames = size_t(1) << 16;
+
+    // True if nothing outside the Tremolo changes parameters mid-file (lanes
+    // are fine: they live in its state), so segments rendered in parallel
+    // are bit-identical to the serial render
+    bool canSegment(const RenderParams& p);
+
+    // Streams `in` through features -> controller -> Tremolo::process -> `out`
+    // in blocks. Every call owns its Tremolo/FeatureExtractor/Controller, so
+    // independent calls may run concurrently. If `log` is set, the job header
+    // and --analyze lines are written to it; errors are returned in the result
+    // (and a failed render removes the partial file at `out`).
+    // With p.threads > 1 and canSegment(p), the file is split into segments
+    // rendered on a pool, each seeded with the exact serial Tremolo state.
+    // A workspace, if given, is used instead of fresh buffers (independent
+    // calls need their own); its files are closed again on return. The block
+    // loop itself never allocates (checked in SMART_TREMOLO_ALLOC_CHECK builds).
+    RenderResult renderFile(const std::string& in, const std::string& out,
+                            const RenderParams& p, std::ostream* log = nullptr,
+                            RenderWorkspace* ws = nullptr);
+
+    // Renders `frames` interleaved frames in place, with the same samples the
+    // serial renderFile() writes for a file holding them (p.analyze and
+    // p.asyncController don't apply: there is no log or controller thread)
+    RenderResult renderBuffer(float* x, size_t frames, int channels, int sampleRate,
+                              const RenderParams& p);
+}
@@ -0,0 +1,88 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+
+Profiler::Profiler(bool trace) : trace_(trace), origin_(Clock::now()) {
+    if (trace_) events_.reserve(1 << 14);
+}
+
+const char* Profiler::stageName(Stage s) {
+    switch (s) {
+        case Stage::Decode:     return "decode";
+        case Stage::Features:   return "features";
+        case Stage::Controller: return "controller";
+        case Stage::Dsp:        return "dsp";
+        case Stage::Encode:     return "encode";
+        default:                return "?";
+    }
+}
+
+void Profiler::add(Stage s, Clock::time_point t0, Clock::time_point t1) {
+    const uint64_t start = uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(t0 - origin_).count());
+    const uint64_t dur = uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+    std::lock_guard<std::mutex> lock(m_);
+    Totals& t = totals_[size_t(s)];
+    t.seconds += double(dur) * 1e-9;
+    ++t.calls;
+    if (!trace_) return;
+    if (events_.size() >= MaxTraceEvents) { ++droppedEvents_; return; }
+
+    const std::thread::id id = std::this_thread::get_id();
+    auto it = std::find(threads_.begin(), threads_.end(), id);
+    if (it == threads_.end()) it = threads_.insert(threads_.end(), id);
+    events_.push_back({start, dur, uint8_t(s), uint8_t(std::min<size_t>(it - threads_.begin(), 255))});
+}
+
+Profiler::Totals Profiler::totals(Stage s) const {
+    std::lock_guard<std::mutex> lock(m_);
+    return totals_[size_t(s)];
+}
+
+void Profiler::report(std::ostream& out, double wallSeconds, double audioSeconds) const {
+    std::lock_guard<std::mutex> lock(m_);
+    double sum = 0.0;
+    for (const Totals& t : totals_) sum += t.seconds;
+
+    out << "Profile (stage time summed over threads)\n";
+    const auto flags = out.flags();
+    const auto prec = out.precision();
+    out << std::fixed;
+    for (size_t i = 0; i < StageCount; ++i) {
+        const Totals& t = totals_[i];
+        out << "  " << std::left << std::setw(12) << stageName(Stage(i)) << std::right
+            << std::setprecision(3) << std::setw(10) << t.seconds * 1e3 << " ms"
+            << std::setprecision(1) << std::setw(7) << (sum > 0 ? 100.0 * t.seconds / sum : 0.0) << " %"
+            << std::setw(10) << t.calls << " calls\n";
+    }
+    if (sum <= wallSeconds) // serial render: the rest is setup and loop overhead
+        out << "  " << std::left << std::setw(12) << "other" << std::right
+            << std::setprecision(3) << std::setw(10) << (wallSeconds - sum) * 1e3 << " ms"
+            << "  (wall time outside the stages)\n";
+    out << "  Wall           : " << std::setprecision(3) << wallSeconds * 1e3 << " ms for "
+        << audioSeconds << " s of audio, realtime x"
+        << std::setprecision(1) << (wallSeconds > 0 ? audioSeconds / wallSeconds : 0.0) << "\n";
+    if (droppedEvents_)
+        out << "  Trace          : " << droppedEvents_ << " events dropped (limit "
+            << MaxTraceEvents << ")\n";
+    out.flags(flags);
+    out.precision(prec);
+}
+
+bool Profiler::writeChromeTrace(const std::string& path) const {
+    std::ofstream f(path);
+    if (!f) return false;
+    std::lock_guard<std::mutex> lock(m_);
+    // Trace Event Format: complete ("X") events, timestamps in microseconds
+    f << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    f << std::fixed << std::setprecision(3);
+    for (size_t i = 0; i < events_.size(); ++i) {
+        const Event& e = events_[i];
+        f << (i ? ",\n" : "\n") << "{\"name\":\"" << stageName(Stage(e.stage))
+          << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << unsigned(e.thread)
+          << ",\"ts\":" << double(e.startNs) * 1e-3 << ",\"dur\":" << double(e.durNs) * 1e-3 << "}";
+    }
+    f << "\n]}\n";
+    return bool(f);
+}
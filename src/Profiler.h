@@ -0,0 +1,83 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Per-stage wall-clock timers for one render (--profile)
+// - Profiler::Scope times one call of a stage; a null Profiler* disables it
+// - totals per stage are always kept; the individual events only when
+//   trace() is on, for writeChromeTrace() (chrome://tracing / Perfetto)
+// - safe to share between the segment workers (one short lock per event)
+// Build with SMART_TREMOLO_PROFILING=OFF to compile SMART_TREMOLO_PROFILE_SCOPE out.
+struct Profiler {
+    enum class Stage { Decode, Features, Controller, Dsp, Encode, Count };
+    static constexpr size_t StageCount = size_t(Stage::Count);
+
+    // Events kept for the trace before new ones are dropped (~40 MB)
+    static constexpr size_t MaxTraceEvents = size_t(1) << 20;
+
+    struct Totals {
+        double seconds = 0.0;
+        uint64_t calls = 0;
+    };
+
+    struct Scope {
+        Scope(Profiler* p, Stage s) : prof_(p), stage_(s) {
+            if (prof_) t0_ = Clock::now();
+        }
+        ~Scope() {
+            if (prof_) prof_->add(stage_, t0_, Clock::now());
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Profiler* prof_;
+        Stage stage_;
+        std::chrono::steady_clock::time_point t0_;
+    };
+
+    explicit Profiler(bool trace = false);
+
+    bool trace() const { return trace_; }
+    Totals totals(Stage s) const;
+
+    // Stage table plus realtime factor of `audioSeconds` rendered in `wallSeconds`
+    void report(std::ostream& out, double wallSeconds, double audioSeconds) const;
+    bool writeChromeTrace(const std::string& path) const;
+
+    static const char* stageName(Stage s);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Event {
+        uint64_t startNs, durNs;
+        uint8_t stage;
+        uint8_t thread;
+    };
+
+    void add(Stage s, Clock::time_point t0, Clock::time_point t1);
+
+    bool trace_;
+    Clock::time_point origin_;
+    mutable std::mutex m_;
+    std::array<Totals, StageCount> totals_{};
+    std::vector<Event> events_;
+    std::vector<std::thread::id> threads_; // index = trace tid
+    uint64_t droppedEvents_ = 0;
+};
+
+#if defined(SMART_TREMOLO_PROFILING)
+#define SMART_TREMOLO_PROFILE_CAT2(a, b) a##b
+#define SMART_TREMOLO_PROFILE_CAT(a, b) SMART_TREMOLO_PROFILE_CAT2(a, b)
+#define SMART_TREMOLO_PROFILE_SCOPE(prof, stage) \
+    Profiler::Scope SMART_TREMOLO_PROFILE_CAT(profScope_, __LINE__)((prof), (stage))
+#else
+#define SMART_TREMOLO_PROFILE_SCOPE(prof, stage) ((void)0)
+#endif
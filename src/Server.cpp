@@ -0,0 +1,469 @@
+#include "Server.h"
+#include "BufferPool.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Largest pcm payload accepted (bytes)
+constexpr uint64_t MaxPayloadBytes = uint64_t(1) << 30;
+
+bool fail(std::string* error, const std::string& msg) {
+    if (error) *error = msg;
+    return false;
+}
+
+// Whitespace-separated words; a double quote runs to the next one ("a b" -> a b)
+std::vector<std::string> splitWords(const std::string& line) {
+    std::vector<std::string> out;
+    std::string w;
+    bool quoted = false, any = false;
+    for (char c : line) {
+        if (c == '"') { quoted = !quoted; any = true; }
+        else if (!quoted && (c == ' ' || c == '\t' || c == '\r')) {
+            if (any) out.push_back(w);
+            w.clear();
+            any = false;
+        } else { w += c; any = true; }
+    }
+    if (any) out.push_back(w);
+    return out;
+}
+
+bool toFloat(const std::string& s, float& v) {
+    try { size_t end = 0; v = std::stof(s, &end); return end == s.size(); } catch (...) { return false; }
+}
+
+bool toUInt(const std::string& s, uint64_t& v) {
+    if (s.empty() || s.find_first_not_of("0123456789") != std::string::npos) return false;
+    try { v = std::stoull(s); return true; } catch (...) { return false; }
+}
+
+// Request source and reply sink of one client
+struct Conn {
+    virtual ~Conn() = default;
+    virtual bool readLine(std::string& line) = 0;
+    virtual bool readBytes(void* dst, size_t n) = 0;
+    virtual bool write(const void* src, size_t n) = 0;
+};
+
+struct StreamConn : Conn {
+    StreamConn(std::istream& in, std::ostream& out) : in_(in), out_(out) {}
+    bool readLine(std::string& line) override { return bool(std::getline(in_, line)); }
+    bool readBytes(void* dst, size_t n) override {
+        in_.read(static_cast<char*>(dst), std::streamsize(n));
+        return size_t(in_.gcount()) == n;
+    }
+    bool write(const void* src, size_t n) override {
+        out_.write(static_cast<const char*>(src), std::streamsize(n));
+        out_.flush();
+        return out_.good();
+    }
+
+private:
+    std::istream& in_;
+    std::ostream& out_;
+};
+
+#if !defined(_WIN32)
+// Does not own the fd: runSocket() closes it once the reader thread is joined
+struct SocketConn : Conn {
+    explicit SocketConn(int fd) : fd_(fd), buf_(1 << 16) {}
+
+    bool readLine(std::string& line) override {
+        line.clear();
+        for (;;) {
+            if (pos_ == len_ && !fill()) return !line.empty();
+            const char* b = buf_.data() + pos_;
+            const char* nl = static_cast<const char*>(std::memchr(b, '\n', len_ - pos_));
+            const size_t take = nl ? size_t(nl - b) : len_ - pos_;
+            line.append(b, take);
+            pos_ += take;
+            if (nl) { ++pos_; return true; }
+        }
+    }
+    bool readBytes(void* dst, size_t n) override {
+        char* d = static_cast<char*>(dst);
+        while (n > 0) {
+            if (pos_ == len_ && !fill()) return false;
+            const size_t take = std::min(n, len_ - pos_);
+            std::memcpy(d, buf_.data() + pos_, take);
+            pos_ += take; d += take; n -= take;
+        }
+        return true;
+    }
+    bool write(const void* src, size_t n) override {
+#if defined(MSG_NOSIGNAL)
+        const int flags = MSG_NOSIGNAL; // a vanished client is an error, not SIGPIPE
+#else
+        const int flags = 0;
+#endif
+        const char* s = static_cast<const char*>(src);
+        while (n > 0) {
+            const ssize_t k = ::send(fd_, s, n, flags);
+            if (k < 0 && errno == EINTR) continue;
+            if (k <= 0) return false;
+            s += k; n -= size_t(k);
+        }
+        return true;
+    }
+
+private:
+    bool fill() {
+        for (;;) {
+            const ssize_t k = ::recv(fd_, buf_.data(), buf_.size(), 0);
+            if (k < 0 && errno == EINTR) continue;
+            if (k <= 0) return false;
+            pos_ = 0;
+            len_ = size_t(k);
+            return true;
+        }
+    }
+
+    int fd_;
+    std::vector<char> buf_;
+    size_t pos_ = 0, len_ = 0;
+};
+#endif
+
+// Buffers one job borrows; kept across jobs so steady-state requests allocate
+// only when a payload outgrows every earlier one
+struct Slot {
+    RenderWorkspace ws;
+    std::vector<uint8_t> bytes; // pcm payload in, reply payload out
+    std::vector<float> samples;
+};
+
+struct Service {
+    explicit Service(const ServerOptions& opt)
+        : opt_(opt), pool_(opt.threads), slots_(2 * pool_.size()) {}
+
+    size_t threads() const { return pool_.size(); }
+    bool stopping() const { return shutdown_; }
+
+    // Reads and dispatches requests until the client leaves; returns once
+    // every job of this connection has replied
+    void serve(Conn& c);
+    void summary(std::ostream& log) const;
+
+private:
+    // Requests in flight on one connection; replies are written under m
+    struct Session {
+        std::mutex m;
+        std::condition_variable cv;
+        size_t inFlight = 0;
+    };
+
+    static bool reply(Conn& c, Session& ss, const std::string& line,
+                      const uint8_t* payload = nullptr, size_t bytes = 0) {
+        std::lock_guard<std::mutex> lock(ss.m);
+        return c.write(line.data(), line.size()) && (!bytes || c.write(payload, bytes));
+    }
+
+    void runJob(Conn& c, Session& ss, const ServerJob& job, Slot& slot,
+                std::chrono::steady_clock::time_point t0);
+
+    const ServerOptions& opt_;
+    ThreadPool pool_;
+    BufferPool<Slot> slots_;
+    std::atomic<bool> shutdown_{false};
+
+    mutable std::mutex statsM_;
+    uint64_t jobs_ = 0, failed_ = 0;
+    double audioSeconds_ = 0.0, latencyMs_ = 0.0;
+};
+
+void Service::runJob(Conn& c, Session& ss, const ServerJob& job, Slot& slot,
+                     std::chrono::steady_clock::time_point t0) {
+    RenderResult res;
+    const uint8_t* payload = nullptr;
+    size_t payloadBytes = 0;
+    if (job.kind == ServerJob::Kind::File) {
+        res = Pipeline::renderFile(job.in, job.out, job.params, nullptr, &slot.ws);
+    } else {
+        const size_t n = size_t(job.frames) * size_t(job.channels);
+        slot.samples.resize(n);
+        PcmCodec::decode(job.format, slot.bytes.data(), slot.samples.data(), n);
+        res = Pipeline::renderBuffer(slot.samples.data(), size_t(job.frames), job.channels,
+                                     job.sampleRate, job.params);
+        const SampleFormat outFmt = job.params.outFormatFromInput ? job.format : job.params.outFormat;
+        if (res.ok && job.out == "-") {
+            slot.bytes.resize(n * PcmCodec::bytesPerSample(outFmt));
+            PcmCodec::encode(outFmt, slot.samples.data(), slot.bytes.data(), n);
+            payload = slot.bytes.data();
+            payloadBytes = slot.bytes.size();
+        } else if (res.ok) {
+            WavWriter& w = slot.ws.writer;
+            res.ok = w.open(job.out, job.sampleRate, job.channels, outFmt) &&
+                     w.write(slot.samples.data(), size_t(job.frames)) && w.finalize();
+            if (!res.ok) {
+                w.discard();
+                res.error = "Failed to write output WAV.";
+            }
+        }
+    }
+    const double ms = 1000.0 * std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    std::ostringstream line;
+    if (res.ok) {
+        line << "ok " << job.id << " frames=" << res.frames << " ms=" << ms;
+        if (job.params.silencePeak > 0.0f) line << " skipped=" << res.skippedFrames;
+        if (payload) line << " bytes=" << payloadBytes;
+    } else {
+        line << "err " << job.id << " " << res.error;
+    }
+    line << "\n";
+    reply(c, ss, line.str(), payload, payloadBytes);
+
+    std::lock_guard<std::mutex> lock(statsM_);
+    ++jobs_;
+    if (res.ok) audioSeconds_ += res.audioSeconds();
+    else ++failed_;
+    latencyMs_ += ms;
+}
+
+void Service::serve(Conn& c) {
+    Session ss;
+    uint64_t seq = 0;
+    std::string line;
+    while (!shutdown_ && c.readLine(line)) {
+        const size_t b = line.find_first_not_of(" \t\r");
+        if (b == std::string::npos || line[b] == '#') continue;
+        const auto t0 = std::chrono::steady_clock::now();
+        const std::string cmd = splitWords(line).front();
+        if (cmd == "quit") break;
+        if (cmd == "shutdown") { shutdown_ = true; break; }
+        if (cmd == "ping") { reply(c, ss, "ok ping\n"); continue; }
+
+        ServerJob job;
+        std::string err;
+        ++seq;
+        const bool parsed = Server::parseJob(line, opt_.params, job, &err);
+        if (job.id.empty()) job.id = std::to_string(seq);
+        job.params.threads = 1; // pool_ already runs jobs in parallel: no nested segment pools
+        if (!parsed) {
+            reply(c, ss, "err " + job.id + " " + err + "\n");
+            if (job.kind == ServerJob::Kind::Pcm) break; // payload length unknown: stream lost
+            continue;
+        }
+
+        Slot* slot = slots_.acquire(); // blocks while every workspace is busy
+        if (job.kind == ServerJob::Kind::Pcm) {
+            slot->bytes.resize(size_t(job.frames) * size_t(job.channels) * PcmCodec::bytesPerSample(job.format));
+            if (!c.readBytes(slot->bytes.data(), slot->bytes.size())) {
+                slots_.release(slot);
+                reply(c, ss, "err " + job.id + " truncated pcm payload\n");
+                break;
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(ss.m);
+            ++ss.inFlight;
+        }
+        pool_.submit([this, &c, &ss, job, slot, t0] {
+            runJob(c, ss, job, *slot, t0);
+            slots_.release(slot);
+            std::lock_guard<std::mutex> lock(ss.m);
+            if (--ss.inFlight == 0) ss.cv.notify_all();
+        });
+    }
+    std::unique_lock<std::mutex> lock(ss.m);
+    ss.cv.wait(lock, [&]{ return ss.inFlight == 0; });
+}
+
+void Service::summary(std::ostream& log) const {
+    std::lock_guard<std::mutex> lock(statsM_);
+    log << "[serve] done: " << (jobs_ - failed_) << " ok, " << failed_ << " failed, "
+        << audioSeconds_ << " s audio, avg latency " << (jobs_ ? latencyMs_ / double(jobs_) : 0.0) << " ms\n";
+}
+
+#if !defined(_WIN32)
+int runSocket(Service& svc, const std::string& path, std::ostream& log) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        log << "[serve] socket path too long: " << path << "\n";
+        return 1;
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        log << "[serve] socket(): " << std::strerror(errno) << "\n";
+        return 1;
+    }
+    ::unlink(path.c_str()); // a stale socket from an earlier run
+    if (::bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(fd, 16) != 0) {
+        log << "[serve] cannot listen on " << path << ": " << std::strerror(errno) << "\n";
+        ::close(fd);
+        return 1;
+    }
+    log << "[serve] listening on " << path << ", " << svc.threads() << " threads\n";
+
+    // one reader thread per client; finished ones are joined as new ones
+    // arrive. The fd stays open until the join so stopping can shut down
+    // clients still blocked in recv() without racing a reused descriptor.
+    struct Client {
+        std::thread t;
+        int fd = -1;
+        std::atomic<bool> done{false};
+    };
+    std::list<Client> clients;
+    while (!svc.stopping()) {
+        const int cfd = ::accept(fd, nullptr, nullptr);
+        if (cfd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            break; // shut down (or a real error)
+        }
+        for (auto it = clients.begin(); it != clients.end();) {
+            if (it->done) { it->t.join(); ::close(it->fd); it = clients.erase(it); }
+            else ++it;
+        }
+        clients.emplace_back();
+        Client& cl = clients.back();
+        cl.fd = cfd;
+        cl.t = std::thread([&svc, &cl, cfd, fd] {
+            {
+                SocketConn conn(cfd);
+                svc.serve(conn);
+            }
+            ::shutdown(cfd, SHUT_RDWR); // the client sees EOF now, not at the join
+            if (svc.stopping()) ::shutdown(fd, SHUT_RDWR); // wakes accept()
+            cl.done = true;
+        });
+    }
+    // wake readers of the other clients; their serve() returns on EOF
+    for (auto& cl : clients) ::shutdown(cl.fd, SHUT_RDWR);
+    for (auto& cl : clients) {
+        cl.t.join();
+        ::close(cl.fd);
+    }
+    ::close(fd);
+    ::unlink(path.c_str());
+    return 0;
+}
+#endif
+
+} // namespace
+
+bool Server::parseJob(const std::string& line, const RenderParams& defaults, ServerJob& job,
+                      std::string* error) {
+    const std::vector<std::string> words = splitWords(line);
+    job = ServerJob();
+    job.params = defaults;
+    if (words.empty()) return fail(error, "empty request");
+    if (words[0] == "pcm") job.kind = ServerJob::Kind::Pcm;
+    else if (words[0] != "render") return fail(error, "unknown request: " + words[0]);
+
+    RenderParams& p = job.params;
+    bool haveRate = false, haveChannels = false, haveFrames = false;
+    for (size_t i = 1; i < words.size(); ++i) {
+        const size_t eq = words[i].find('=');
+        if (eq == std::string::npos) return fail(error, "expected key=value: " + words[i]);
+        const std::string k = words[i].substr(0, eq), v = words[i].substr(eq + 1);
+        float f = 0.f;
+        uint64_t u = 0;
+        if (k == "id") job.id = v;
+        else if (k == "in") job.in = v;
+        else if (k == "out") job.out = v;
+        else if (k == "shape") p.shape = Tremolo::parseShape(v);
+        else if (k == "lfo") p.accuracy = Lfo::parseAccuracy(v);
+        else if (k == "phase") p.phaseMode = Tremolo::parsePhaseMode(v);
+        else if (k == "out-format") {
+            p.outFormatFromInput = v == "auto";
+            if (!p.outFormatFromInput && !PcmCodec::parseFormat(v, p.outFormat))
+                return fail(error, "out-format must be auto|pcm16|pcm24|pcm32|float32");
+        } else if (k == "format") {
+            // sizes the payload: a guess would desync the stream
+            if (!PcmCodec::parseFormat(v, job.format))
+                return fail(error, "format must be pcm16|pcm24|pcm32|float32");
+        }
+        else if (k == "silence-zero") p.silenceZero = v == "1";
+        else if (k == "sr" || k == "channels" || k == "frames" || k == "block") {
+            if (!toUInt(v, u)) return fail(error, k + " must be a whole number");
+            if (k == "sr") { job.sampleRate = int(std::min<uint64_t>(u, 1u << 30)); haveRate = true; }
+            else if (k == "channels") { job.channels = int(std::min<uint64_t>(u, 1u << 30)); haveChannels = true; }
+            else if (k == "frames") { job.frames = u; haveFrames = true; }
+            else if (u < 1 || u > 65536) return fail(error, "block must be [1..65536]");
+            else p.blockFrames = size_t(u);
+        } else if (!toFloat(v, f)) {
+            return fail(error, "bad value for " + k + ": " + v);
+        } else if (k == "rate") {
+            if (f <= 0.0f) return fail(error, "rate must be > 0");
+            p.rate = f;
+        } else if (k == "depth") {
+            if (f < 0.0f || f > 1.0f) return fail(error, "depth must be [0..1]");
+            p.depth = f;
+        } else if (k == "wet") {
+            if (f < 0.0f || f > 1.0f) return fail(error, "wet must be [0..1]");
+            p.wet = f;
+        } else if (k == "stereophase") {
+            if (f < 0.0f || f > 180.0f) return fail(error, "stereophase must be [0..180]");
+            p.stereophase = f;
+        } else if (k == "skip-silence") {
+            if (!(f <= 0.0f)) return fail(error, "skip-silence must be a peak level in dBFS (<= 0)");
+            p.silencePeak = std::pow(10.f, f / 20.f);
+        } else {
+            return fail(error, "unknown key: " + k);
+        }
+    }
+    // a reply would be interleaved with another job's output on stdout otherwise
+    p.analyze = false;
+    p.asyncController = false;
+
+    if (job.kind == ServerJob::Kind::File) {
+        if (job.in.empty() || job.out.empty()) return fail(error, "render needs in= and out=");
+        if (job.out == "-") return fail(error, "out=- is for pcm jobs");
+        return true;
+    }
+    if (!haveRate || !haveChannels || !haveFrames) return fail(error, "pcm needs sr=, channels= and frames=");
+    if (job.sampleRate < 1) return fail(error, "sr must be > 0");
+    if (job.channels < 1 || job.channels > WavReader::MaxChannels)
+        return fail(error, "channels must be [1.." + std::to_string(WavReader::MaxChannels) + "]");
+    if (job.frames > MaxPayloadBytes / (uint64_t(job.channels) * PcmCodec::bytesPerSample(job.format)))
+        return fail(error, "pcm payload over 1 GiB");
+    if (job.out.empty()) job.out = "-";
+    return true;
+}
+
+void Server::serveStream(const ServerOptions& opt, std::istream& in, std::ostream& out, std::ostream& log) {
+    Service svc(opt);
+    log << "[serve] reading jobs on stdin, " << svc.threads() << " threads\n";
+    StreamConn conn(in, out);
+    svc.serve(conn);
+    svc.summary(log);
+}
+
+int Server::run(const ServerOptions& opt, std::ostream& log) {
+    if (opt.socketPath.empty()) {
+        serveStream(opt, std::cin, std::cout, log);
+        return 0;
+    }
+    Service svc(opt);
+#if !defined(_WIN32)
+    const int code = runSocket(svc, opt.socketPath, log);
+#else
+    log << "[serve] Unix sockets are not available on this platform; use stdin\n";
+    const int code = 1;
+#endif
+    svc.summary(log);
+    return code;
+}
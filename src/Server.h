@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include "Pipeline.h"
+
+struct ServerOptions {
+    unsigned threads = 0;   // render workers (0 = one per hardware thread)
+    std::string socketPath; // Unix socket to listen on; empty = stdin/stdout
+    RenderParams params;    // defaults of every job; job keys override them
+};
+
+// One request line of the server protocol
+struct ServerJob {
+    enum class Kind { File, Pcm };
+    Kind kind = Kind::File;
+    std::string id;  // echoed in the reply (default: the request's sequence number)
+    std::string in;  // file jobs
+    std::string out; // WAV path; "-" (pcm jobs) sends the samples back
+    RenderParams params;
+    // pcm jobs: layout of the payload that follows the line
+    int sampleRate = 0;
+    int channels = 0;
+    uint64_t frames = 0;
+    SampleFormat format = SampleFormat::Float32;
+};
+
+// Long-lived render server: the process, pool and buffers stay up and jobs
+// arrive as text lines, one per job, from stdin or Unix socket clients:
+//
+//   render in=<in.wav> out=<out.wav> [id=..] [param=value ...]
+//   pcm sr=<Hz> channels=<n> frames=<n> [format=float32|pcm16|pcm24|pcm32]
+//       [out=<out.wav>|-] [id=..] [param=value ...]      + frames x channels samples
+//   ping | quit (close this connection) | shutdown (stop the socket server)
+//
+// Params are rate, depth, wet, stereophase, shape, lfo, phase, out-format,
+// block, skip-silence (dBFS) and silence-zero (0|1); values may be "quoted".
+// Each job gets "ok <id> frames=<n> ms=<latency> [skipped=<n>]" or
+// "err <id> <message>"; pcm jobs with out=- add " bytes=<n>" and the
+// rendered samples (payload format, or out-format) after the line.
+//
+// Jobs run on a worker pool, so one job's decode overlaps another's DSP and
+// encode, and replies come in completion order (match them by id). Each job
+// borrows a workspace (WAV reader/writer, decode and payload buffers) from a
+// fixed set that is reused, never freed, between jobs; with every workspace
+// busy the server stops reading requests.
+namespace Server {
+    bool parseJob(const std::string& line, const RenderParams& defaults, ServerJob& job,
+                  std::string* error = nullptr);
+
+    // One connection's requests from `in` until EOF or "quit", replies to
+    // `out` (run()'s stdin mode; the bench drives it from strings)
+    void serveStream(const ServerOptions& opt, std::istream& in, std::ostream& out, std::ostream& log);
+
+    // Serves until EOF / "quit" on stdin, or "shutdown" on the socket. Status
+    // lines go to `log` (stdout carries the replies in stdin mode).
+    // Returns the process exit code.
+    int run(const ServerOptions& opt, std::ostream& log);
+}
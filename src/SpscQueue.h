@@ -0,0 +1,39 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+// Wait-free single-producer / single-consumer ring buffer. One thread may
+// push(), one other thread may pop(); neither ever blocks or allocates, so it
+// is safe to use from an audio callback. Capacity is N - 1 (N power of two).
+template <class T, size_t N>
+struct SpscQueue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "N must be a power of two");
+
+    // Returns false if the queue is full (the item is dropped)
+    bool push(const T& v) {
+        const size_t h = head_.load(std::memory_order_relaxed);
+        const size_t next = (h + 1) & (N - 1);
+        if (next == tail_.load(std::memory_order_acquire)) return false;
+        buf_[h] = v;
+        head_.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Returns false if the queue is empty
+    bool pop(T& out) {
+        const size_t t = tail_.load(std::memory_order_relaxed);
+        if (t == head_.load(std::memory_order_acquire)) return false;
+        out = buf_[t];
+        tail_.store((t + 1) & (N - 1), std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return tail_.load(std::memory_order_acquire) == head_.load(std::memory_order_acquire);
+    }
+
+private:
+    alignas(64) std::atomic<size_t> head_{0}; // written by producer
+    alignas(64) std::atomic<size_t> tail_{0}; // written by consumer
+    T buf_[N];
+};
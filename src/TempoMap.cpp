@@ -0,0 +1,211 @@
+#include "TempoMap.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+namespace {
+
+bool fail(std::string* error, const std::string& msg) {
+    if (error) *error = msg;
+    return false;
+}
+
+// Sorts by time (later entries win at equal times) and makes the map start
+// at 0 s with its first tempo
+void normalize(std::vector<TempoPoint>& pts) {
+    std::stable_sort(pts.begin(), pts.end(),
+                     [](const TempoPoint& a, const TempoPoint& b) { return a.timeSeconds < b.timeSeconds; });
+    std::vector<TempoPoint> out;
+    for (const TempoPoint& p : pts) {
+        if (!out.empty() && out.back().timeSeconds == p.timeSeconds) out.back() = p;
+        else out.push_back(p);
+    }
+    if (!out.empty() && out.front().timeSeconds > 0.0) out.insert(out.begin(), TempoPoint{0.0, out.front().bpm});
+    pts = std::move(out);
+}
+
+// Big-endian cursor over a MIDI file; reads past the end return 0 and set bad
+struct MidiReader {
+    const std::vector<uint8_t>& d;
+    size_t pos = 0, end = 0;
+    bool bad = false;
+
+    uint8_t u8() {
+        if (pos >= end) { bad = true; return 0; }
+        return d[pos++];
+    }
+    uint32_t be(int bytes) {
+        uint32_t v = 0;
+        for (int i = 0; i < bytes; ++i) v = (v << 8) | u8();
+        return v;
+    }
+    uint32_t vlq() {
+        uint32_t v = 0;
+        for (int i = 0; i < 4; ++i) {
+            const uint8_t b = u8();
+            v = (v << 7) | (b & 0x7f);
+            if (!(b & 0x80)) return v;
+        }
+        bad = true;
+        return v;
+    }
+    void skip(uint32_t n) {
+        if (n > end - pos) { bad = true; pos = end; }
+        else pos += n;
+    }
+};
+
+struct MidiTempo {
+    uint64_t tick;
+    uint32_t usPerQuarter;
+};
+
+// Tempo events (FF 51 03) of one MTrk body [r.pos, r.end)
+bool readTrack(MidiReader& r, std::vector<MidiTempo>& out) {
+    uint64_t tick = 0;
+    uint8_t status = 0;
+    while (r.pos < r.end && !r.bad) {
+        tick += r.vlq();
+        uint8_t b = r.u8();
+        if (b == 0xff) {
+            const uint8_t type = r.u8();
+            const uint32_t len = r.vlq();
+            if (type == 0x51 && len == 3) out.push_back({tick, r.be(3)});
+            else if (type == 0x2f) return !r.bad; // end of track
+            else r.skip(len);
+            continue;
+        }
+        if (b == 0xf0 || b == 0xf7) { r.skip(r.vlq()); continue; } // sysex
+        if (b & 0x80) status = b;
+        else if (status) --r.pos; // running status: b was the first data byte
+        else return false;
+        const uint8_t kind = status & 0xf0;
+        r.skip(kind == 0xc0 || kind == 0xd0 ? 1 : 2);
+    }
+    return !r.bad;
+}
+
+bool loadMidi(const std::vector<uint8_t>& data, std::vector<TempoPoint>& pts, std::string* error) {
+    MidiReader r{data};
+    r.end = data.size();
+    if (r.be(4) != 0x4d546864 /* MThd */) return fail(error, "not a MIDI file");
+    const uint32_t hdrLen = r.be(4);
+    r.be(2); // format: tempo events are merged from every track
+    const uint32_t tracks = r.be(2);
+    const uint32_t division = r.be(2);
+    if (r.bad || hdrLen < 6) return fail(error, "truncated MIDI header");
+    if (division & 0x8000) return fail(error, "SMPTE time division is not supported");
+    if (division == 0) return fail(error, "MIDI division is 0");
+    r.skip(hdrLen - 6);
+
+    std::vector<MidiTempo> events;
+    for (uint32_t t = 0; t < tracks && !r.bad && r.pos < data.size(); ++t) {
+        const uint32_t id = r.be(4), len = r.be(4);
+        if (r.bad || len > data.size() - r.pos) return fail(error, "truncated MIDI track");
+        MidiReader tr{data, r.pos, r.pos + len};
+        if (id == 0x4d54726b /* MTrk */ && !readTrack(tr, events)) return fail(error, "malformed MIDI track");
+        r.skip(len);
+    }
+    std::stable_sort(events.begin(), events.end(),
+                     [](const MidiTempo& a, const MidiTempo& b) { return a.tick < b.tick; });
+
+    // ticks -> seconds, 120 bpm until the first tempo event
+    uint64_t lastTick = 0;
+    double seconds = 0.0, usPerQuarter = 500000.0;
+    pts.push_back({0.0, 120.0});
+    for (const MidiTempo& e : events) {
+        if (e.usPerQuarter == 0) continue;
+        seconds += double(e.tick - lastTick) * usPerQuarter / (double(division) * 1e6);
+        lastTick = e.tick;
+        usPerQuarter = double(e.usPerQuarter);
+        pts.push_back({seconds, 60e6 / usPerQuarter});
+    }
+    return true;
+}
+
+} // namespace
+
+double TempoMap::bpmAt(double t) const {
+    if (points.empty()) return 120.0;
+    auto it = std::upper_bound(points.begin(), points.end(), t,
+                               [](double v, const TempoPoint& p) { return v < p.timeSeconds; });
+    return it == points.begin() ? points.front().bpm : (it - 1)->bpm;
+}
+
+double TempoMap::beatsAt(double t) const {
+    if (points.empty()) return 0.0;
+    double beats = 0.0;
+    for (size_t k = 0; k < points.size(); ++k) {
+        const double end = k + 1 < points.size() ? points[k + 1].timeSeconds : t;
+        if (t <= end || k + 1 == points.size())
+            return beats + (t - points[k].timeSeconds) * points[k].bpm / 60.0;
+        beats += (end - points[k].timeSeconds) * points[k].bpm / 60.0;
+    }
+    return beats;
+}
+
+TempoMap TempoMap::constant(double bpm) {
+    TempoMap m;
+    m.points.push_back({0.0, bpm});
+    return m;
+}
+
+bool TempoMap::load(const std::string& path, std::string* error) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f) return fail(error, "cannot open tempo map " + path);
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+
+    std::vector<TempoPoint> pts;
+    if (data.size() >= 4 && std::equal(data.begin(), data.begin() + 4, "MThd")) {
+        std::string why;
+        if (!loadMidi(data, pts, &why)) return fail(error, path + ": " + why);
+    } else {
+        std::istringstream text(std::string(data.begin(), data.end()));
+        std::string line;
+        int lineNo = 0;
+        while (std::getline(text, line)) {
+            ++lineNo;
+            const size_t hash = line.find('#');
+            if (hash != std::string::npos) line.erase(hash);
+            std::replace(line.begin(), line.end(), ',', ' ');
+            std::istringstream ls(line);
+            TempoPoint p;
+            if (!(ls >> p.timeSeconds)) continue; // blank
+            if (!(ls >> p.bpm) || !(p.timeSeconds >= 0.0) || !(p.bpm > 0.0))
+                return fail(error, path + ":" + std::to_string(lineNo) + ": expected <seconds> <bpm>");
+            pts.push_back(p);
+        }
+        if (pts.empty()) return fail(error, path + ": no tempo points");
+    }
+    normalize(pts);
+    points = std::move(pts);
+    return true;
+}
+
+bool TempoMap::parseDivision(const std::string& s, double& beatsPerCycle) {
+    std::string base = s;
+    for (auto& c : base) c = char(std::tolower(c));
+    double scale = 1.0;
+    if (!base.empty() && base.back() == '.') { scale = 1.5; base.pop_back(); }
+    else if (!base.empty() && base.back() == 't') { scale = 2.0 / 3.0; base.pop_back(); }
+
+    double whole = 0.0; // cycle length in whole notes
+    if (base == "1" || base == "2" || base == "4") {
+        whole = double(base[0] - '0');
+    } else if (base.size() > 2 && base.compare(0, 2, "1/") == 0) {
+        int n = 0;
+        for (size_t i = 2; i < base.size(); ++i) {
+            if (!std::isdigit(static_cast<unsigned char>(base[i])) || n > 64) return false;
+            n = n * 10 + (base[i] - '0');
+        }
+        if (n < 2 || n > 64 || (n & (n - 1))) return false; // 1/2 .. 1/64
+        whole = 1.0 / double(n);
+    } else {
+        return false;
+    }
+    beatsPerCycle = 4.0 * whole * scale;
+    return true;
+}
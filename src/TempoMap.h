@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Tempo from this time on (seconds, quarter notes per minute)
+struct TempoPoint {
+    double timeSeconds = 0.0;
+    double bpm = 120.0;
+};
+
+// Piecewise-constant tempo, sorted by time with the first point at 0 s.
+// Beats count quarter notes from the start of the file.
+struct TempoMap {
+    std::vector<TempoPoint> points;
+
+    bool empty() const { return points.empty(); }
+    double beatsAt(double timeSeconds) const;
+    double bpmAt(double timeSeconds) const;
+
+    static TempoMap constant(double bpm);
+
+    // A Standard MIDI File (tempo meta events of all tracks) or a text file of
+    // "<seconds> <bpm>" lines (commas allowed, # comments). Replaces points.
+    bool load(const std::string& path, std::string* error = nullptr);
+
+    // Note value per LFO cycle, in quarter notes: "1" whole (4), "1/2" .. "1/64",
+    // "2" two bars; a trailing "." is dotted (x1.5), "t" a triplet (x2/3)
+    static bool parseDivision(const std::string& s, double& beatsPerCycle);
+};
@@ -0,0 +1,82 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Minimal fixed-size worker pool: submit() queues a task, wait() blocks until
+// every queued task has finished. Tasks must not throw.
+struct ThreadPool {
+    explicit ThreadPool(unsigned threads = 0) {
+        created_.fetch_add(1, std::memory_order_relaxed);
+        if (threads == 0) threads = defaultThreads();
+        for (unsigned i = 0; i < threads; ++i) workers_.emplace_back([this]{ loop(); });
+    }
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto& t : workers_) t.join();
+    }
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(m_);
+            tasks_.push_back(std::move(task));
+            ++pending_;
+        }
+        cv_.notify_one();
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(m_);
+        done_.wait(lock, [this]{ return pending_ == 0; });
+    }
+
+    size_t size() const { return workers_.size(); }
+
+    // Pools constructed so far in this process (checks for nested pools)
+    static uint64_t created() { return created_.load(std::memory_order_relaxed); }
+
+    static unsigned defaultThreads() {
+        unsigned n = std::thread::hardware_concurrency();
+        return n ? n : 1;
+    }
+
+private:
+    void loop() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(m_);
+                cv_.wait(lock, [this]{ return stop_ || !tasks_.empty(); });
+                if (tasks_.empty()) return; // stop_ and drained
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+            task();
+            {
+                std::lock_guard<std::mutex> lock(m_);
+                if (--pending_ == 0) done_.notify_all();
+            }
+        }
+    }
+
+    static inline std::atomic<uint64_t> created_{0};
+
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> tasks_;
+    std::mutex m_;
+    std::condition_variable cv_;
+    std::condition_variable done_;
+    size_t pending_ = 0;
+    bool stop_ = false;
+};
@@ -1,107 +1,513 @@
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
-
-#include "Tremolo.h"
-#include <algorithm>
-#include <cmath>
-#include <cctype>
-
-static inline float clamp01(float x){ return std::max(0.f, std::min(1.f, x)); }
-static inline float clamp11(float x){ return std::max(-1.f, std::min(1.f, x)); }
-
-void Tremolo::setSampleRate(double fs) {
-    sr_ = fs > 0.0 ? fs : 48000.0;
-    depthSm_.setSampleRate(sr_);
-    rateSm_.setSampleRate(sr_);
-    depthSm_.setTimeConstant(0.01f);
-    rateSm_.setTimeConstant(0.01f);
-    depthSm_.reset(depth_);
-    rateSm_.reset(rateHz_);
-    phaseInc_ = float(rateHz_ / sr_);
-}
-
-void Tremolo::setDepth(float d)   { depth_ = clamp01(d); }
-void Tremolo::setRateHz(float r)  { rateHz_ = std::max(0.0001f, r); }
-void Tremolo::setWet(float w)     { wet_ = clamp01(w); }
-void Tremolo::setStereoPhaseDeg(float deg) {
-    float d = std::max(0.f, std::min(180.f, deg));
-    stereoPhaseR_ = d / 360.f; // convert deg to [0..0.5] cycles; 180deg -> 0.5
-}
-void Tremolo::setShape(LFOShape s){ shape_ = s; }
-
-LFOShape Tremolo::parseShape(const std::string& s) {
-    auto lower = s; for (auto& c : lower) c = char(std::tolower(c));
-    if (lower == "sine") return LFOShape::Sine;
-    if (lower == "triangle") return LFOShape::Triangle;
-    if (lower == "square") return LFOShape::Square;
-    if (lower == "square-soft") return LFOShape::SquareSoft;
-    return LFOShape::Sine;
-}
-
-// Waveforms return lfo in [0..1]
-inline float Tremolo::lfoSine(float ph) const {
-    return 0.5f * (1.0f + std::sin(2.0f * float(M_PI) * ph));
-}
-inline float Tremolo::lfoTriangle(float ph) const {
-    float t = std::fmod(ph, 1.0f);
-    float tri = (t < 0.5f) ? (t * 4.0f - 1.0f) : (3.0f - t * 4.0f); // -1..1
-    return 0.5f * (tri + 1.0f);
-}
-inline float Tremolo::lfoSquare(float ph) const {
-    float s = std::sin(2.0f * float(M_PI) * ph);
-    return s >= 0.0f ? 1.0f : 0.0f;
-}
-inline float Tremolo::lfoSquareSoft(float ph) const {
-    // "soft" square via tanh(k * sin), k=3 gives rounded corners
-    float s = std::sin(2.0f * float(M_PI) * ph);
-    float y = std::tanh(3.0f * s); // -1..1
-    return 0.5f * (y + 1.0f);
-}
-
-void Tremolo::process(float* interleaved, size_t frames, int channels) {
-    if (!interleaved || channels < 1) return;
-    const float tiny = 1e-20f;
-
-    for (size_t i = 0; i < frames; ++i) {
-        float rateNow = rateSm_.process(rateHz_);
-        phaseInc_ = std::max(1e-9f, float(rateNow / sr_));
-        float dNow = depthSm_.process(depth_);
-
-        float phL = phase_;
-        float phR = std::fmod(phase_ + stereoPhaseR_, 1.0f);
-
-        float lfoL, lfoR;
-        switch (shape_) {
-            case LFOShape::Triangle:   lfoL = lfoTriangle(phL); lfoR = lfoTriangle(phR); break;
-            case LFOShape::Square:     lfoL = lfoSquare(phL);   lfoR = lfoSquare(phR);   break;
-            case LFOShape::SquareSoft: lfoL = lfoSquareSoft(phL); lfoR = lfoSquareSoft(phR); break;
-            default:                   lfoL = lfoSine(phL);     lfoR = lfoSine(phR);     break;
-        }
-
-        float gainL = 1.0f - dNow * lfoL;
-        float gainR = 1.0f - dNow * lfoR;
-
-        if (channels == 1) {
-            float x = interleaved[i] + tiny;
-            float wetSig = x * gainL;
-            float y = (1.0f - wet_) * x + wet_ * wetSig;
-            interleaved[i] = clamp11(y);
-        } else {
-            float* L = &interleaved[i * 2 + 0];
-            float* R = &interleaved[i * 2 + 1];
-            float xL = *L + tiny;
-            float xR = *R + tiny;
-            float wetL = xL * gainL;
-            float wetR = xR * gainR;
-            float yL = (1.0f - wet_) * xL + wet_ * wetL;
-            float yR = (1.0f - wet_) * xR + wet_ * wetR;
-            *L = clamp11(yL);
-            *R = clamp11(yR);
-        }
-
-        // advance phase per-sample
-        phase_ += phaseInc_;
-        if (phase_ >= 1.0f) phase_ -= 1.0f;
-    }
-}
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#include "Tremolo.h"
+#include "AllocCounter.h"
+#include "GainApply.h"
+#include <algorithm>
+#include <cmath>
+#include <cctype>
+#include <iterator>
+
+static inline float clamp01(float x){ return std::max(0.f, std::min(1.f, x)); }
+static inline float clamp11(float x){ return std::max(-1.f, std::min(1.f, x)); }
+
+// 0.64 fixed-point phase -> [0, 1): the top 24 bits convert exactly
+static inline float fixedPhase(uint64_t fx) { return float(uint32_t(fx >> 40)) * 0x1p-24f; }
+
+// 0.64 fixed-point increment -> cycles per sample
+static inline float fixedCycles(uint64_t inc) { return float(double(inc) * 0x1p-64); }
+
+// Fractional part of `cycles` in 0.64 fixed point
+static inline uint64_t toFixed(double cycles) {
+    cycles -= std::floor(cycles);
+    return uint64_t(cycles * 0x1p63) << 1;
+}
+
+// Smooths towards per-sample targets, one processBlock() per run of equal
+// targets (same values as process() per sample)
+static void smoothRuns(OnePoleSmoother& sm, const float* target, float* out, size_t n) {
+    for (size_t i = 0; i < n; ) {
+        size_t j = i + 1;
+        while (j < n && target[j] == target[i]) ++j;
+        if (sm.processBlock(target[i], out + i, j - i)) std::fill(out + i, out + j, sm.value());
+        i = j;
+    }
+}
+
+void Tremolo::setSampleRate(double fs) {
+    sr_ = fs > 0.0 ? fs : 48000.0;
+    depthSm_.setSampleRate(sr_);
+    rateSm_.setSampleRate(sr_);
+    depthSm_.setTimeConstant(0.01f);
+    rateSm_.setTimeConstant(0.01f);
+    depthSm_.reset(depth_);
+    rateSm_.reset(rateHz_);
+    phaseInc_ = float(rateHz_ / sr_);
+    phaseIncFx_ = fixedInc(rateHz_);
+    buildTempo();
+}
+
+void Tremolo::setTempoSync(const TempoMap& map, double beatsPerCycle) {
+    tempo_ = map;
+    beatsPerCycle_ = beatsPerCycle;
+    buildTempo();
+}
+
+// Anchors each tempo change at its first frame (frame f is at or past a
+// change at t iff f >= ceil(t * sr), as for automation): the exact beat
+// there, in cycles, and the per-frame increment until the next change
+void Tremolo::buildTempo() {
+    tempoSeg_.clear();
+    tempoCursor_ = 0;
+    if (tempo_.empty() || !(beatsPerCycle_ > 0.0)) return;
+    double beats = 0.0; // at points[k].timeSeconds
+    for (size_t k = 0; k < tempo_.points.size(); ++k) {
+        const TempoPoint& p = tempo_.points[k];
+        if (k > 0) {
+            const TempoPoint& q = tempo_.points[k - 1];
+            beats += (p.timeSeconds - q.timeSeconds) * q.bpm / 60.0;
+        }
+        const uint64_t frame = k == 0 ? 0 : uint64_t(std::max(0.0, std::ceil(p.timeSeconds * sr_)));
+        const double atFrame = beats + (double(frame) / sr_ - p.timeSeconds) * p.bpm / 60.0;
+        const TempoSegment seg{frame, toFixed(atFrame / beatsPerCycle_),
+                               toFixed(p.bpm / (60.0 * sr_ * beatsPerCycle_))};
+        if (!tempoSeg_.empty() && tempoSeg_.back().frame == frame) tempoSeg_.back() = seg;
+        else tempoSeg_.push_back(seg);
+    }
+}
+
+// Fixed-point phase at `frame`, from the segment containing it
+uint64_t Tremolo::tempoPhaseAt(uint64_t frame) {
+    while (tempoCursor_ + 1 < tempoSeg_.size() && tempoSeg_[tempoCursor_ + 1].frame <= frame) ++tempoCursor_;
+    while (tempoCursor_ > 0 && tempoSeg_[tempoCursor_].frame > frame) --tempoCursor_;
+    const TempoSegment& s = tempoSeg_[tempoCursor_];
+    return s.phaseFx + (frame - s.frame) * s.inc; // mod 2^64, exact
+}
+
+// phase[i] for frames frame_ .. frame_ + n - 1, one run per tempo segment
+void Tremolo::tempoPhase(float* phase, size_t n) {
+    for (size_t i = 0; i < n; ) {
+        const uint64_t f = frame_ + i;
+        uint64_t fx = tempoPhaseAt(f);
+        const TempoSegment& s = tempoSeg_[tempoCursor_];
+        size_t run = n - i;
+        if (tempoCursor_ + 1 < tempoSeg_.size())
+            run = size_t(std::min<uint64_t>(run, tempoSeg_[tempoCursor_ + 1].frame - f));
+        for (size_t j = 0; j < run; ++j) {
+            phase[i + j] = fixedPhase(fx);
+            fx += s.inc;
+        }
+        std::fill(incRamp_ + i, incRamp_ + i + run, fixedCycles(s.inc));
+        phaseFx_ = fx;
+        phaseIncFx_ = s.inc;
+        i += run;
+    }
+    phase_ = fixedPhase(phaseFx_);
+}
+
+void Tremolo::setPhaseMode(PhaseMode m) {
+    if (m == phaseMode_) return;
+    if (m == PhaseMode::Fixed) {
+        phaseFx_ = uint64_t(std::ldexp(double(phase_), 64)); // phase_ < 1, exact
+        phaseIncFx_ = fixedInc(rateSm_.value());
+    }
+    phaseMode_ = m;
+}
+
+// Cycles per sample in 0.64 fixed point, from the double rate / sr (integer
+// parts of a cycle wrap away)
+uint64_t Tremolo::fixedInc(float rateHz) const {
+    double c = std::max(1e-9, double(rateHz) / sr_);
+    if (c >= 1.0) c -= std::floor(c);
+    return uint64_t(c * 0x1p63) << 1;
+}
+
+void Tremolo::setDepth(float d)   { depth_ = clamp01(d); }
+void Tremolo::setRateHz(float r)  { rateHz_ = std::max(0.0001f, r); }
+void Tremolo::setWet(float w)     { wet_ = clamp01(w); }
+void Tremolo::setStereoPhaseDeg(float deg) {
+    float d = std::max(0.f, std::min(180.f, deg));
+    stereoPhaseR_ = d / 360.f; // convert deg to [0..0.5] cycles; 180deg -> 0.5
+}
+void Tremolo::setChannelPhaseDeg(const float* deg, size_t count) {
+    chanOffset_.clear();
+    for (size_t c = 0; c < count && deg; ++c) {
+        float d = std::fmod(deg[c], 360.f);
+        if (d < 0.f) d += 360.f;
+        chanOffset_.push_back(d / 360.f);
+    }
+    mappedChannels_ = 0;
+}
+
+void Tremolo::setShape(LFOShape s){ shape_ = s; }
+void Tremolo::setAccuracy(LFOAccuracy a){ accuracy_ = a; }
+void Tremolo::setAutomation(const Automation& a) {
+    automation_ = a;
+    automated_ = !a.empty();
+    std::fill(std::begin(laneCursor_), std::end(laneCursor_), size_t(0));
+}
+
+LFOShape Tremolo::parseShape(const std::string& s) {
+    auto lower = s; for (auto& c : lower) c = char(std::tolower(c));
+    if (lower == "sine") return LFOShape::Sine;
+    if (lower == "triangle") return LFOShape::Triangle;
+    if (lower == "square") return LFOShape::Square;
+    if (lower == "square-soft") return LFOShape::SquareSoft;
+    if (lower == "square-bl") return LFOShape::SquareBL;
+    if (lower == "triangle-bl") return LFOShape::TriangleBL;
+    return LFOShape::Sine;
+}
+
+const char* Tremolo::shapeName(LFOShape s) {
+    switch (s) {
+        case LFOShape::Triangle:   return "triangle";
+        case LFOShape::Square:     return "square";
+        case LFOShape::SquareSoft: return "square-soft";
+        case LFOShape::SquareBL:   return "square-bl";
+        case LFOShape::TriangleBL: return "triangle-bl";
+        default:                   return "sine";
+    }
+}
+
+PhaseMode Tremolo::parsePhaseMode(const std::string& s) {
+    auto lower = s; for (auto& c : lower) c = char(std::tolower(c));
+    return lower == "fixed" ? PhaseMode::Fixed : PhaseMode::Float;
+}
+
+const char* Tremolo::phaseModeName(PhaseMode m) {
+    return m == PhaseMode::Fixed ? "fixed" : "float";
+}
+
+Tremolo::State Tremolo::state() const {
+    State s;
+    s.phase = phase_;
+    s.phaseInc = phaseInc_;
+    s.phaseFx = phaseFx_;
+    s.phaseIncFx = phaseIncFx_;
+    s.depth = depthSm_.state();
+    s.rate = rateSm_.state();
+    s.frame = frame_;
+    return s;
+}
+
+void Tremolo::setState(const State& s) {
+    phase_ = s.phase;
+    phaseInc_ = s.phaseInc;
+    phaseFx_ = s.phaseFx;
+    phaseIncFx_ = s.phaseIncFx;
+    depthSm_.setState(s.depth);
+    rateSm_.setState(s.rate);
+    frame_ = s.frame;
+}
+
+void Tremolo::advance(uint64_t frames) {
+    // walk the same ramps process() renders until both smoothers settle
+    uint64_t done = 0;
+    auto rateMoving = [&] {
+        return !tempoSynced() && (!rateSm_.settled() || rateSm_.state().target != rateHz_);
+    };
+    while (done < frames && (automated_ || rateMoving() || !depthSm_.settled() || depthSm_.state().target != depth_)) {
+        const size_t n = size_t(std::min<uint64_t>(GainBlock, frames - done));
+        rampBlock(n, gainL_);
+        done += n;
+    }
+    if (done == frames) return;
+    // settled on fixed targets: only the phase moves now
+    const float inc = std::max(1e-9f, float(rateSm_.value() / sr_));
+    phaseInc_ = inc;
+    frame_ += frames - done;
+    if (tempoSynced()) {
+        phaseFx_ = tempoPhaseAt(frame_);
+        phase_ = fixedPhase(phaseFx_);
+        return;
+    }
+    if (phaseMode_ == PhaseMode::Fixed) {
+        phaseIncFx_ = fixedInc(rateSm_.value());
+        phaseFx_ += phaseIncFx_ * (frames - done); // mod 2^64, exact
+        phase_ = fixedPhase(phaseFx_);
+        return;
+    }
+    for (uint64_t i = done; i < frames; ++i) {
+        phase_ += inc;
+        if (phase_ >= 1.0f) phase_ -= 1.0f;
+    }
+}
+
+void Tremolo::processReference(float* interleaved, size_t frames, int channels) {
+    if (!interleaved || channels < 1) return;
+    const float tiny = 1e-20f;
+    const bool table = !chanOffset_.empty() && channels <= GainApply::MaxChannels;
+
+    for (size_t i = 0; i < frames; ++i) {
+        // automation: each lane's value at this frame, else the setter's
+        auto laneAt = [&](AutoParam p, float fallback) {
+            const AutomationLane& lane = automation_.lane(p);
+            return !automated_ || lane.empty() ? fallback : lane.valueAt(double(frame_ + i) / sr_);
+        };
+        float rateNow = tempoSynced() ? rateSm_.value() : rateSm_.process(laneAt(AutoParam::Rate, rateHz_));
+        phaseInc_ = std::max(1e-9f, float(rateNow / sr_));
+        float dNow = depthSm_.process(laneAt(AutoParam::Depth, depth_));
+        const float wet = laneAt(AutoParam::Wet, wet_);
+        const float stereo = automated_ && automation_.has(AutoParam::StereoPhase)
+                           ? laneAt(AutoParam::StereoPhase, 0.0f) / 360.0f : stereoPhaseR_;
+
+        const bool fixed = phaseMode_ == PhaseMode::Fixed;
+        if (tempoSynced()) phaseFx_ = tempoPhaseAt(frame_ + i);
+        else if (fixed) phaseIncFx_ = fixedInc(rateNow);
+        float phL = tempoSynced() || fixed ? fixedPhase(phaseFx_) : phase_;
+        float phR = std::fmod(phL + stereo, 1.0f);
+        const float dt = tempoSynced() ? fixedCycles(tempoSeg_[tempoCursor_].inc)
+                       : fixed ? fixedCycles(phaseIncFx_) : phaseInc_;
+
+        auto lfoAt = [&](float ph) {
+            switch (shape_) {
+                case LFOShape::SquareBL:   return Lfo::squareBlep(ph, dt);
+                case LFOShape::TriangleBL: return Lfo::triangleBlamp(ph, dt);
+                case LFOShape::Triangle:   return Lfo::triangle(ph);
+                case LFOShape::Square:     return Lfo::square(ph);
+                case LFOShape::SquareSoft: return Lfo::squareSoft(ph);
+                default:                   return Lfo::sine(ph);
+            }
+        };
+        float gainL = 1.0f - dNow * lfoAt(phL);
+        float gainR = channels > 1 ? 1.0f - dNow * lfoAt(phR) : gainL;
+
+        // even channels follow the left phase, odd ones the right, unless
+        // the phase table gives each channel its own offset (as process())
+        float* frame = interleaved + i * size_t(channels);
+        for (int c = 0; c < channels; ++c) {
+            float gain = (c & 1) ? gainR : gainL;
+            if (table) {
+                const float off = size_t(c) < chanOffset_.size() ? chanOffset_[size_t(c)] : 0.0f;
+                gain = off == 0.0f ? gainL : 1.0f - dNow * lfoAt(std::fmod(phL + off, 1.0f));
+            }
+            float x = frame[c] + tiny;
+            float y = (1.0f - wet) * x + wet * (x * gain);
+            frame[c] = clamp11(y);
+        }
+
+        // advance phase per-sample
+        if (tempoSynced()) {
+            phaseFx_ = tempoPhaseAt(frame_ + i + 1);
+            phase_ = fixedPhase(phaseFx_);
+        } else if (fixed) {
+            phaseFx_ += phaseIncFx_;
+            phase_ = fixedPhase(phaseFx_);
+        } else {
+            phase_ += phaseInc_;
+            if (phase_ >= 1.0f) phase_ -= 1.0f;
+        }
+    }
+    frame_ += frames;
+}
+
+// Lane values for the next n frames, or `fallback` if the lane is empty
+void Tremolo::renderLane(AutoParam p, float fallback, float* out, size_t n) {
+    const AutomationLane& lane = automation_.lane(p);
+    if (lane.empty()) std::fill(out, out + n, fallback);
+    else lane.render(frame_, sr_, out, n, laneCursor_[size_t(p)]);
+}
+
+// Smoothed depth (depthRamp_) and LFO phase (phase[]) for the next n <=
+// GainBlock frames; advances smoothers, phase and the frame clock. With
+// automation the smoother targets come from the lanes per sample, and the
+// wet/stereo-phase ramps are rendered alongside.
+void Tremolo::rampBlock(size_t n, float* phase) {
+    if (!automated_) {
+        // fixed targets: closed-form ramps, constants once settled
+        if (depthSm_.processBlock(depth_, depthRamp_, n))
+            std::fill(depthRamp_, depthRamp_ + n, depthSm_.value());
+        if (tempoSynced()) {
+            tempoPhase(phase, n);
+        } else if (rateSm_.processBlock(rateHz_, rateRamp_, n)) {
+            phaseInc_ = std::max(1e-9f, float(rateSm_.value() / sr_));
+            phaseIncFx_ = fixedInc(rateSm_.value());
+            stepPhase(phase, nullptr, n);
+        } else {
+            stepPhase(phase, rateRamp_, n);
+        }
+        frame_ += n;
+        return;
+    }
+
+    renderLane(AutoParam::Depth, depth_, depthTarget_, n);
+    smoothRuns(depthSm_, depthTarget_, depthRamp_, n);
+    if (tempoSynced()) {
+        tempoPhase(phase, n);
+    } else {
+        renderLane(AutoParam::Rate, rateHz_, rateTarget_, n);
+        smoothRuns(rateSm_, rateTarget_, rateRamp_, n);
+        stepPhase(phase, rateRamp_, n);
+    }
+    if (automation_.has(AutoParam::Wet)) renderLane(AutoParam::Wet, wet_, wetRamp_, n);
+    if (automation_.has(AutoParam::StereoPhase)) {
+        renderLane(AutoParam::StereoPhase, 0.0f, stereoRamp_, n);
+        for (size_t i = 0; i < n; ++i) stereoRamp_[i] = stereoRamp_[i] / 360.f;
+    }
+    frame_ += n;
+}
+
+// phase[i] = LFO phase of the next n frames, then advances the accumulator.
+// rate[i] is each frame's smoothed rate, or null to keep the current
+// increment (phaseInc_ / phaseIncFx_).
+void Tremolo::stepPhase(float* phase, const float* rate, size_t n) {
+    if (phaseMode_ == PhaseMode::Fixed) {
+        uint64_t fx = phaseFx_, inc = phaseIncFx_;
+        if (rate) {
+            for (size_t i = 0; i < n; ++i) {
+                inc = fixedInc(rate[i]);
+                incRamp_[i] = fixedCycles(inc);
+                phase[i] = fixedPhase(fx);
+                fx += inc;
+            }
+        } else {
+            for (size_t i = 0; i < n; ++i) {
+                phase[i] = fixedPhase(fx);
+                fx += inc;
+            }
+            std::fill(incRamp_, incRamp_ + n, fixedCycles(inc));
+        }
+        if (rate && n) phaseInc_ = std::max(1e-9f, float(rate[n - 1] / sr_));
+        phaseFx_ = fx;
+        phaseIncFx_ = inc;
+        phase_ = fixedPhase(fx);
+        return;
+    }
+    if (!rate) {
+        const float inc = phaseInc_;
+        for (size_t i = 0; i < n; ++i) {
+            phase[i] = phase_;
+            phase_ += inc;
+            if (phase_ >= 1.0f) phase_ -= 1.0f;
+        }
+        std::fill(incRamp_, incRamp_ + n, inc);
+        return;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        phaseInc_ = std::max(1e-9f, float(rate[i] / sr_));
+        incRamp_[i] = phaseInc_;
+        phase[i] = phase_;
+        phase_ += phaseInc_;
+        if (phase_ >= 1.0f) phase_ -= 1.0f;
+    }
+}
+
+// Per-sample wet: mix into the gains (y = x * (1 - w + w * g)); the caller
+// then applies them with wet = 1
+void Tremolo::foldWet(float* g, size_t n) const {
+    for (size_t i = 0; i < n; ++i) g[i] = 1.0f - wetRamp_[i] + wetRamp_[i] * g[i];
+}
+
+// Fills gainL_/gainR_ for the next n frames and advances smoothers/phase
+// exactly as processReference() does per frame: first the smoothed depth
+// and phase ramps, then one LFO pass per channel, then the gains.
+template <bool Stereo>
+void Tremolo::renderGains(size_t n, Lfo::Kernel lfo) {
+    float* phL = gainL_;
+    float* phR = gainR_;
+    rampBlock(n, phL);
+    if constexpr (Stereo) {
+        if (automated_ && automation_.has(AutoParam::StereoPhase)) {
+            for (size_t i = 0; i < n; ++i) phR[i] = std::fmod(phL[i] + stereoRamp_[i], 1.0f);
+        } else {
+            for (size_t i = 0; i < n; ++i) phR[i] = std::fmod(phL[i] + stereoPhaseR_, 1.0f);
+        }
+    }
+
+    // phases -> lfo [0..1] in place
+    lfo(phL, incRamp_, gainL_, n);
+    if constexpr (Stereo) lfo(phR, incRamp_, gainR_, n);
+
+    for (size_t i = 0; i < n; ++i) gainL_[i] = 1.0f - depthRamp_[i] * gainL_[i];
+    if constexpr (Stereo) {
+        for (size_t i = 0; i < n; ++i) gainR_[i] = 1.0f - depthRamp_[i] * gainR_[i];
+    }
+    if (wetAutomated()) {
+        foldWet(gainL_, n);
+        if constexpr (Stereo) foldWet(gainR_, n);
+    }
+}
+
+// Channels: 1 = mono, 2 = interleaved stereo, 0 = any other count
+template <int Channels>
+void Tremolo::processLayout(float* interleaved, size_t frames, int channels) {
+    const Lfo::Kernel lfo = Lfo::kernel(shape_, accuracy_);
+    const size_t stride = size_t(channels);
+    const float wet = wetAutomated() ? 1.0f : wet_;
+
+    for (size_t done = 0; done < frames; ) {
+        const size_t n = std::min(GainBlock, frames - done);
+        float* x = interleaved + done * stride;
+        renderGains<Channels != 1>(n, lfo);
+        if constexpr (Channels == 1)      GainApply::mono(x, gainL_, n, wet);
+        else if constexpr (Channels == 2) GainApply::stereo(x, gainL_, gainR_, n, wet);
+        else                              GainApply::interleaved(x, gainL_, gainR_, n, channels, wet);
+        done += n;
+    }
+}
+
+// Groups channels by phase offset; allocates only when the layout changes
+void Tremolo::mapChannels(int channels) {
+    distinctOffsets_.clear();
+    chanRow_.assign(size_t(channels), 0);
+    for (int c = 0; c < channels; ++c) {
+        const float off = size_t(c) < chanOffset_.size() ? chanOffset_[size_t(c)] : 0.0f;
+        size_t k = 0;
+        while (k < distinctOffsets_.size() && distinctOffsets_[k] != off) ++k;
+        if (k == distinctOffsets_.size()) distinctOffsets_.push_back(off);
+        chanRow_[size_t(c)] = k;
+    }
+    tableGains_.assign(distinctOffsets_.size() * GainBlock, 0.0f);
+    mappedChannels_ = channels;
+}
+
+// Phase-table layout: one smoother/phase ramp, one LFO pass per distinct
+// offset, then each channel takes its offset's gains
+void Tremolo::processTable(float* interleaved, size_t frames, int channels) {
+    const Lfo::Kernel lfo = Lfo::kernel(shape_, accuracy_);
+    const size_t stride = size_t(channels);
+    float* rows = tableGains_.data();
+    const float* chanGain[GainApply::MaxChannels];
+    const float wet = wetAutomated() ? 1.0f : wet_;
+
+    for (size_t done = 0; done < frames; ) {
+        const size_t n = std::min(GainBlock, frames - done);
+        rampBlock(n, gainL_);
+        for (size_t k = 0; k < distinctOffsets_.size(); ++k) {
+            float* g = rows + k * GainBlock;
+            const float off = distinctOffsets_[k];
+            if (off == 0.0f) std::copy(gainL_, gainL_ + n, g);
+            else for (size_t i = 0; i < n; ++i) g[i] = std::fmod(gainL_[i] + off, 1.0f);
+            lfo(g, incRamp_, g, n);
+            for (size_t i = 0; i < n; ++i) g[i] = 1.0f - depthRamp_[i] * g[i];
+            if (wetAutomated()) foldWet(g, n);
+        }
+        for (int c = 0; c < channels; ++c) chanGain[c] = rows + chanRow_[size_t(c)] * GainBlock;
+        GainApply::perChannel(interleaved + done * stride, chanGain, n, channels, wet);
+        done += n;
+    }
+}
+
+void Tremolo::prepare(int channels) {
+    if (!chanOffset_.empty() && channels >= 1 && channels <= GainApply::MaxChannels &&
+        channels != mappedChannels_)
+        mapChannels(channels);
+}
+
+void Tremolo::process(float* interleaved, size_t frames, int channels) {
+    if (!interleaved || channels < 1) return;
+    prepare(channels);
+    SMART_TREMOLO_NO_ALLOC_SCOPE("Tremolo::process");
+    // (layouts wider than GainApply::MaxChannels keep the even/odd rule)
+    if (!chanOffset_.empty() && channels <= GainApply::MaxChannels) {
+        processTable(interleaved, frames, channels);
+        return;
+    }
+    switch (channels) {
+        case 1:  processLayout<1>(interleaved, frames, channels); break;
+        case 2:  processLayout<2>(interleaved, frames, channels); break;
+        default: processLayout<0>(interleaved, frames, channels); break;
+    }
+}
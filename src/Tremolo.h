@@ -1,39 +1,159 @@
-#pragma once
-#include <string>
-#include <cstdint>
-#include "OnePoleSmoother.h"
-
-enum class LFOShape { Sine, Triangle, Square, SquareSoft };
-
-struct Tremolo {
-    void setSampleRate(double fs);
-    void setDepth(float d);        // [0..1]
-    void setRateHz(float r);       // >0
-    void setWet(float w);          // [0..1]
-    void setStereoPhaseDeg(float deg); // [0..180]
-    void setShape(LFOShape s);
-
-    // Process in-place float buffers [-1..1]. Supports mono or stereo.
-    void process(float* interleaved, size_t frames, int channels);
-
-    // Utility:
-    static LFOShape parseShape(const std::string& s);
-
-private:
-    inline float lfoSine(float ph) const;
-    inline float lfoTriangle(float ph) const;
-    inline float lfoSquare(float ph) const;
-    inline float lfoSquareSoft(float ph) const;
-
-    double sr_ = 48000.0;
-    float rateHz_ = 5.0f;
-    float depth_ = 0.6f;
-    float wet_ = 1.0f;
-    float phase_ = 0.0f;           // [0..1)
-    float phaseInc_ = 0.0f;        // delta per sample
-    float stereoPhaseR_ = 0.0f;    // right-channel phase offset [0..1)
-    LFOShape shape_ = LFOShape::Sine;
-
-    OnePoleSmoother depthSm_;
-    OnePoleSmoother rateSm_;
-};
+#pragma once
+#include <string>
+#include <cstdint>
+#include <vector>
+#include "OnePoleSmoother.h"
+#include "Lfo.h"
+#include "Automation.h"
+#include "TempoMap.h"
+
+// LFO phase accumulator. Float keeps the original float phase and per-sample
+// float increment. Fixed is a 0.64 fixed-point accumulator (one cycle = 2^64,
+// wrap is integer overflow): sums are exact, so phase never drifts however
+// long the render, and advance() jumps settled stretches in O(1).
+enum class PhaseMode { Float, Fixed };
+
+struct Tremolo {
+    void setSampleRate(double fs);
+    void setDepth(float d);        // [0..1]
+    void setRateHz(float r);       // >0
+    void setWet(float w);          // [0..1]
+    void setStereoPhaseDeg(float deg); // [0..180]
+    // Per-channel LFO phase offsets in degrees [0..360), channel c taking
+    // deg[c] (channels past the table use 0). Replaces the stereo layout
+    // (even = 0, odd = stereo phase) until cleared with count == 0.
+    void setChannelPhaseDeg(const float* deg, size_t count);
+    bool hasChannelPhases() const { return !chanOffset_.empty(); }
+    void setShape(LFOShape s);
+    void setAccuracy(LFOAccuracy a); // LFO evaluation mode (Exact by default)
+    void setPhaseMode(PhaseMode m);  // Float by default; switching keeps the phase
+    PhaseMode phaseMode() const { return phaseMode_; }
+
+    // Breakpoint lanes (rate, depth, wet, stereo phase) on the stream's frame
+    // clock: process() renders them into per-sample ramps, so moves are
+    // sample-accurate. A lane overrides its setter; rate/depth still run
+    // through the smoothers. An empty Automation turns this off.
+    void setAutomation(const Automation& a);
+    const Automation& automation() const { return automation_; }
+
+    // Locks the LFO to a tempo map: one cycle per `beatsPerCycle` quarter
+    // notes, phase 0 on beat 0 of the stream's frame clock. The phase is a
+    // function of the frame (fixed point, anchored at each tempo change), so
+    // it holds the grid over any length and split. Overrides the rate, its
+    // smoother and a rate lane. An empty map (or beatsPerCycle <= 0) turns
+    // it off.
+    void setTempoSync(const TempoMap& map, double beatsPerCycle);
+    bool tempoSynced() const { return !tempoSeg_.empty(); }
+
+    // Process in-place float buffers [-1..1]. Supports mono, stereo or N
+    // interleaved channels (odd channels follow the right/offset phase, or
+    // each channel its entry of the phase table). Channels sharing an offset
+    // share one LFO evaluation. Dispatches once per call to a loop
+    // specialized for the LFO shape and channel layout; renders per-block
+    // gain arrays, then applies gain/mix/clamp with SIMD.
+    void process(float* interleaved, size_t frames, int channels);
+
+    // Sizes the per-channel tables for `channels` up front, so process() on
+    // that layout never allocates (it otherwise does on the first call after
+    // setChannelPhaseDeg)
+    void prepare(int channels);
+
+    // Original per-frame scalar implementation, kept as the reference the
+    // block path is checked against (same state, same results within float eps)
+    // for any channel count, the even/odd layout or the phase table. Automation
+    // lanes are evaluated per frame (valueAt) into the same smoothers.
+    void processReference(float* interleaved, size_t frames, int channels);
+
+    // Snapshot of everything that evolves per frame. With fixed parameters a
+    // render can be split anywhere and resumed from a State bit-exactly.
+    struct State {
+        float phase = 0.0f;
+        float phaseInc = 0.0f;
+        uint64_t phaseFx = 0;    // PhaseMode::Fixed accumulator and increment
+        uint64_t phaseIncFx = 0;
+        OnePoleSmoother::State depth; // smoother ramps
+        OnePoleSmoother::State rate;
+        uint64_t frame = 0; // automation clock
+    };
+    State state() const;
+    void setState(const State& s);
+
+    // Advances smoothers and phase by `frames` exactly as process() would,
+    // without evaluating the LFO or touching audio
+    void advance(uint64_t frames);
+
+    // Utility:
+    static LFOShape parseShape(const std::string& s);
+    static const char* shapeName(LFOShape s);
+    static PhaseMode parsePhaseMode(const std::string& s); // float|fixed
+    static const char* phaseModeName(PhaseMode m);
+
+private:
+    double sr_ = 48000.0;
+    float rateHz_ = 5.0f;
+    float depth_ = 0.6f;
+    float wet_ = 1.0f;
+    float phase_ = 0.0f;           // [0..1)
+    float phaseInc_ = 0.0f;        // delta per sample
+    float stereoPhaseR_ = 0.0f;    // right-channel phase offset [0..1)
+    PhaseMode phaseMode_ = PhaseMode::Float;
+    uint64_t phaseFx_ = 0;         // Fixed: phase_ is derived from these
+    uint64_t phaseIncFx_ = 0;
+    LFOShape shape_ = LFOShape::Sine;
+    LFOAccuracy accuracy_ = LFOAccuracy::Exact;
+
+    OnePoleSmoother depthSm_;
+    OnePoleSmoother rateSm_;
+
+    // Per-block gain scratch (frames per block render)
+    static constexpr size_t GainBlock = 256;
+    void rampBlock(size_t n, float* phase);
+    void stepPhase(float* phase, const float* rate, size_t n);
+    uint64_t fixedInc(float rateHz) const;
+    void buildTempo();
+    uint64_t tempoPhaseAt(uint64_t frame);
+    void tempoPhase(float* phase, size_t n);
+    void renderLane(AutoParam p, float fallback, float* out, size_t n);
+    bool wetAutomated() const { return automated_ && automation_.has(AutoParam::Wet); }
+    void foldWet(float* g, size_t n) const;
+    template <bool Stereo> void renderGains(size_t n, Lfo::Kernel lfo);
+    template <int Channels> void processLayout(float* interleaved, size_t frames, int channels);
+    void processTable(float* interleaved, size_t frames, int channels);
+    void mapChannels(int channels);
+    alignas(32) float gainL_[GainBlock];
+    alignas(32) float gainR_[GainBlock];
+    alignas(32) float depthRamp_[GainBlock];
+    alignas(32) float incRamp_[GainBlock]; // phase increment per frame (band-limited shapes)
+
+    // Automation: lanes, per-lane segment cursors, frame clock and the
+    // per-block target/ramp buffers rendered from them
+    Automation automation_;
+    bool automated_ = false;
+    size_t laneCursor_[size_t(AutoParam::Count)] = {};
+    uint64_t frame_ = 0;
+    alignas(32) float rateRamp_[GainBlock];
+    alignas(32) float rateTarget_[GainBlock];
+    alignas(32) float depthTarget_[GainBlock];
+    alignas(32) float wetRamp_[GainBlock];
+    alignas(32) float stereoRamp_[GainBlock]; // cycles
+
+    // Tempo sync: constant-tempo stretches from their first frame, with the
+    // 0.64 fixed-point phase there and the increment per frame
+    struct TempoSegment {
+        uint64_t frame;
+        uint64_t phaseFx;
+        uint64_t inc;
+    };
+    TempoMap tempo_;
+    double beatsPerCycle_ = 0.0;
+    std::vector<TempoSegment> tempoSeg_;
+    size_t tempoCursor_ = 0;
+
+    // Phase table: per-channel offset (cycles), the distinct offsets, and
+    // for the last channel count seen, each channel's row in tableGains_
+    std::vector<float> chanOffset_;
+    std::vector<float> distinctOffsets_;
+    std::vector<size_t> chanRow_;
+    std::vector<float> tableGains_; // distinctOffsets_.size() x GainBlock
+    int mappedChannels_ = 0;
+};
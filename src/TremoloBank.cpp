@@ -0,0 +1,324 @@
+#include "TremoloBank.h"
+#include "AllocCounter.h"
+#include "GainApply.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__AVX__)
+#define BANK_AVX 1
+#include <immintrin.h>
+static constexpr size_t kLanes = 8;
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BANK_SSE 1
+#include <emmintrin.h>
+static constexpr size_t kLanes = 4;
+#else
+static constexpr size_t kLanes = 4; // scalar lanes (NEON has no 4-wide double divide on ARMv7)
+#endif
+
+static inline float clamp01(float x){ return std::max(0.f, std::min(1.f, x)); }
+
+size_t TremoloBank::lanes() { return kLanes; }
+
+const char* TremoloBank::simdName() {
+#if defined(BANK_AVX)
+    return "avx";
+#elif defined(BANK_SSE)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+TremoloBank::TremoloBank(size_t voices) {
+    setSampleRate(48000.0);
+    resize(voices);
+}
+
+// Tremolo defaults, with the smoothers settled as after setSampleRate()
+void TremoloBank::resetSlot(size_t s) {
+    rateHz_[s] = 5.0f;
+    depth_[s] = 0.6f;
+    wet_[s] = 1.0f;
+    stereoPhaseR_[s] = 0.0f;
+    shape_[s] = LFOShape::Sine;
+    phase_[s] = 0.0f;
+    phaseInc_[s] = float(5.0f / sr_);
+    depthSm_[s] = OnePoleSmoother::State::at(0.6f);
+    rateSm_[s] = OnePoleSmoother::State::at(5.0f);
+}
+
+void TremoloBank::resize(size_t voices) {
+    // back to identity order so voice v lives in slot v
+    std::vector<size_t> identity(voices_);
+    for (size_t v = 0; v < voices_; ++v) identity[v] = v;
+    permute(identity);
+
+    const size_t padded = (voices + kLanes - 1) / kLanes * kLanes;
+    for (auto* a : {&rateHz_, &depth_, &wet_, &stereoPhaseR_, &phase_, &phaseInc_})
+        a->resize(padded);
+    depthSm_.resize(padded);
+    rateSm_.resize(padded);
+    shape_.resize(padded);
+    for (size_t s = voices_; s < padded; ++s) resetSlot(s);
+
+    voices_ = voices;
+    slotOf_.resize(voices);
+    voiceAt_.resize(voices);
+    for (size_t v = 0; v < voices; ++v) slotOf_[v] = voiceAt_[v] = v;
+    regroup_ = true;
+}
+
+void TremoloBank::permute(const std::vector<size_t>& voiceAt) {
+    auto apply = [&](auto& arr) {
+        const auto old = arr;
+        for (size_t s = 0; s < voiceAt.size(); ++s) arr[s] = old[slotOf_[voiceAt[s]]];
+    };
+    apply(rateHz_); apply(depth_); apply(wet_); apply(stereoPhaseR_);
+    apply(phase_); apply(phaseInc_); apply(depthSm_); apply(rateSm_); apply(shape_);
+    for (size_t s = 0; s < voiceAt.size(); ++s) {
+        voiceAt_[s] = voiceAt[s];
+        slotOf_[voiceAt[s]] = s;
+    }
+}
+
+void TremoloBank::regroup() {
+    std::vector<size_t> order(voiceAt_);
+    std::sort(order.begin(), order.end());
+    std::stable_sort(order.begin(), order.end(), [&](size_t x, size_t y) {
+        return int(shape_[slotOf_[x]]) < int(shape_[slotOf_[y]]);
+    });
+    permute(order);
+    regroup_ = false;
+}
+
+void TremoloBank::setSampleRate(double fs) {
+    sr_ = fs > 0.0 ? fs : 48000.0;
+    sm_.setSampleRate(sr_);
+    sm_.setTimeConstant(0.01f); // as Tremolo
+    for (size_t s = 0; s < rateHz_.size(); ++s) {
+        depthSm_[s] = OnePoleSmoother::State::at(depth_[s]);
+        rateSm_[s] = OnePoleSmoother::State::at(rateHz_[s]);
+        phaseInc_[s] = float(rateHz_[s] / sr_);
+    }
+}
+
+void TremoloBank::setAccuracy(LFOAccuracy a) { accuracy_ = a; }
+void TremoloBank::setDepth(size_t v, float d)  { if (v < voices_) depth_[slotOf_[v]] = clamp01(d); }
+void TremoloBank::setRateHz(size_t v, float r) { if (v < voices_) rateHz_[slotOf_[v]] = std::max(0.0001f, r); }
+void TremoloBank::setWet(size_t v, float w)    { if (v < voices_) wet_[slotOf_[v]] = clamp01(w); }
+void TremoloBank::setStereoPhaseDeg(size_t v, float deg) {
+    if (v < voices_) stereoPhaseR_[slotOf_[v]] = std::max(0.f, std::min(180.f, deg)) / 360.f;
+}
+void TremoloBank::setShape(size_t v, LFOShape s) {
+    if (v >= voices_ || shape_[slotOf_[v]] == s) return;
+    shape_[slotOf_[v]] = s;
+    regroup_ = true;
+}
+
+Tremolo::State TremoloBank::state(size_t v) const {
+    Tremolo::State s;
+    if (v >= voices_) return s;
+    const size_t k = slotOf_[v];
+    s.phase = phase_[k];
+    s.phaseInc = phaseInc_[k];
+    s.depth = depthSm_[k];
+    s.rate = rateSm_[k];
+    return s;
+}
+
+void TremoloBank::setState(size_t v, const Tremolo::State& s) {
+    if (v >= voices_) return;
+    const size_t k = slotOf_[v];
+    phase_[k] = s.phase;
+    phaseInc_[k] = s.phaseInc;
+    depthSm_[k] = s.depth;
+    rateSm_[k] = s.rate;
+}
+
+// Advances smoothers and phases of voices [g, g + lanes) by n frames exactly
+// as Tremolo::rampBlock does and writes the depth ramp and L/R phases into the
+// tiles. Groups whose smoothers have all settled take the vector phase loop;
+// a lane still ramping takes the per-lane path below.
+void TremoloBank::stepGroup(size_t g, size_t n) {
+    bool settled = true;
+    for (size_t l = 0; l < kLanes && settled; ++l) {
+        const size_t v = g + l;
+        settled = rateSm_[v].settled() && rateSm_[v].target == rateHz_[v] &&
+                  depthSm_[v].settled() && depthSm_[v].target == depth_[v];
+    }
+    if (!settled) {
+        rampGroup(g, n);
+        return;
+    }
+
+    alignas(32) float zd[MaxLanes], step[MaxLanes];
+    for (size_t l = 0; l < kLanes; ++l) {
+        const size_t v = g + l;
+        zd[l] = depthSm_[v].z;
+        step[l] = phaseInc_[v] = std::max(1e-9f, float(rateSm_[v].z / sr_));
+    }
+#if defined(BANK_AVX)
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 d = _mm256_load_ps(zd), inc = _mm256_load_ps(step);
+    const __m256 sR = _mm256_loadu_ps(&stereoPhaseR_[g]);
+    __m256 ph = _mm256_loadu_ps(&phase_[g]);
+    for (size_t i = 0; i < n; ++i) {
+        _mm256_store_ps(depthRamp_ + i * 8, d);
+        _mm256_store_ps(incTile_ + i * 8, inc);
+        _mm256_store_ps(phL_ + i * 8, ph);
+        __m256 t = _mm256_add_ps(ph, sR);
+        t = _mm256_sub_ps(t, _mm256_and_ps(_mm256_cmp_ps(t, one, _CMP_GE_OQ), one));
+        _mm256_store_ps(phR_ + i * 8, t);
+        ph = _mm256_add_ps(ph, inc);
+        ph = _mm256_sub_ps(ph, _mm256_and_ps(_mm256_cmp_ps(ph, one, _CMP_GE_OQ), one));
+    }
+    _mm256_storeu_ps(&phase_[g], ph);
+#elif defined(BANK_SSE)
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 d = _mm_load_ps(zd), inc = _mm_load_ps(step);
+    const __m128 sR = _mm_loadu_ps(&stereoPhaseR_[g]);
+    __m128 ph = _mm_loadu_ps(&phase_[g]);
+    for (size_t i = 0; i < n; ++i) {
+        _mm_store_ps(depthRamp_ + i * 4, d);
+        _mm_store_ps(incTile_ + i * 4, inc);
+        _mm_store_ps(phL_ + i * 4, ph);
+        __m128 t = _mm_add_ps(ph, sR);
+        t = _mm_sub_ps(t, _mm_and_ps(_mm_cmpge_ps(t, one), one));
+        _mm_store_ps(phR_ + i * 4, t);
+        ph = _mm_add_ps(ph, inc);
+        ph = _mm_sub_ps(ph, _mm_and_ps(_mm_cmpge_ps(ph, one), one));
+    }
+    _mm_storeu_ps(&phase_[g], ph);
+#else
+    for (size_t l = 0; l < kLanes; ++l) {
+        const size_t v = g + l;
+        float ph = phase_[v];
+        for (size_t i = 0; i < n; ++i) {
+            depthRamp_[i * kLanes + l] = zd[l];
+            incTile_[i * kLanes + l] = step[l];
+            phL_[i * kLanes + l] = ph;
+            phR_[i * kLanes + l] = std::fmod(ph + stereoPhaseR_[v], 1.0f);
+            ph += step[l];
+            if (ph >= 1.0f) ph -= 1.0f;
+        }
+        phase_[v] = ph;
+    }
+#endif
+}
+
+// stepGroup() while some lane is ramping: one smoother block per lane,
+// written strided into the tiles, then that lane's phase loop
+void TremoloBank::rampGroup(size_t g, size_t n) {
+    for (size_t l = 0; l < kLanes; ++l)
+        rampVoice(g + l, n, depthRamp_ + l, incTile_ + l, phL_ + l, phR_ + l, kLanes);
+}
+
+// One slot's smoothers and phase for n frames, exactly as Tremolo::rampBlock,
+// into depth/inc/phL (and phR if set) at `stride`
+void TremoloBank::rampVoice(size_t v, size_t n, float* depth, float* inc, float* phL, float* phR,
+                            size_t stride) {
+    float* rate = scratch_; // free until lfoGroup()
+    if (sm_.processBlock(depthSm_[v], depth_[v], depth, n, stride)) {
+        for (size_t i = 0; i < n; ++i) depth[i * stride] = depthSm_[v].z;
+    }
+    const bool flat = sm_.processBlock(rateSm_[v], rateHz_[v], rate, n);
+    float ph = phase_[v], step = phaseInc_[v];
+    if (flat) step = std::max(1e-9f, float(rateSm_[v].z / sr_));
+    for (size_t i = 0; i < n; ++i) {
+        if (!flat) step = std::max(1e-9f, float(rate[i] / sr_));
+        inc[i * stride] = step;
+        phL[i * stride] = ph;
+        if (phR) phR[i * stride] = std::fmod(ph + stereoPhaseR_[v], 1.0f);
+        ph += step;
+        if (ph >= 1.0f) ph -= 1.0f;
+    }
+    phase_[v] = ph;
+    phaseInc_[v] = step;
+}
+
+// Mono: each voice renders contiguous runs of a whole tile's length by
+// itself, as a Tremolo does. With one LFO pass per frame there is nothing for
+// the lane tiles to share, and transposing them cost more than the vector
+// phase step saved.
+void TremoloBank::processMono(float* const* buffers, size_t frames) {
+    const size_t run = BankBlock * kLanes;
+    for (size_t v = 0; v < voices_; ++v) {
+        const Lfo::Kernel lfo = Lfo::kernel(shape_[v], accuracy_);
+        float* x = buffers ? buffers[voiceAt_[v]] : nullptr;
+        for (size_t done = 0; done < frames; ) {
+            const size_t n = std::min(run, frames - done);
+            rampVoice(v, n, depthRamp_, incTile_, phL_, nullptr, 1);
+            if (x) {
+                lfo(phL_, incTile_, phL_, n);
+                for (size_t i = 0; i < n; ++i) mix_[i] = 1.0f - depthRamp_[i] * phL_[i];
+                GainApply::mono(x + done, mix_, n, wet_[v]);
+            }
+            done += n;
+        }
+    }
+}
+
+// Phases -> LFO values in place. The kernels are elementwise, so a group whose
+// voices share a shape is one pass over the whole tile; mixed groups take one
+// pass per shape present and keep each lane's own result.
+void TremoloBank::lfoGroup(size_t g, size_t n, float* tile) {
+    const size_t count = n * kLanes;
+    const size_t live = std::min(kLanes, voices_ - g);
+    bool present[Lfo::ShapeCount] = {};
+    int distinct = 0;
+    for (size_t l = 0; l < live; ++l) {
+        const int s = int(shape_[g + l]);
+        if (!present[s]) { present[s] = true; distinct++; }
+    }
+    if (distinct == 1) {
+        Lfo::kernel(shape_[g], accuracy_)(tile, incTile_, tile, count);
+        return;
+    }
+    for (int s = 0; s < Lfo::ShapeCount; ++s) {
+        if (!present[s]) continue;
+        Lfo::kernel(LFOShape(s), accuracy_)(tile, incTile_, scratch_, count);
+        for (size_t l = 0; l < live; ++l) {
+            if (int(shape_[g + l]) != s) continue;
+            for (size_t i = 0; i < n; ++i) mix_[i * kLanes + l] = scratch_[i * kLanes + l];
+        }
+    }
+    std::memcpy(tile, mix_, count * sizeof(float));
+}
+
+void TremoloBank::process(float* const* buffers, size_t frames, int channels) {
+    if (channels < 1 || voices_ == 0) return;
+    if (regroup_) regroup();
+    SMART_TREMOLO_NO_ALLOC_SCOPE("TremoloBank::process");
+    if (channels == 1) {
+        processMono(buffers, frames);
+        return;
+    }
+    const size_t stride = size_t(channels);
+
+    for (size_t done = 0; done < frames; ) {
+        const size_t n = std::min(BankBlock, frames - done);
+        for (size_t g = 0; g < voices_; g += kLanes) {
+            stepGroup(g, n);
+            lfoGroup(g, n, phL_);
+            lfoGroup(g, n, phR_);
+
+            const size_t live = std::min(kLanes, voices_ - g);
+            for (size_t l = 0; l < live; ++l) {
+                float* x = buffers ? buffers[voiceAt_[g + l]] : nullptr;
+                if (!x) continue;
+                x += done * stride;
+                // lane -> contiguous gains, 1 - depth * lfo as in Tremolo
+                for (size_t i = 0; i < n; ++i)
+                    gainL_[i] = 1.0f - depthRamp_[i * kLanes + l] * phL_[i * kLanes + l];
+                for (size_t i = 0; i < n; ++i)
+                    gainR_[i] = 1.0f - depthRamp_[i * kLanes + l] * phR_[i * kLanes + l];
+                const float wet = wet_[g + l];
+                if (channels == 2) GainApply::stereo(x, gainL_, gainR_, n, wet);
+                else               GainApply::interleaved(x, gainL_, gainR_, n, channels, wet);
+            }
+        }
+        done += n;
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "Lfo.h"
+#include "Tremolo.h"
+
+// Many independent tremolo voices (one per stem or voice) with the per-voice
+// state kept as structure-of-arrays. Phase accumulators of lanes() voices
+// advance per SIMD instruction once their smoothers have settled; each LFO
+// kernel then runs once over a whole group's phases; voices are kept sorted
+// by shape internally so groups rarely mix shapes. Mono voices skip the tiles
+// and render one by one in tile-sized runs (one LFO pass per frame leaves the
+// lanes nothing to share). Every voice renders the same samples as a Tremolo
+// with the same settings (within float eps; bit-exact in default builds) and
+// PhaseMode::Float, the only accumulator the bank implements.
+struct TremoloBank {
+    explicit TremoloBank(size_t voices = 0);
+
+    // New voices start with Tremolo's defaults; existing voices keep their state
+    void resize(size_t voices);
+    size_t voices() const { return voices_; }
+
+    // Shared by all voices
+    void setSampleRate(double fs); // resets every voice's smoothers, like Tremolo
+    void setAccuracy(LFOAccuracy a);
+
+    // Per voice, same ranges as Tremolo
+    void setDepth(size_t v, float d);
+    void setRateHz(size_t v, float r);
+    void setWet(size_t v, float w);
+    void setStereoPhaseDeg(size_t v, float deg);
+    void setShape(size_t v, LFOShape s);
+
+    // buffers[v] is voice v's interleaved audio (`frames` x `channels`, same
+    // layout for all voices). A null buffer advances that voice's state only.
+    void process(float* const* buffers, size_t frames, int channels);
+
+    Tremolo::State state(size_t v) const;
+    void setState(size_t v, const Tremolo::State& s);
+
+    // Voices per SIMD group and the instruction set used for them
+    static size_t lanes();
+    static const char* simdName();
+
+private:
+    static constexpr size_t MaxLanes = 8;
+    static constexpr size_t BankBlock = 128; // frames per tile
+
+    void resetSlot(size_t s);
+    void permute(const std::vector<size_t>& voiceAt); // slot s <- voice voiceAt[s]
+    void regroup();
+    void stepGroup(size_t g, size_t n);
+    void rampGroup(size_t g, size_t n);
+    void rampVoice(size_t v, size_t n, float* depth, float* inc, float* phL, float* phR, size_t stride);
+    void processMono(float* const* buffers, size_t frames);
+    void lfoGroup(size_t g, size_t n, float* tile);
+
+    double sr_ = 48000.0;
+    OnePoleSmoother sm_; // coefficients shared by all voices; state per slot
+    LFOAccuracy accuracy_ = LFOAccuracy::Exact;
+    size_t voices_ = 0;
+
+    // voice <-> storage slot; slots are ordered by shape (rebuilt lazily)
+    std::vector<size_t> slotOf_, voiceAt_;
+    bool regroup_ = false;
+
+    // per slot, padded to a multiple of lanes()
+    std::vector<float> rateHz_, depth_, wet_, stereoPhaseR_;
+    std::vector<float> phase_, phaseInc_;
+    std::vector<OnePoleSmoother::State> depthSm_, rateSm_;
+    std::vector<LFOShape> shape_;
+
+    // frame-major tiles for one group: tile[i * lanes() + lane]
+    alignas(32) float phL_[BankBlock * MaxLanes];
+    alignas(32) float phR_[BankBlock * MaxLanes];
+    alignas(32) float depthRamp_[BankBlock * MaxLanes];
+    alignas(32) float incTile_[BankBlock * MaxLanes]; // phase increments (band-limited shapes)
+    alignas(32) float scratch_[BankBlock * MaxLanes];
+    alignas(32) float mix_[BankBlock * MaxLanes];
+    // one voice's gains, as GainApply expects
+    alignas(32) float gainL_[BankBlock];
+    alignas(32) float gainR_[BankBlock];
+};
@@ -0,0 +1,369 @@
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#include "WavIO.h"
+#include "PcmCodec.h"
+#include <fstream>
+#include <stdexcept>
+#include <cstring>
+#include <algorithm>
+#include <cmath>
+#include <cctype>
+#include <cstdio>
+
+static void write_u32(std::ofstream& f, uint32_t v){ f.write(reinterpret_cast<const char*>(&v),4); }
+static void write_u16(std::ofstream& f, uint16_t v){ f.write(reinterpret_cast<const char*>(&v),2); }
+
+namespace {
+
+// Byte sources the RIFF chunk walker runs over: an ifstream, or a mapping
+struct StreamSource {
+    std::ifstream& f;
+    bool read(void* dst, size_t n) { return bool(f.read(static_cast<char*>(dst), std::streamsize(n))); }
+    void skip(uint64_t n) { f.seekg(std::streamoff(n), std::ios::cur); }
+    uint64_t tell() { return uint64_t(f.tellg()); }
+    bool good() const { return f && !f.eof(); }
+};
+
+struct MemorySource {
+    const uint8_t* p;
+    size_t size;
+    size_t pos = 0;
+    bool read(void* dst, size_t n) {
+        if (pos + n > size) { pos = size; return false; }
+        std::memcpy(dst, p + pos, n); pos += n; return true;
+    }
+    void skip(uint64_t n) { pos = size_t(std::min<uint64_t>(size, pos + n)); }
+    uint64_t tell() { return pos; }
+    bool good() const { return pos < size; }
+};
+
+struct WavFormat {
+    uint16_t audioFormat = 0, numChannels = 0, bitsPerSample = 0;
+    uint32_t sampleRate = 0, byteRate = 0;
+    uint16_t blockAlign = 0;
+    uint16_t subFormat = 0;   // format tag inside WAVE_FORMAT_EXTENSIBLE
+    uint32_t channelMask = 0;
+    uint32_t dataSize = 0;
+    uint64_t dataPos = 0;
+};
+
+template <class Src>
+uint32_t read_u32(Src& f){ uint32_t v=0; f.read(&v,4); return v; }
+template <class Src>
+uint16_t read_u16(Src& f){ uint16_t v=0; f.read(&v,2); return v; }
+
+// Walks the RIFF chunks and validates the format; throws on critical errors
+template <class Src>
+WavFormat parseChunks(Src& f) {
+    char riff[4] = {}; f.read(riff,4);
+    if(std::strncmp(riff,"RIFF",4)!=0) throw std::runtime_error("Not a RIFF file");
+    (void)read_u32(f); // riff size
+    char wave[4] = {}; f.read(wave,4);
+    if(std::strncmp(wave,"WAVE",4)!=0) throw std::runtime_error("Not a WAVE file");
+
+    WavFormat fmt;
+
+    // iterate chunks
+    while(f.good()){
+        char id[4]; if(!f.read(id,4)) break;
+        uint32_t sz = read_u32(f);
+        if(std::strncmp(id,"fmt ",4)==0){
+            fmt.audioFormat   = read_u16(f);
+            fmt.numChannels   = read_u16(f);
+            fmt.sampleRate    = read_u32(f);
+            fmt.byteRate      = read_u32(f);
+            fmt.blockAlign    = read_u16(f);
+            fmt.bitsPerSample = read_u16(f);
+            uint32_t used = 16;
+            if (fmt.audioFormat == 0xFFFE && sz >= 40) {
+                // cbSize, validBits, channel mask, then a GUID whose first
+                // two bytes are the real format tag
+                (void)read_u16(f);
+                (void)read_u16(f);
+                fmt.channelMask = read_u32(f);
+                fmt.subFormat = read_u16(f);
+                f.skip(14);
+                used = 40;
+            }
+            // skip any extra fmt bytes
+            if (sz > used) f.skip(sz - used);
+        } else if(std::strncmp(id,"data",4)==0){
+            fmt.dataSize = sz;
+            fmt.dataPos = f.tell();
+            f.skip(sz);
+        } else {
+            f.skip(sz); // skip unknown
+        }
+        // pad byte if odd
+        if (sz & 1) f.skip(1);
+    }
+
+    const uint16_t tag = fmt.audioFormat == 0xFFFE ? fmt.subFormat : fmt.audioFormat;
+    if (tag != 1 && tag != 3) throw std::runtime_error("Unsupported WAV format (need PCM or IEEE float)");
+    if (!(tag == 1 && (fmt.bitsPerSample == 16 || fmt.bitsPerSample == 24 || fmt.bitsPerSample == 32)) &&
+        !(tag == 3 && fmt.bitsPerSample == 32))
+        throw std::runtime_error("Unsupported bits (need 16/24/32-bit PCM or 32-bit float)");
+    if (fmt.numChannels < 1 || fmt.numChannels > WavReader::MaxChannels) throw std::runtime_error("Unsupported channel count");
+    return fmt;
+}
+
+SampleFormat sampleFormatOf(const WavFormat& fmt) {
+    const uint16_t tag = fmt.audioFormat == 0xFFFE ? fmt.subFormat : fmt.audioFormat;
+    if (tag == 3) return SampleFormat::Float32;
+    if (fmt.bitsPerSample == 24) return SampleFormat::Pcm24;
+    if (fmt.bitsPerSample == 32) return SampleFormat::Pcm32;
+    return SampleFormat::Pcm16;
+}
+
+} // namespace
+
+WavReader::Mode WavReader::parseMode(const std::string& s) {
+    auto lower = s; for (auto& c : lower) c = char(std::tolower(c));
+    if (lower == "stream") return Mode::Stream;
+    if (lower == "mmap") return Mode::Mapped;
+    return Mode::Auto;
+}
+
+bool WavReader::open(const std::string& path, Mode mode) {
+    close();
+
+    bool tryMap = (mode == Mode::Mapped);
+    if (mode == Mode::Auto) {
+        const int64_t sz = MappedFile::fileSize(path);
+        tryMap = sz >= int64_t(AutoMapBytes);
+    }
+
+    WavFormat fmt;
+    if (tryMap && map_.open(path)) {
+        MemorySource src{map_.data(), map_.size()};
+        fmt = parseChunks(src);
+        // clamp a data chunk that claims more than the file holds
+        const uint64_t avail = map_.size() > fmt.dataPos ? map_.size() - fmt.dataPos : 0;
+        fmt.dataSize = uint32_t(std::min<uint64_t>(fmt.dataSize, avail));
+        pcm_ = map_.data() + fmt.dataPos;
+    } else {
+        f_.open(path, std::ios::binary);
+        if(!f_.good()) return false;
+        StreamSource src{f_};
+        fmt = parseChunks(src);
+        // position at start of audio data
+        f_.clear();
+        f_.seekg(std::streamoff(fmt.dataPos));
+    }
+
+    sampleRate_ = int(fmt.sampleRate);
+    channels_ = int(fmt.numChannels);
+    format_ = sampleFormatOf(fmt);
+    channelMask_ = fmt.channelMask;
+    frameBytes_ = size_t(channels_) * PcmCodec::bytesPerSample(format_);
+    totalFrames_ = fmt.dataSize / frameBytes_;
+    position_ = 0;
+    dataPos_ = fmt.dataPos;
+    return true;
+}
+
+bool WavReader::seek(uint64_t frame) {
+    if (!pcm_ && !f_.is_open()) return false;
+    position_ = std::min(frame, totalFrames_);
+    if (!pcm_) {
+        f_.clear();
+        f_.seekg(std::streamoff(dataPos_ + position_ * frameBytes_));
+        return bool(f_);
+    }
+    return true;
+}
+
+size_t WavReader::read(float* interleaved, size_t frames) {
+    if ((!pcm_ && !f_.is_open()) || !interleaved || position_ >= totalFrames_) return 0;
+    frames = size_t(std::min<uint64_t>(frames, totalFrames_ - position_));
+    const size_t n = frames * size_t(channels_);
+    if (pcm_) {
+        // decode straight from the mapping into the caller's block
+        PcmCodec::decode(format_, pcm_ + position_ * frameBytes_, interleaved, n);
+        position_ += frames;
+        return frames;
+    }
+
+    if (format_ == SampleFormat::Float32) {
+        // already the in-memory format: no staging, no conversion
+        f_.read(reinterpret_cast<char*>(interleaved), std::streamsize(frames * frameBytes_));
+        frames = size_t(f_.gcount()) / frameBytes_;
+    } else {
+        if (scratch_.size() < frames * frameBytes_) scratch_.resize(frames * frameBytes_);
+        f_.read(reinterpret_cast<char*>(scratch_.data()), std::streamsize(frames * frameBytes_));
+        // a truncated data chunk yields a short final block
+        frames = size_t(f_.gcount()) / frameBytes_;
+        PcmCodec::decode(format_, scratch_.data(), interleaved, frames * size_t(channels_));
+    }
+    position_ += frames;
+    if (frames == 0) position_ = totalFrames_;
+    return frames;
+}
+
+void WavReader::close() {
+    if (f_.is_open()) f_.close();
+    f_.clear();
+    map_.close();
+    pcm_ = nullptr;
+    sampleRate_ = channels_ = 0;
+    format_ = SampleFormat::Pcm16;
+    channelMask_ = 0;
+    frameBytes_ = 0;
+    totalFrames_ = position_ = dataPos_ = 0;
+}
+
+// Speaker masks for the common layouts (mono .. 7.1)
+static uint32_t defaultChannelMask(int channels) {
+    static const uint32_t masks[9] = {0, 0x4, 0x3, 0x7, 0x33, 0x37, 0x3F, 0x13F, 0x63F};
+    return channels >= 1 && channels <= 8 ? masks[channels] : 0;
+}
+
+// Returns the header size (offset of the first data byte)
+static uint32_t write_header(std::ofstream& f, int channels_, int sampleRate_, SampleFormat format,
+                             uint32_t channelMask, uint32_t dataBytes) {
+    const uint16_t channels = uint16_t(channels_);
+    const uint32_t sampleRate = uint32_t(sampleRate_);
+    const uint16_t bitsPerSample = uint16_t(8 * PcmCodec::bytesPerSample(format));
+    const uint16_t blockAlign = uint16_t(channels * bitsPerSample / 8);
+    const uint32_t byteRate = sampleRate * blockAlign;
+    const uint16_t tag = format == SampleFormat::Float32 ? 3 : 1;
+    // Extensible is required past 16 bits or 2 channels
+    const bool extensible = format != SampleFormat::Pcm16 || channels > 2;
+    const uint32_t fmtBytes = extensible ? 40 : 16;
+    const uint32_t headerBytes = 12 + 8 + fmtBytes + 8;
+
+    // RIFF header
+    f.write("RIFF",4); write_u32(f, headerBytes - 8 + dataBytes); f.write("WAVE",4);
+    // fmt chunk
+    f.write("fmt ",4); write_u32(f, fmtBytes);
+    write_u16(f, extensible ? 0xFFFE : tag);
+    write_u16(f, channels);
+    write_u32(f, sampleRate);
+    write_u32(f, byteRate);
+    write_u16(f, blockAlign);
+    write_u16(f, bitsPerSample);
+    if (extensible) {
+        write_u16(f, 22);            // cbSize
+        write_u16(f, bitsPerSample); // valid bits
+        write_u32(f, channelMask ? channelMask : defaultChannelMask(channels));
+        // KSDATAFORMAT_SUBTYPE_PCM / _IEEE_FLOAT: tag-0000-0010-8000-00aa00389b71
+        static const uint8_t guidTail[14] = {0x00,0x00,0x00,0x00,0x10,0x00,0x80,0x00,0x00,0xAA,0x00,0x38,0x9B,0x71};
+        write_u16(f, tag);
+        f.write(reinterpret_cast<const char*>(guidTail), 14);
+    }
+    // data chunk
+    f.write("data",4); write_u32(f, dataBytes);
+    return headerBytes;
+}
+
+bool WavWriter::open(const std::string& path, int sampleRate, int channels,
+                     SampleFormat format, uint32_t channelMask) {
+    discard(); // a file still open here was never finalized
+    if (channels < 1 || channels > WavReader::MaxChannels) return false;
+    f_.open(path, std::ios::binary);
+    if(!f_.good()) return false;
+    path_ = path;
+    channels_ = channels;
+    format_ = format;
+    dataBytes_ = 0;
+    tooLarge_ = false;
+    // sizes are patched in finalize()
+    headerBytes_ = write_header(f_, channels, sampleRate, format, channelMask, 0);
+    return f_.good();
+}
+
+bool WavWriter::write(const float* interleaved, size_t frames) {
+    if (!f_.is_open()) return false;
+    // encode through a bounded staging buffer, one stream write per chunk
+    const size_t bps = PcmCodec::bytesPerSample(format_);
+    const size_t n = frames * size_t(channels_);
+    // the RIFF and data sizes are 32-bit: refuse what would wrap them
+    // (header + data + pad byte <= 4 GiB - 1)
+    if (tooLarge_ || uint64_t(headerBytes_) + dataBytes_ + uint64_t(n) * bps + 1 > UINT32_MAX) {
+        tooLarge_ = true;
+        return false;
+    }
+    if (format_ == SampleFormat::Float32) {
+        // already the on-disk format; write the caller's block as is
+        f_.write(reinterpret_cast<const char*>(interleaved), std::streamsize(n * sizeof(float)));
+        dataBytes_ += n * sizeof(float);
+        return f_.good();
+    }
+    const size_t stage = std::min(n, StageSamples);
+    if (scratch_.size() < stage * bps) scratch_.resize(stage * bps);
+    for (size_t off = 0; off < n; off += stage) {
+        const size_t m = std::min(stage, n - off);
+        PcmCodec::encode(format_, interleaved + off, scratch_.data(), m);
+        f_.write(reinterpret_cast<const char*>(scratch_.data()), std::streamsize(m * bps));
+    }
+    dataBytes_ += n * bps;
+    return f_.good();
+}
+
+bool WavWriter::finalize() {
+    if (!f_.is_open()) return true;
+    const uint32_t dataBytes = uint32_t(dataBytes_);
+    if (dataBytes_ & 1) f_.put(0); // pad byte if odd
+    f_.seekp(4);
+    write_u32(f_, headerBytes_ - 8 + dataBytes + uint32_t(dataBytes_ & 1));
+    f_.seekp(std::streamoff(headerBytes_ - 4));
+    write_u32(f_, dataBytes);
+    const bool ok = f_.good() && !tooLarge_;
+    f_.close();
+    if (ok) path_.clear();
+    return ok;
+}
+
+void WavWriter::discard() {
+    if (f_.is_open()) f_.close();
+    if (!path_.empty()) std::remove(path_.c_str());
+    path_.clear();
+}
+
+bool WavIO::read(const std::string& path, WavData& out) {
+    WavReader r;
+    if (!r.open(path)) return false;
+    out.sampleRate = r.sampleRate();
+    out.channels = r.channels();
+    out.format = r.format();
+    out.samples.resize(size_t(r.frames()) * size_t(r.channels()));
+    const size_t got = r.read(out.samples.data(), size_t(r.frames()));
+    out.samples.resize(got * size_t(r.channels()));
+    return true;
+}
+
+bool WavIO::write(const std::string& path, const WavData& in) {
+    WavWriter w;
+    if (!w.open(path, in.sampleRate, in.channels, in.format)) return false;
+    if (!w.write(in.samples.data(), in.samples.size() / size_t(in.channels))) return false;
+    return w.finalize();
+}
+
+bool WavIO::read16(const std::string& path, WavData& out) { return read(path, out); }
+
+bool WavIO::write16(const std::string& path, const WavData& in) {
+    WavWriter w;
+    if (!w.open(path, in.sampleRate, in.channels, SampleFormat::Pcm16)) return false;
+    if (!w.write(in.samples.data(), in.samples.size() / size_t(in.channels))) return false;
+    return w.finalize();
+}
+
+WavData WavIO::makeTestPad(float seconds, int sr) {
+    WavData w;
+    w.sampleRate = sr;
+    w.channels = 2;
+    const int frames = std::max(1, int(double(seconds) * sr));
+    w.samples.resize(size_t(frames) * 2);
+    float fL = 220.0f, fR = 330.0f; // a gentle dyad
+    for (int i=0;i<frames;++i){
+        float t = float(i) / float(sr);
+        float env = 0.5f * (1.0f - std::cos(2.0f*float(M_PI)*std::min(t/seconds,1.0f))); // slow fade-in/out-ish
+        float l = 0.2f * env * std::sin(2.0f*float(M_PI)*fL*t);
+        float r = 0.2f * env * std::sin(2.0f*float(M_PI)*fR*t);
+        w.samples[size_t(i)*2+0] = l;
+        w.samples[size_t(i)*2+1] = r;
+    }
+    return w;
+}
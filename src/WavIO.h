@@ -1,20 +1,112 @@
-#pragma once
-#include <string>
-#include <vector>
-#include <cstdint>
-
-struct WavData {
-    int sampleRate = 44100;
-    int channels = 2;
-    std::vector<float> samples; // interleaved, normalized [-1..1]
-};
-
-// Minimal 16-bit PCM WAV reader/writer (little-endian)
-namespace WavIO {
-    // Returns true on success; throws std::runtime_error on critical format errors
-    bool read16(const std::string& path, WavData& out);
-    bool write16(const std::string& path, const WavData& in);
-
-    // Utility: generate a tiny stereo sine "pad" (auto-used if input missing)
-    WavData makeTestPad(float seconds = 2.0f, int sr = 44100);
-}
+#pragma once
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include "MappedFile.h"
+#include "PcmCodec.h"
+
+struct WavData {
+    int sampleRate = 44100;
+    int channels = 2;
+    std::vector<float> samples; // interleaved, normalized [-1..1]
+    SampleFormat format = SampleFormat::Pcm16; // encoding on disk
+};
+
+// Streaming WAV reader: parses the RIFF header once, then decodes N frames
+// at a time so memory stays constant regardless of file length. Accepts
+// 16/24/32-bit PCM and 32-bit float, plain or WAVE_FORMAT_EXTENSIBLE.
+// Large local files are memory-mapped and decoded straight from the mapping;
+// streamed float32 is read directly into the caller's buffer.
+struct WavReader {
+    enum class Mode { Auto, Stream, Mapped };
+    // Auto maps files at least this big and streams smaller ones
+    static constexpr uint64_t AutoMapBytes = 16u << 20;
+    // Widest interleaved layout accepted (e.g. 7.1.4 beds, 7th-order ambisonics)
+    static constexpr int MaxChannels = 64;
+
+    static Mode parseMode(const std::string& s);
+
+    // Returns true on success; throws std::runtime_error on critical format errors.
+    // Mapped falls back to stream I/O if the file can't be mapped.
+    bool open(const std::string& path, Mode mode = Mode::Auto);
+    // Decodes up to `frames` frames into `interleaved` (frames * channels floats).
+    // Returns the number of frames actually read (0 at end of data).
+    size_t read(float* interleaved, size_t frames);
+    // Repositions to frame index `frame` (clamped to the end of data)
+    bool seek(uint64_t frame);
+    void close();
+
+    int sampleRate() const { return sampleRate_; }
+    int channels() const { return channels_; }
+    SampleFormat format() const { return format_; }
+    uint32_t channelMask() const { return channelMask_; } // speaker mask (extensible only; 0 = unknown)
+    uint64_t frames() const { return totalFrames_; }
+    uint64_t position() const { return position_; }
+    bool isMapped() const { return pcm_ != nullptr; }
+
+private:
+    std::ifstream f_;
+    int sampleRate_ = 0;
+    int channels_ = 0;
+    SampleFormat format_ = SampleFormat::Pcm16;
+    uint32_t channelMask_ = 0;
+    size_t frameBytes_ = 0;        // channels * bytes per sample
+    uint64_t totalFrames_ = 0;
+    uint64_t position_ = 0;        // frames decoded so far
+    uint64_t dataPos_ = 0;         // byte offset of the data chunk
+    std::vector<uint8_t> scratch_; // one block of raw PCM
+    MappedFile map_;
+    const uint8_t* pcm_ = nullptr; // start of data chunk when mapped
+};
+
+// Streaming WAV writer: writes a placeholder header on open(), appends
+// blocks with write() (bulk-encoded, one stream write per staging chunk),
+// and patches RIFF/data sizes in finalize(). PCM16 mono/stereo gets the
+// classic 44-byte header; wider formats or layouts use WAVE_FORMAT_EXTENSIBLE.
+// A file that is never finalized successfully is removed again by discard()
+// (or the destructor), so a failed job leaves no truncated WAV behind.
+struct WavWriter {
+    // Largest chunk encoded per stream write (samples)
+    static constexpr size_t StageSamples = 32768;
+
+    ~WavWriter() { discard(); }
+
+    // channelMask 0 picks the standard layout for 1..8 channels
+    bool open(const std::string& path, int sampleRate, int channels,
+              SampleFormat format = SampleFormat::Pcm16, uint32_t channelMask = 0);
+    // False on a stream error, or once the file would pass the 4 GiB the
+    // 32-bit RIFF sizes can describe (see tooLarge(); nothing more is written)
+    bool write(const float* interleaved, size_t frames);
+    // Patches the header sizes and closes the file. Safe to call twice.
+    // False if a write() was refused as too large.
+    bool finalize();
+    // Closes without patching sizes and deletes the file open() created,
+    // unless finalize() succeeded on it. Safe to call at any time.
+    void discard();
+    bool tooLarge() const { return tooLarge_; }
+
+private:
+    std::ofstream f_;
+    int channels_ = 0;
+    SampleFormat format_ = SampleFormat::Pcm16;
+    uint32_t headerBytes_ = 0; // data starts here; its size field is 4 bytes before
+    uint64_t dataBytes_ = 0;
+    bool tooLarge_ = false;
+    std::string path_; // file of the last open(), until finalized or discarded
+    std::vector<uint8_t> scratch_;
+};
+
+// Minimal WAV reader/writer (little-endian)
+namespace WavIO {
+    // Returns true on success; throws std::runtime_error on critical format
+    // errors. read() accepts every WavReader format and records it in out.format.
+    bool read(const std::string& path, WavData& out);
+    bool write(const std::string& path, const WavData& in); // in in.format
+    // Historical names: read16 == read, write16 always writes PCM16
+    bool read16(const std::string& path, WavData& out);
+    bool write16(const std::string& path, const WavData& in);
+
+    // Utility: generate a tiny stereo sine "pad" (auto-used if input missing)
+    WavData makeTestPad(float seconds = 2.0f, int sr = 44100);
+}
@@ -1,290 +1,444 @@
-#include <iostream>
-#include <fstream>
-#include <string>
-#include <vector>
-#include <cstdio>
-#include <cstdlib>
-#include <cctype>
-#include <map>
-#include <cmath>
-#include <chrono>
-#include <cstring>
-
-#include "WavIO.h"
-#include "Tremolo.h"
-#include "FeatureExtractor.h"
-#include "Controller.h"
-
-struct NoOpController : Controller {
-    void update(double /*timeSeconds*/, float /*rms*/, float /*zcr*/,
-                float& /*rateHz*/, float& /*depth*/) override {
-        // no changes
-    }
-};
-
-// Simple CLI parsing
-struct Args {
-    std::string in = "assets/input.wav";
-    std::string out = "assets/output_without_smoother.wav";
-    float rate = 5.0f;
-    float depth = 0.6f;
-    float wet = 1.0f;
-    float stereophase = 0.0f;
-    std::string shape = "sine";
-    bool analyze = false;
-    bool demo = false;
-    std::string rateSync; // e.g., "bpm:120,div:1/8"
-};
-
-static void print_help() {
-    std::cout <<
-R"(SmartTremolo - dependency-free tremolo (PCM16 WAV)
-Usage:
-  smart_tremolo --in <in.wav> --out <out.wav>
-                --rate <Hz> --depth <0..1> --shape <sine|triangle|square|square-soft>
-                --stereophase <0..180> --wet <0..1>
-                [--rate-sync bpm:120,div:1/8] [--analyze] [--demo] [--help]
-Defaults:
-  --in assets/input.wav --out assets/output.wav --rate 5.0 --depth 0.6
-  --shape sine --stereophase 0 --wet 1.0
-Notes:
-  - Only PCM 16-bit mono/stereo WAV supported.
-  - If assets/input.wav is missing, a short test file is generated automatically.
-)" << std::endl;
-}
-
-static bool parseArgs(int argc, char** argv, Args& a) {
-    for (int i=1;i<argc;++i){
-        std::string k = argv[i];
-        auto need = [&](const char* name)->std::string{
-            if (i+1>=argc) { std::cerr<<"Missing value for "<<name<<"\n"; std::exit(1); }
-            return argv[++i];
-        };
-        if (k=="--in") a.in = need("--in");
-        else if (k=="--out") a.out = need("--out");
-        else if (k=="--rate") a.rate = std::stof(need("--rate"));
-        else if (k=="--depth") a.depth = std::stof(need("--depth"));
-        else if (k=="--wet") a.wet = std::stof(need("--wet"));
-        else if (k=="--stereophase") a.stereophase = std::stof(need("--stereophase"));
-        else if (k=="--shape") a.shape = need("--shape");
-        else if (k=="--rate-sync") a.rateSync = need("--rate-sync");
-        else if (k=="--analyze") a.analyze = true;
-        else if (k=="--demo") a.demo = true;
-        else if (k=="--help" || k=="-h") { print_help(); std::exit(0); }
-        else { std::cerr<<"Unknown flag: "<<k<<"\n"; return false; }
-    }
-    if (a.rate <= 0.0f) { std::cerr<<"rate must be > 0\n"; return false; }
-    if (a.depth < 0.0f || a.depth > 1.0f) { std::cerr<<"depth must be [0..1]\n"; return false; }
-    if (a.wet < 0.0f || a.wet > 1.0f) { std::cerr<<"wet must be [0..1]\n"; return false; }
-    if (a.stereophase < 0.0f || a.stereophase > 180.0f) { std::cerr<<"stereophase must be [0..180]\n"; return false; }
-    return true;
-}
-
-// Very small rate-sync parser: "bpm:120,div:1/8"
-static bool parseRateSync(const std::string& s, float& bpm, std::string& div){
-    if (s.empty()) return false;
-    float tbpm = 0.f; std::string tdiv;
-    size_t p1 = s.find("bpm:");
-    size_t p2 = s.find(",div:");
-    if (p1==std::string::npos || p2==std::string::npos || p2 <= p1) return false;
-    try {
-        tbpm = std::stof(s.substr(p1+4, p2-(p1+4)));
-    } catch (...) { return false; }
-    tdiv = s.substr(p2+5);
-    bpm = tbpm; div = tdiv; return true;
-}
-
-static float divisionToHz(float bpm, const std::string& div){
-    // cycles per second = (BPM/60) / beatsPerCycle
-    // beatsPerCycle for common divisions:
-    // 1 -> 4 beats (whole note), 1/2 -> 2 beats, 1/4 -> 1 beat, 1/8 -> 0.5, 1/16 -> 0.25
-    std::map<std::string, float> beats = {
-        {"1", 4.f}, {"1/2", 2.f}, {"1/4", 1.f}, {"1/8", 0.5f}, {"1/16", 0.25f}
-    };
-    auto it = beats.find(div);
-    if (it==beats.end()) return -1.f;
-    float beatsPerCycle = it->second;
-    return (bpm/60.f) / beatsPerCycle;
-}
-
-int main(int argc, char** argv) {
-    Args args;
-    if (!parseArgs(argc, argv, args)) { print_help(); return 1; }
-
-    // Input handling (auto-generate tiny test file if missing and using default path)
-    {
-        std::ifstream test(args.in, std::ios::binary);
-        if (!test.good()) {
-            std::cerr << "[info] Input file not found: " << args.in
-                      << " -> generating a tiny test pad.\n";
-            auto w = WavIO::makeTestPad(10.0f, 44100);
-            // Ensure assets/ exists
-            std::string dir = args.in.substr(0, args.in.find_last_of("/\\"));
-            if (!dir.empty()) {
-#if defined(_WIN32)
-                std::string cmd = "mkdir \"" + dir + "\" >nul 2>nul";
-#else
-                std::string cmd = "mkdir -p \"" + dir + "\"";
-#endif
-                std::system(cmd.c_str());
-            }
-            if (!WavIO::write16(args.in, w)) {
-                std::cerr << "Failed to write generated input to " << args.in << "\n";
-                return 1;
-            }
-        }
-    }
-
-    // Load WAV
-    WavData audio;
-    try {
-        if (!WavIO::read16(args.in, audio)) {
-            std::cerr << "Failed to read input WAV.\n";
-            return 1;
-        }
-    } catch (const std::exception& e) {
-        std::cerr << "WAV error: " << e.what() << "\n";
-        return 1;
-    }
-
-    const double durationSec = double(audio.samples.size()) / double(audio.sampleRate * audio.channels);
-
-    // Parse shape and stereo phase
-    Tremolo trem;
-    trem.setSampleRate(audio.sampleRate);
-    trem.setDepth(args.depth);
-    trem.setRateHz(args.rate);
-    trem.setWet(args.wet);
-    trem.setStereoPhaseDeg(args.stereophase);
-    trem.setShape(Tremolo::parseShape(args.shape));
-
-    // Optional: rate sync overrides rate
-    if (!args.rateSync.empty()) {
-        float bpm; std::string div;
-        if (parseRateSync(args.rateSync, bpm, div)) {
-            float hz = divisionToHz(bpm, div);
-            if (hz > 0.f) {
-                std::cerr << "[info] rate-sync: bpm=" << bpm << " div=" << div
-                          << " -> rate=" << hz << " Hz\n";
-                trem.setRateHz(hz);
-            } else {
-                std::cerr << "[warn] Unsupported division: " << div << " (ignored)\n";
-            }
-        } else {
-            std::cerr << "[warn] Bad --rate-sync format. Expected bpm:120,div:1/8 (ignored)\n";
-        }
-    }
-
-    // Log
-    std::cout << "SmartTremolo\n";
-    std::cout << "  Input          : " << args.in << "\n";
-    std::cout << "  Output         : " << args.out << "\n";
-    std::cout << "  SampleRate     : " << audio.sampleRate << "\n";
-    std::cout << "  Channels       : " << audio.channels << "\n";
-    std::cout << "  Duration       : " << durationSec << " s\n";
-    std::cout << "  Params         : rate=" << args.rate
-              << " depth=" << args.depth
-              << " shape=" << args.shape
-              << " stereophase=" << args.stereophase
-              << " wet=" << args.wet << "\n";
-
-    // Feature extractor & controller
-    FeatureExtractor feat;
-    NoOpController ctrl;
-    double timeSec = 0.0;
-    const double dt = 1.0 / double(audio.sampleRate);
-
-    // DEMO: simulate a depth ramp between 5s..8s via smoother
-    bool demoActive = args.demo;
-    const double demoStart = 5.0;
-    const double demoEnd   = 8.0;
-    float baseDepth = args.depth;
-
-    // Process in blocks (512 frames) with per-sample LFO inside Tremolo::process
-    const size_t frames = audio.samples.size() / size_t(audio.channels);
-    const size_t block = 512;
-    std::vector<float> blockBuf;
-    blockBuf.resize(block * size_t(audio.channels));
-
-    size_t processed = 0;
-    size_t lastSecMark = 0;
-    double rmsAcc = 0.0;
-    size_t rmsCount = 0;
-
-    while (processed < frames) {
-        size_t todo = std::min(block, frames - processed);
-        // copy to block
-        std::memcpy(blockBuf.data(),
-                    audio.samples.data() + processed * audio.channels,
-                    todo * audio.channels * sizeof(float));
-
-        // features + controller (per-sample loop for features)
-        for (size_t i=0;i<todo;++i){
-            float L = (audio.channels==1) ? blockBuf[i] : blockBuf[i*2+0];
-            float R = (audio.channels==1) ? blockBuf[i] : blockBuf[i*2+1];
-            feat.pushSample(L, R);
-
-            // When a frame is ready, call controller
-            if (feat.ready()) {
-                float rms = feat.rms();
-                float zcr = feat.zcr();
-                float rate = args.rate;
-                float depth = args.depth;
-                ctrl.update(timeSec, rms, zcr, rate, depth);
-                trem.setRateHz(rate);
-                trem.setDepth(depth);
-                if (args.analyze) {
-                    rmsAcc += rms;
-                    rmsCount++;
-                }
-                feat.reset();
-            }
-
-            // DEMO scripted depth ramp
-            if (demoActive && timeSec >= demoStart && timeSec <= demoEnd) {
-                float t = float((timeSec - demoStart) / (demoEnd - demoStart)); // 0..1
-                float d = baseDepth * (0.2f + 0.8f * t); // ramp from 20% to 100% of baseDepth
-                trem.setDepth(d);
-            } else if (demoActive && timeSec > demoEnd) {
-                trem.setDepth(baseDepth);
-            }
-
-            timeSec += dt;
-        }
-
-        // Process tremolo in-place for this block
-        trem.process(blockBuf.data(), todo, audio.channels);
-
-        // write back
-        std::memcpy(audio.samples.data() + processed * audio.channels,
-                    blockBuf.data(),
-                    todo * audio.channels * sizeof(float));
-
-        // per-second analysis print
-        size_t curSec = size_t(std::floor(timeSec));
-        if (args.analyze && curSec != lastSecMark) {
-            if (rmsCount > 0) {
-                double meanRMS = rmsAcc / double(rmsCount);
-                std::cout << "[analyze] t=" << lastSecMark
-                          << "s.."<< curSec << "s, avg RMS=" << meanRMS
-                          << " (ZCR shown when frames align)\n";
-            }
-            rmsAcc = 0.0; rmsCount = 0;
-            lastSecMark = curSec;
-        }
-
-        processed += todo;
-    }
-
-    // Write output
-    if (!WavIO::write16(args.out, audio)) {
-        std::cerr << "Failed to write output WAV.\n";
-        return 1;
-    }
-
-    std::cout << "Done. Stereo phase offset = " << args.stereophase << " deg.\n";
-    // Example for future AI control:
-    //   // Map loudness to deeper tremolo
-    //   // ctrl.update(...) could set: depth = std::clamp(0.2f + 1.5f * rms, 0.0f, 1.0f);
-    return 0;
-}
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+#include <cmath>
+#include <chrono>
+#include <cstring>
+#include <memory>
+
+#include "WavIO.h"
+#include "Tremolo.h"
+#include "FeatureExtractor.h"
+#include "Pipeline.h"
+#include "Batch.h"
+#include "ThreadPool.h"
+#include "LiveHost.h"
+#include "Server.h"
+#include "Profiler.h"
+#include <thread>
+
+// Simple CLI parsing
+struct Args {
+    std::string in = "assets/input.wav";
+    std::string out = "assets/output_without_smoother.wav";
+    float rate = 5.0f;
+    float depth = 0.6f;
+    float wet = 1.0f;
+    float stereophase = 0.0f;
+    std::string channelPhase; // e.g. "0,0,0,0,90,90" (deg per channel)
+    std::string shape = "sine";
+    std::string lfo = "exact"; // LFO evaluation: exact|table|poly
+    std::string phase = "float"; // phase accumulator: float|fixed
+    bool analyze = false;
+    std::string features; // opt-in controller features, e.g. "peak,centroid"
+    bool demo = false;
+    std::string automationFile;         // "<param> <seconds> <value>" lines
+    std::vector<std::string> automate;  // e.g. "depth:0=0.2,4=0.9" (repeatable)
+    std::string rateSync; // e.g., "bpm:120,div:1/8"
+    std::string tempoMap; // MIDI file or "<seconds> <bpm>" lines
+    std::string io = "auto"; // input mode: auto|stream|mmap
+    std::string outFormat = "auto"; // auto (= input)|pcm16|pcm24|pcm32|float32
+    int hop = int(FeatureExtractor::FrameSize); // controller hop (samples)
+    int block = 512;    // DSP block (frames)
+    std::string batch;  // list file or glob of inputs
+    std::string outDir; // batch output directory
+    int jobs = 0;       // batch worker threads (0 = all cores)
+    int threads = 1;    // single-file segment-parallel threads (0 = all cores)
+    bool asyncCtrl = false; // controller on a worker thread
+    std::string skipSilence; // dBFS peak threshold for bypassing silent blocks
+    bool silenceZero = false; // zero-fill skipped blocks instead of passing them through
+    bool profile = false;   // per-stage timing report
+    std::string profileTrace; // Chrome trace JSON output (implies --profile)
+    bool live = false;  // play --in through an audio device instead of rendering
+    std::string device = "default"; // live backend: default|alsa|null
+    int period = 256;   // live callback size (frames)
+    float liveSeconds = 0.0f; // 0 = until "quit" on stdin
+    bool serve = false;  // job server on stdin or --socket
+    std::string socket;  // Unix socket path for --serve
+};
+
+static void print_help() {
+    std::cout <<
+R"(SmartTremolo - dependency-free tremolo (PCM16/24/32 and float32 WAV)
+Usage:
+  smart_tremolo --in <in.wav> --out <out.wav>
+                --rate <Hz> --depth <0..1> --shape <sine|triangle|square|square-soft|square-bl|triangle-bl>
+                --stereophase <0..180> --wet <0..1> [--channel-phase d0,d1,...]
+                [--rate-sync bpm:120,div:1/8] [--tempo-map <tempo.mid|tempo.csv>]
+                [--io auto|stream|mmap]
+                [--out-format auto|pcm16|pcm24|pcm32|float32]
+                [--lfo exact|table|poly] [--phase float|fixed] [--hop <samples>] [--block <frames>] [--threads N]
+                [--skip-silence <dBFS>] [--silence-zero]
+                [--async-controller] [--profile] [--profile-trace <trace.json>]
+                [--automation <lanes.txt>] [--automate param:t=v,...]
+                [--features peak,crest,onset,centroid|all] [--analyze] [--demo] [--help]
+  smart_tremolo --batch <list.txt|"dir/*.wav"> --out-dir <dir> [--jobs N] [params...]
+  smart_tremolo --live [--in <in.wav>] [--device default|alsa|null] [--period N]
+                [--live-seconds S] [params...]
+  smart_tremolo --serve [--socket <path>] [--jobs N] [params...]
+Defaults:
+  --in assets/input.wav --out assets/output.wav --rate 5.0 --depth 0.6
+  --shape sine --stereophase 0 --wet 1.0
+Notes:
+  - Reads 16/24/32-bit PCM and 32-bit float WAV (plain or extensible),
+    1..64 interleaved channels. --out-format auto keeps the input format.
+  - --channel-phase gives each channel its own LFO offset in degrees
+    (e.g. 5.1: "0,0,0,0,90,90"); without it odd channels use --stereophase.
+  - If assets/input.wav is missing, a short test file is generated automatically.
+  - --io auto memory-maps large inputs; stream/mmap force one path.
+  - --lfo table|poly replaces per-sample sin/tanh with wavetables or polynomials.
+  - --phase fixed runs the LFO phase on a 64-bit fixed-point accumulator:
+    no drift over any length (float is the original, default path).
+  - --hop runs the controller every N samples over the last 1024 (default 1024).
+  - --block sets the DSP block (default 512): features, controller updates
+    and Tremolo::process run on spans this long, in place in the decode buffer.
+  - --skip-silence bypasses the DSP for blocks whose peak is at or below
+    the level (e.g. -80): they are passed through (--silence-zero: zeroed)
+    while the LFO and smoothers advance, and the skipped time is reported.
+  - --async-controller runs the controller off the audio path; its updates
+    apply at the next block boundary and the latency is reported.
+  - --profile prints time spent in decode, features, controller, DSP and
+    encode plus the realtime factor; --profile-trace also writes a Chrome
+    trace (chrome://tracing, Perfetto). Single-file renders only.
+  - --rate-sync locks the LFO phase to the beat grid: div is 1, 2, 4 (bars
+    of 4/4) or 1/2 .. 1/64, with "." for dotted and "t" for triplet (1/8.,
+    1/4t). --tempo-map takes the tempo from a MIDI file or "<seconds> <bpm>"
+    lines instead of bpm: (default div 1/4).
+  - --automate moves rate|depth|wet|stereophase along breakpoints
+    (seconds=value, linear, repeat a time for a step), e.g.
+    "depth:0=0.2,4=0.9"; --automation reads "<param> <seconds> <value>" lines.
+    Lanes are sample-accurate and override the fixed value of their param.
+  - --features adds peak, crest factor, onset strength (energy rise, dB) and
+    spectral centroid (FFT) to the controller frames and --analyze lines;
+    each one is computed only when listed.
+  - --demo is a built-in depth lane (20% -> 100% of --depth over 5..8 s).
+  - --threads renders segments of one file in parallel (bit-identical to the
+    serial render); it falls back to serial with --analyze.
+  - --batch renders many files in parallel (one worker per core unless --jobs)
+    and reports the total realtime factor.
+  - --live loops the input through the device; type "rate 3", "depth 0.5",
+    "wet 1", "stereophase 90", "shape square" or "quit" on stdin.
+  - --serve keeps the engine up and renders one job per line from stdin
+    (replies on stdout) or from clients of a Unix --socket, e.g.
+    "render in=a.wav out=b.wav rate=3 id=7" or "pcm sr=48000 channels=2
+    frames=N out=-" followed by the float32 samples; params given on the
+    command line are the defaults. See src/Server.h for the protocol.
+)" << std::endl;
+}
+
+static bool parseArgs(int argc, char** argv, Args& a) {
+    for (int i=1;i<argc;++i){
+        std::string k = argv[i];
+        auto need = [&](const char* name)->std::string{
+            if (i+1>=argc) { std::cerr<<"Missing value for "<<name<<"\n"; std::exit(1); }
+            return argv[++i];
+        };
+        if (k=="--in") a.in = need("--in");
+        else if (k=="--out") a.out = need("--out");
+        else if (k=="--rate") a.rate = std::stof(need("--rate"));
+        else if (k=="--depth") a.depth = std::stof(need("--depth"));
+        else if (k=="--wet") a.wet = std::stof(need("--wet"));
+        else if (k=="--stereophase") a.stereophase = std::stof(need("--stereophase"));
+        else if (k=="--channel-phase") a.channelPhase = need("--channel-phase");
+        else if (k=="--shape") a.shape = need("--shape");
+        else if (k=="--rate-sync") a.rateSync = need("--rate-sync");
+        else if (k=="--tempo-map") a.tempoMap = need("--tempo-map");
+        else if (k=="--io") a.io = need("--io");
+        else if (k=="--out-format") a.outFormat = need("--out-format");
+        else if (k=="--lfo") a.lfo = need("--lfo");
+        else if (k=="--phase") a.phase = need("--phase");
+        else if (k=="--hop") a.hop = std::stoi(need("--hop"));
+        else if (k=="--batch") a.batch = need("--batch");
+        else if (k=="--out-dir") a.outDir = need("--out-dir");
+        else if (k=="--jobs") a.jobs = std::stoi(need("--jobs"));
+        else if (k=="--block") a.block = std::stoi(need("--block"));
+        else if (k=="--threads") a.threads = std::stoi(need("--threads"));
+        else if (k=="--async-controller") a.asyncCtrl = true;
+        else if (k=="--skip-silence") a.skipSilence = need("--skip-silence");
+        else if (k=="--silence-zero") a.silenceZero = true;
+        else if (k=="--profile") a.profile = true;
+        else if (k=="--profile-trace") { a.profileTrace = need("--profile-trace"); a.profile = true; }
+        else if (k=="--live") a.live = true;
+        else if (k=="--device") a.device = need("--device");
+        else if (k=="--period") a.period = std::stoi(need("--period"));
+        else if (k=="--live-seconds") a.liveSeconds = std::stof(need("--live-seconds"));
+        else if (k=="--serve") a.serve = true;
+        else if (k=="--socket") a.socket = need("--socket");
+        else if (k=="--analyze") a.analyze = true;
+        else if (k=="--features") a.features = need("--features");
+        else if (k=="--demo") a.demo = true;
+        else if (k=="--automation") a.automationFile = need("--automation");
+        else if (k=="--automate") a.automate.push_back(need("--automate"));
+        else if (k=="--help" || k=="-h") { print_help(); std::exit(0); }
+        else { std::cerr<<"Unknown flag: "<<k<<"\n"; return false; }
+    }
+    if (a.rate <= 0.0f) { std::cerr<<"rate must be > 0\n"; return false; }
+    if (a.depth < 0.0f || a.depth > 1.0f) { std::cerr<<"depth must be [0..1]\n"; return false; }
+    if (a.wet < 0.0f || a.wet > 1.0f) { std::cerr<<"wet must be [0..1]\n"; return false; }
+    if (a.stereophase < 0.0f || a.stereophase > 180.0f) { std::cerr<<"stereophase must be [0..180]\n"; return false; }
+    if (a.hop < 1 || a.hop > int(FeatureExtractor::FrameSize)) { std::cerr<<"hop must be [1..1024]\n"; return false; }
+    if (!a.batch.empty() && a.outDir.empty()) { std::cerr<<"--batch needs --out-dir\n"; return false; }
+    if (!a.socket.empty() && !a.serve) { std::cerr<<"--socket needs --serve\n"; return false; }
+    if (a.jobs < 0) { std::cerr<<"jobs must be >= 0\n"; return false; }
+    if (a.block < 1 || a.block > 65536) { std::cerr<<"block must be [1..65536]\n"; return false; }
+    if (a.threads < 0) { std::cerr<<"threads must be >= 0\n"; return false; }
+    if (a.outFormat != "auto" && a.outFormat != "pcm16" && a.outFormat != "pcm24" &&
+        a.outFormat != "pcm32" && a.outFormat != "float32") {
+        std::cerr<<"out-format must be auto|pcm16|pcm24|pcm32|float32\n"; return false;
+    }
+    if (a.period < 16 || a.period > 8192) { std::cerr<<"period must be [16..8192]\n"; return false; }
+    return true;
+}
+
+// Comma-separated degrees: "0,0,90,90" -> {0, 0, 90, 90}
+static bool parseDegList(const std::string& s, std::vector<float>& out) {
+    out.clear();
+    size_t pos = 0;
+    while (pos <= s.size()) {
+        size_t comma = s.find(',', pos);
+        if (comma == std::string::npos) comma = s.size();
+        try {
+            out.push_back(std::stof(s.substr(pos, comma - pos)));
+        } catch (...) { return false; }
+        pos = comma + 1;
+    }
+    return !out.empty() && out.size() <= size_t(WavReader::MaxChannels);
+}
+
+// Very small rate-sync parser: "bpm:120,div:1/8" (either part optional;
+// bpm 0 = not given)
+static bool parseRateSync(const std::string& s, float& bpm, std::string& div){
+    bpm = 0.f; div.clear();
+    size_t pos = 0;
+    while (pos <= s.size()) {
+        size_t comma = s.find(',', pos);
+        if (comma == std::string::npos) comma = s.size();
+        const std::string item = s.substr(pos, comma - pos);
+        if (item.compare(0, 4, "bpm:") == 0) {
+            try { bpm = std::stof(item.substr(4)); } catch (...) { return false; }
+            if (!(bpm > 0.f)) return false;
+        } else if (item.compare(0, 4, "div:") == 0) {
+            div = item.substr(4);
+        } else {
+            return false;
+        }
+        pos = comma + 1;
+    }
+    return bpm > 0.f || !div.empty();
+}
+
+// Live mode: stdin commands -> LiveHost (lock-free) -> device callback
+static int runLive(const Args& args, const RenderParams& params) {
+    WavData source;
+    try {
+        if (!WavIO::read(args.in, source)) {
+            std::cerr << "Failed to read input WAV.\n";
+            return 1;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "WAV error: " << e.what() << "\n";
+        return 1;
+    }
+
+    auto dev = AudioDevice::create(args.device);
+    if (!dev) {
+        std::cerr << "Unknown or unavailable audio backend: " << args.device << " (available:";
+        for (const auto& b : AudioDevice::backends()) std::cerr << " " << b;
+        std::cerr << ")\n";
+        return 1;
+    }
+
+    LiveHost host;
+    if (!host.start(*dev, source, params, size_t(args.period))) {
+        std::cerr << "Failed to start audio device " << dev->name() << "\n";
+        return 1;
+    }
+    std::cout << "[live] " << dev->name() << " device, " << source.sampleRate << " Hz, "
+              << source.channels << " ch, period " << args.period << " frames\n";
+
+    if (args.liveSeconds > 0.0f) {
+        std::this_thread::sleep_for(std::chrono::duration<double>(args.liveSeconds));
+    } else {
+        std::string line;
+        while (std::getline(std::cin, line)) {
+            if (line == "quit" || line == "q") break;
+            ParamChange c;
+            if (!LiveHost::parseCommand(line, c)) std::cerr << "[live] ? " << line << "\n";
+            else if (!host.post(c)) std::cerr << "[live] queue full, dropped: " << line << "\n";
+        }
+    }
+
+    const CallbackStats st = host.stats();
+    host.stop();
+    std::cout << "[live] callbacks=" << st.callbacks
+              << " avg=" << st.avgUs << "us max=" << st.maxUs << "us budget=" << st.budgetUs << "us"
+              << " load=" << (st.budgetUs > 0 ? 100.0 * st.avgUs / st.budgetUs : 0.0) << "%"
+              << " over-budget=" << st.overBudget << " xruns=" << st.xruns << "\n";
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    Args args;
+    if (!parseArgs(argc, argv, args)) { print_help(); return 1; }
+
+    RenderParams params;
+    params.rate = args.rate;
+    params.depth = args.depth;
+    params.wet = args.wet;
+    params.stereophase = args.stereophase;
+    if (!args.channelPhase.empty() && !parseDegList(args.channelPhase, params.channelPhaseDeg)) {
+        std::cerr << "channel-phase must be a comma-separated list of degrees (at most "
+                  << WavReader::MaxChannels << ")\n";
+        return 1;
+    }
+    params.shape = Tremolo::parseShape(args.shape);
+    params.accuracy = Lfo::parseAccuracy(args.lfo);
+    params.phaseMode = Tremolo::parsePhaseMode(args.phase);
+    params.io = WavReader::parseMode(args.io);
+    params.outFormatFromInput = args.outFormat == "auto";
+    params.outFormat = PcmCodec::parseFormat(args.outFormat);
+    params.hop = size_t(args.hop);
+    params.blockFrames = size_t(args.block);
+    params.demo = args.demo;
+    {
+        std::string err;
+        if (!args.automationFile.empty() && !params.automation.load(args.automationFile, &err)) {
+            std::cerr << err << "\n";
+            return 1;
+        }
+        for (const std::string& lane : args.automate) {
+            if (!params.automation.parseLane(lane, &err)) {
+                std::cerr << err << "\n";
+                return 1;
+            }
+        }
+    }
+    params.analyze = args.analyze;
+    if (!args.features.empty() && !FeatureExtractor::parseFeatures(args.features, params.features)) {
+        std::cerr << "features must be a comma-separated list of peak|crest|onset|centroid (or all)\n";
+        return 1;
+    }
+    params.asyncController = args.asyncCtrl;
+    if (!args.skipSilence.empty()) {
+        float db = 0.f;
+        try { db = std::stof(args.skipSilence); } catch (...) { db = 1.f; }
+        if (!(db <= 0.f)) {
+            std::cerr << "skip-silence must be a peak level in dBFS (<= 0), e.g. -80\n";
+            return 1;
+        }
+        params.silencePeak = std::pow(10.f, db / 20.f);
+        params.silenceZero = args.silenceZero;
+    }
+    params.threads = args.threads > 0 ? unsigned(args.threads) : ThreadPool::defaultThreads();
+
+    // Optional: rate sync locks the LFO to a tempo (map) and overrides rate
+    if (!args.rateSync.empty() || !args.tempoMap.empty()) {
+        float bpm = 0.f; std::string div;
+        double beats = 0.0;
+        if (!args.rateSync.empty() && !parseRateSync(args.rateSync, bpm, div)) {
+            std::cerr << "[warn] Bad --rate-sync format. Expected bpm:120,div:1/8 (ignored)\n";
+        } else if (!TempoMap::parseDivision(div.empty() ? "1/4" : div, beats)) {
+            std::cerr << "[warn] Unsupported division: " << div << " (ignored)\n";
+        } else if (!args.tempoMap.empty()) {
+            std::string err;
+            if (!params.tempo.load(args.tempoMap, &err)) {
+                std::cerr << err << "\n";
+                return 1;
+            }
+            params.beatsPerCycle = beats;
+        } else if (bpm > 0.f) {
+            params.tempo = TempoMap::constant(bpm);
+            params.beatsPerCycle = beats;
+        } else {
+            std::cerr << "[warn] --rate-sync needs bpm: or --tempo-map (ignored)\n";
+        }
+        if (params.beatsPerCycle > 0.0) {
+            const double bpm0 = params.tempo.points.front().bpm;
+            params.rate = float(bpm0 / 60.0 / beats);
+            std::cerr << "[info] rate-sync: bpm=" << bpm0 << (params.tempo.points.size() > 1 ? " (map)" : "")
+                      << " div=" << (div.empty() ? "1/4" : div) << " -> rate=" << params.rate << " Hz\n";
+        }
+    }
+
+    if (!args.batch.empty()) {
+        BatchOptions opt;
+        opt.outDir = args.outDir;
+        opt.threads = unsigned(args.jobs);
+        opt.params = params;
+        const auto inputs = Batch::expandInputs(args.batch);
+        if (inputs.empty()) {
+            std::cerr << "No inputs matched " << args.batch << "\n";
+            return 1;
+        }
+        return Batch::run(inputs, opt, std::cout) == 0 ? 0 : 1;
+    }
+
+    // no input probe: jobs name their own files
+    if (args.serve) {
+        ServerOptions opt;
+        opt.threads = unsigned(args.jobs);
+        opt.socketPath = args.socket;
+        opt.params = params;
+        return Server::run(opt, std::cerr);
+    }
+
+    // Input handling (auto-generate tiny test file if missing and using default path)
+    {
+        std::ifstream test(args.in, std::ios::binary);
+        if (!test.good()) {
+            std::cerr << "[info] Input file not found: " << args.in
+                      << " -> generating a tiny test pad.\n";
+            auto w = WavIO::makeTestPad(10.0f, 44100);
+            // Ensure assets/ exists
+            std::string dir = args.in.substr(0, args.in.find_last_of("/\\"));
+            if (!dir.empty()) {
+#if defined(_WIN32)
+                std::string cmd = "mkdir \"" + dir + "\" >nul 2>nul";
+#else
+                std::string cmd = "mkdir -p \"" + dir + "\"";
+#endif
+                std::system(cmd.c_str());
+            }
+            if (!WavIO::write16(args.in, w)) {
+                std::cerr << "Failed to write generated input to " << args.in << "\n";
+                return 1;
+            }
+        }
+    }
+
+    if (args.live) return runLive(args, params);
+
+#if defined(SMART_TREMOLO_PROFILING)
+    std::unique_ptr<Profiler> profiler;
+    if (args.profile) profiler.reset(new Profiler(!args.profileTrace.empty()));
+    params.profiler = profiler.get();
+#else
+    if (args.profile) std::cerr << "[warn] --profile: built with SMART_TREMOLO_PROFILING=OFF (ignored)\n";
+#endif
+
+    RenderResult res = Pipeline::renderFile(args.in, args.out, params, &std::cout);
+    if (!res.ok) {
+        std::cerr << res.error << "\n";
+        return 1;
+    }
+
+#if defined(SMART_TREMOLO_PROFILING)
+    if (profiler) {
+        profiler->report(std::cout, res.wallSeconds, res.audioSeconds());
+        if (!args.profileTrace.empty() && !profiler->writeChromeTrace(args.profileTrace)) {
+            std::cerr << "Failed to write " << args.profileTrace << "\n";
+            return 1;
+        }
+    }
+#endif
+
+    std::cout << "Done. Stereo phase offset = " << args.stereophase << " deg.\n";
+    // Example for future AI control:
+    //   // Map loudness to deeper tremolo
+    //   // ctrl.update(...) could set: depth = std::clamp(0.2f + 1.5f * rms, 0.0f, 1.0f);
+    return 0;
+}